@@ -0,0 +1,162 @@
+#include "private_bus.hpp"
+#include "watchdog.hpp"
+
+#include <malloc.h>
+#include <systemd/sd-bus.h>
+#include <unistd.h>
+
+#include <sdbusplus/bus.hpp>
+#include <sdeventplus/event.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+using namespace std::chrono_literals;
+
+constexpr uint64_t BENCH_INTERVAL_MS = 60000;
+
+// Bytes of the heap handed out by malloc
+size_t heapBytes()
+{
+    return mallinfo2().uordblks;
+}
+
+// Resident set size of the process in bytes
+size_t residentBytes()
+{
+    std::ifstream statm("/proc/self/statm");
+    size_t size = 0;
+    size_t resident = 0;
+    statm >> size >> resident;
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+std::string instancePath(size_t i)
+{
+    return "/bench/watchdog" + std::to_string(i);
+}
+
+// Watchdogs sharing one event loop and bus connection, as the daemon
+// hosts them when given --instance
+struct SharedLayout
+{
+    explicit SharedLayout(size_t count) : bus(privateBus().connect())
+    {
+        bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto& wdog = wdogs.emplace_back(std::make_unique<Watchdog>(
+                bus, instancePath(i).c_str(), event));
+            wdog->interval(BENCH_INTERVAL_MS);
+            wdog->enabled(true);
+        }
+    }
+
+    // Kicks every watchdog and sends out what that signaled
+    void kickAll()
+    {
+        for (auto& wdog : wdogs)
+        {
+            wdog->resetTimeRemaining(false);
+        }
+        sd_bus_flush(bus.get());
+        event.run(0us);
+    }
+
+    sdeventplus::Event event = sdeventplus::Event::get_new();
+    sdbusplus::bus_t bus;
+    std::vector<std::unique_ptr<Watchdog>> wdogs;
+};
+
+// Watchdogs with an event loop and bus connection each, as one daemon
+// per watchdog has. The executable image and libraries every extra
+// process would map on top of this are not counted.
+struct SeparateLayout
+{
+    struct Instance
+    {
+        explicit Instance(size_t i) :
+            bus(privateBus().connect()),
+            wdog(bus, instancePath(i).c_str(), event)
+        {
+            bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+            wdog.interval(BENCH_INTERVAL_MS);
+            wdog.enabled(true);
+        }
+
+        sdeventplus::Event event = sdeventplus::Event::get_new();
+        sdbusplus::bus_t bus;
+        Watchdog wdog;
+    };
+
+    explicit SeparateLayout(size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            instances.emplace_back(std::make_unique<Instance>(i));
+        }
+    }
+
+    // Kicks every watchdog and sends out what that signaled
+    void kickAll()
+    {
+        for (auto& instance : instances)
+        {
+            instance->wdog.resetTimeRemaining(false);
+            sd_bus_flush(instance->bus.get());
+            instance->event.run(0us);
+        }
+    }
+
+    std::vector<std::unique_ptr<Instance>> instances;
+};
+
+// Reports the memory each of range(0) watchdogs adds and the CPU time
+// of kicking all of them, per watchdog kicked
+template <typename Layout>
+void BM_Footprint(benchmark::State& state)
+{
+    if (!privateBus().running())
+    {
+        state.SkipWithError("dbus-daemon is not available");
+        return;
+    }
+
+    size_t count = state.range(0);
+    auto heap = heapBytes();
+    auto resident = residentBytes();
+    Layout layout(count);
+    // Signed, memory freed while setting up can make the difference negative
+    auto heapPerInstance =
+        (static_cast<double>(heapBytes()) - static_cast<double>(heap)) / count;
+    auto residentPerInstance = (static_cast<double>(residentBytes()) -
+                                static_cast<double>(resident)) /
+                               count;
+
+    for (auto _ : state)
+    {
+        layout.kickAll();
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+    state.counters["heap_per_instance"] = heapPerInstance;
+    state.counters["rss_per_instance"] = residentPerInstance;
+}
+BENCHMARK_TEMPLATE(BM_Footprint, SharedLayout)->Arg(1)->Arg(8)->Arg(32);
+BENCHMARK_TEMPLATE(BM_Footprint, SeparateLayout)->Arg(1)->Arg(8)->Arg(32);
+
+} // namespace watchdog
+} // namespace phosphor
+
+BENCHMARK_MAIN();
@@ -0,0 +1,177 @@
+#include "kick_socket.hpp"
+#include "private_bus.hpp"
+#include "tmp_dir.hpp"
+#include "watchdog.hpp"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sdbusplus/bus.hpp>
+#include <sdeventplus/event.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+constexpr auto BENCH_PATH = "/bench/path";
+constexpr uint64_t BENCH_INTERVAL_MS = 60000;
+
+// CPU time consumed by a process so far, in microseconds
+double processCpuUs(pid_t pid)
+{
+    std::string path = "/proc/" + std::to_string(pid) + "/stat";
+    FILE* f = std::fopen(path.c_str(), "r");
+    if (f == nullptr)
+    {
+        return 0;
+    }
+    unsigned long utime = 0;
+    unsigned long stime = 0;
+    // Fields 14 and 15, the command name never contains spaces here
+    int matched = std::fscanf(f,
+                              "%*d %*s %*c %*d %*d %*d %*d %*d %*u %*u %*u "
+                              "%*u %*u %lu %lu",
+                              &utime, &stime);
+    std::fclose(f);
+    if (matched != 2)
+    {
+        return 0;
+    }
+    return (utime + stime) * 1e6 / sysconf(_SC_CLK_TCK);
+}
+
+// CPU time consumed by this process so far, in microseconds
+double selfCpuUs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// A running watchdog and a client, both on the same loop so that every
+// iteration covers the whole trip from the client to the timer reset
+struct KickBench
+{
+    KickBench() :
+        wdogBus(privateBus().connect()), clientBus(privateBus().connect()),
+        wdog(wdogBus, BENCH_PATH, event)
+    {
+        wdogBus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+        clientBus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+        wdog.interval(BENCH_INTERVAL_MS);
+        wdog.enabled(true);
+    }
+
+    sdeventplus::Event event = sdeventplus::Event::get_new();
+    sdbusplus::bus_t wdogBus;
+    sdbusplus::bus_t clientBus;
+    Watchdog wdog;
+};
+
+// Reports the CPU spent per kick by us and by the bus daemon
+template <typename Kick>
+void measure(benchmark::State& state, Kick&& kick)
+{
+    auto daemon = privateBus().daemonPid();
+    auto selfBefore = selfCpuUs();
+    auto daemonBefore = processCpuUs(daemon);
+    for (auto _ : state)
+    {
+        kick();
+    }
+    auto self = selfCpuUs() - selfBefore;
+    auto daemonUs = processCpuUs(daemon) - daemonBefore;
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["cpu_us_per_kick"] =
+        benchmark::Counter(self, benchmark::Counter::kAvgIterations);
+    state.counters["daemon_cpu_us_per_kick"] =
+        benchmark::Counter(daemonUs, benchmark::Counter::kAvgIterations);
+}
+
+void BM_KickDbus(benchmark::State& state)
+{
+    if (!privateBus().running())
+    {
+        state.SkipWithError("dbus-daemon is not available");
+        return;
+    }
+
+    KickBench bench;
+    auto service = bench.wdogBus.get_unique_name();
+    measure(state, [&] {
+        auto method = bench.clientBus.new_method_call(
+            service.c_str(), BENCH_PATH, Watchdog::interface,
+            "ResetTimeRemaining");
+        method.append(false);
+        bool done = false;
+        auto slot = method.call_async([&](auto&&) { done = true; });
+        while (!done)
+        {
+            bench.event.run(std::nullopt);
+        }
+    });
+}
+BENCHMARK(BM_KickDbus)->UseRealTime();
+
+void BM_KickSocket(benchmark::State& state)
+{
+    if (!privateBus().running())
+    {
+        state.SkipWithError("dbus-daemon is not available");
+        return;
+    }
+
+    TmpDir dir("kick");
+    if (!dir.created())
+    {
+        state.SkipWithError("no temporary directory");
+        return;
+    }
+    auto path = dir.file("kick");
+
+    KickBench bench;
+    size_t kicks = 0;
+    {
+        KickSocket kickSocket(bench.event, path, {getuid()}, [&] {
+            bench.wdog.kick();
+            kicks++;
+        });
+
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        int client = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+
+        measure(state, [&] {
+            auto before = kicks;
+            sendto(client, "k", 1, 0, reinterpret_cast<sockaddr*>(&addr),
+                   sizeof(addr));
+            while (kicks == before)
+            {
+                bench.event.run(std::nullopt);
+            }
+        });
+        close(client);
+    }
+}
+BENCHMARK(BM_KickSocket)->UseRealTime();
+
+} // namespace watchdog
+} // namespace phosphor
+
+BENCHMARK_MAIN();
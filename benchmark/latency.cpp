@@ -0,0 +1,465 @@
+#include "executor.hpp"
+#include "private_bus.hpp"
+#include "tmp_dir.hpp"
+#include "watchdog.hpp"
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/stat.h>
+#include <systemd/sd-bus.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/bus/match.hpp>
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/source/io.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+// Deadlines are taken from the watchdog, which arms its timer against the
+// cached sd_event_now() of its loop. Arrivals are stamped on the same
+// CLOCK_MONOTONIC so the two can be subtracted.
+using MonotonicTime = Timer::TimePoint;
+
+MonotonicTime monotonicNow()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return MonotonicTime(duration_cast<Timer::Duration>(
+        seconds(ts.tv_sec) + nanoseconds(ts.tv_nsec)));
+}
+
+// Time the watchdog is due, as programmed into its timer
+MonotonicTime deadlineOf(const Watchdog& wdog)
+{
+    return MonotonicTime(microseconds(wdog.deadline()));
+}
+
+constexpr auto LATENCY_INTERVAL = 20ms;
+
+constexpr auto STATE_SERVICE = "bench.State";
+constexpr auto STATE_PATH = "/bench/chassis0";
+
+std::string wdogPath(size_t i)
+{
+    return "/bench/watchdog" + std::to_string(i);
+}
+
+std::string wdogTarget(size_t i)
+{
+    return "bench-" + std::to_string(i) + ".target";
+}
+
+/** @brief Mock systemd, state manager, GPIO line and Timeout signal
+ *         listener with their own loop and thread so that they timestamp
+ *         arrivals independently of the watchdog event loop.
+ */
+class Observer
+{
+  public:
+    Observer() : thread([this] { run(); })
+    {
+        while (!ready)
+        {
+            std::this_thread::sleep_for(1ms);
+        }
+    }
+
+    ~Observer()
+    {
+        stop = true;
+        thread.join();
+    }
+
+    /** @brief Forgets everything seen so far */
+    void reset()
+    {
+        std::lock_guard lock(mutex);
+        startUnits.clear();
+        timeouts.clear();
+        propertySet.reset();
+        lineWritten.reset();
+    }
+
+    /** @brief FIFO standing in for the value file of a GPIO line */
+    std::string linePath;
+
+    /** @brief Number of StartUnit calls and Timeout signals seen */
+    std::pair<size_t, size_t> counts()
+    {
+        std::lock_guard lock(mutex);
+        return {startUnits.size(), timeouts.size()};
+    }
+
+    std::mutex mutex;
+    std::unordered_map<std::string, MonotonicTime> startUnits;
+    std::unordered_map<std::string, MonotonicTime> timeouts;
+    std::optional<MonotonicTime> propertySet;
+    std::optional<MonotonicTime> lineWritten;
+
+  private:
+    TmpDir lineDir{"bench"};
+    std::atomic<bool> ready = false;
+    std::atomic<bool> stop = false;
+    std::thread thread;
+
+    /** @brief Stands in for a state manager taking property sets */
+    static int handleSet(sd_bus_message* m, void* userdata, sd_bus_error*)
+    {
+        auto self = static_cast<Observer*>(userdata);
+        if (!sd_bus_message_is_method_call(
+                m, "org.freedesktop.DBus.Properties", "Set"))
+        {
+            return 0;
+        }
+        {
+            auto now = monotonicNow();
+            std::lock_guard lock(self->mutex);
+            self->propertySet = now;
+        }
+        sd_bus_reply_method_return(m, "");
+        return 1;
+    }
+
+    void run()
+    {
+        auto event = sdeventplus::Event::get_new();
+        auto bus = privateBus().connect();
+        bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+
+        sd_bus_slot* slot = nullptr;
+        sd_bus_add_object(bus.get(), &slot, STATE_PATH, &Observer::handleSet,
+                          this);
+        bus.request_name(STATE_SERVICE);
+
+        // Held open for reading so the executor can open the FIFO
+        int lineFd = -1;
+        std::optional<sdeventplus::source::IO> line;
+        if (lineDir.created())
+        {
+            linePath = lineDir.file("value");
+            if (mkfifo(linePath.c_str(), 0600) == 0)
+            {
+                lineFd = open(linePath.c_str(),
+                              O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+            }
+        }
+        if (lineFd >= 0)
+        {
+            line.emplace(event, lineFd, EPOLLIN,
+                         [this](sdeventplus::source::IO&, int fd, uint32_t) {
+                             auto now = monotonicNow();
+                             char buf[64];
+                             while (read(fd, buf, sizeof(buf)) > 0)
+                             {}
+                             std::lock_guard lock(mutex);
+                             lineWritten = now;
+                         });
+        }
+
+        MockSystemd systemd(bus);
+        systemd.onStartUnit = [this](const char* unit) {
+            auto now = monotonicNow();
+            std::lock_guard lock(mutex);
+            startUnits.emplace(unit, now);
+        };
+        sdbusplus::bus::match_t timeoutMatch(
+            bus,
+            "type='signal',interface='xyz.openbmc_project.Watchdog',"
+            "member='Timeout'",
+            [this](sdbusplus::message_t& m) {
+                auto now = monotonicNow();
+                std::lock_guard lock(mutex);
+                timeouts.emplace(m.get_path(), now);
+            });
+
+        ready = true;
+        while (!stop)
+        {
+            event.run(10ms);
+        }
+
+        line.reset();
+        if (lineFd >= 0)
+        {
+            close(lineFd);
+        }
+        sd_bus_slot_unref(slot);
+    }
+};
+
+/** @brief Issues property reads against the watchdogs at a fixed rate */
+class BackgroundLoad
+{
+  public:
+    BackgroundLoad(std::string service, size_t watchdogs, int64_t perSecond) :
+        service(std::move(service)), watchdogs(watchdogs),
+        perSecond(perSecond)
+    {
+        if (perSecond > 0)
+        {
+            thread = std::thread([this] { run(); });
+        }
+    }
+
+    ~BackgroundLoad()
+    {
+        stop = true;
+        if (thread.joinable())
+        {
+            thread.join();
+        }
+    }
+
+  private:
+    std::string service;
+    size_t watchdogs;
+    int64_t perSecond;
+    std::atomic<bool> stop = false;
+    std::thread thread;
+
+    void run()
+    {
+        auto bus = privateBus().connect();
+        auto period = duration_cast<nanoseconds>(1s) / perSecond;
+        auto next = steady_clock::now();
+        for (size_t i = 0; !stop; ++i)
+        {
+            auto method = bus.new_method_call(
+                service.c_str(), wdogPath(i % watchdogs).c_str(),
+                "org.freedesktop.DBus.Properties", "Get");
+            method.append(Watchdog::interface, "TimeRemaining");
+            try
+            {
+                bus.call(method, 1s);
+            }
+            catch (const sdbusplus::exception_t&)
+            {}
+
+            next += period;
+            std::this_thread::sleep_until(next);
+        }
+    }
+};
+
+/** @brief Reports the percentiles of the latencies in microseconds */
+void reportLatency(benchmark::State& state, const std::string& name,
+                   std::vector<double>& samples)
+{
+    if (samples.empty())
+    {
+        return;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&](double p) {
+        return samples[static_cast<size_t>(p * (samples.size() - 1))];
+    };
+    state.counters[name + "_p50_us"] = percentile(0.5);
+    state.counters[name + "_p99_us"] = percentile(0.99);
+    state.counters[name + "_max_us"] = samples.back();
+}
+
+// Arms range(0) watchdogs at once while range(1) property reads per second
+// are issued against them, then measures how long after each deadline
+// systemd receives StartUnit and a listener receives the Timeout signal.
+void BM_TimeoutLatency(benchmark::State& state)
+{
+    if (!privateBus().running())
+    {
+        state.SkipWithError("dbus-daemon is not available");
+        return;
+    }
+    const auto count = static_cast<size_t>(state.range(0));
+
+    Observer observer;
+    auto event = sdeventplus::Event::get_new();
+    auto bus = privateBus().connect();
+    bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+
+    std::vector<std::unique_ptr<Watchdog>> watchdogs;
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < count; ++i)
+    {
+        Watchdog::ActionTargetMap targets;
+        targets[Watchdog::Action::HardReset] = wdogTarget(i);
+        paths.push_back(wdogPath(i));
+        auto& wdog = watchdogs.emplace_back(std::make_unique<Watchdog>(
+            bus, paths.back().c_str(), event, std::move(targets)));
+        wdog->expireAction(Watchdog::Action::HardReset);
+        wdog->interval(milliseconds(LATENCY_INTERVAL).count());
+    }
+    BackgroundLoad load(bus.get_unique_name(), count, state.range(1));
+
+    std::vector<double> startUnitUs;
+    std::vector<double> signalUs;
+    std::vector<MonotonicTime> deadlines(count);
+    for (auto _ : state)
+    {
+        observer.reset();
+        for (size_t i = 0; i < count; ++i)
+        {
+            watchdogs[i]->enabled(true);
+            deadlines[i] = deadlineOf(*watchdogs[i]);
+        }
+
+        auto done = [&] {
+            return observer.counts() == std::make_pair(count, count) &&
+                   std::none_of(watchdogs.begin(), watchdogs.end(),
+                                [](auto& w) { return w->actionPending(); });
+        };
+        if (!runUntil(event, done))
+        {
+            state.SkipWithError("timed out waiting for watchdogs");
+            return;
+        }
+
+        std::lock_guard lock(observer.mutex);
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto us = [&](MonotonicTime t) {
+                return duration<double, std::micro>(t - deadlines[i]).count();
+            };
+            startUnitUs.push_back(us(observer.startUnits[wdogTarget(i)]));
+            signalUs.push_back(us(observer.timeouts[paths[i]]));
+        }
+    }
+
+    reportLatency(state, "start_unit", startUnitUs);
+    reportLatency(state, "timeout_signal", signalUs);
+}
+BENCHMARK(BM_TimeoutLatency)
+    ->ArgNames({"watchdogs", "reads_per_sec"})
+    ->ArgsProduct({{1, 16, 128}, {0, 1000, 10000}})
+    ->Iterations(20)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+/** @brief Ways of carrying out a timeout compared by BM_ExecutorLatency */
+enum class ExecutorKind
+{
+    Systemd,
+    Property,
+    File,
+};
+
+// Times from each deadline until the action takes effect at a stand-in
+// for every way of carrying it out: StartUnit at a mock systemd, a
+// property set at a mock state manager and a write to a FIFO standing in
+// for a GPIO line.
+void BM_ExecutorLatency(benchmark::State& state)
+{
+    if (!privateBus().running())
+    {
+        state.SkipWithError("dbus-daemon is not available");
+        return;
+    }
+    const auto kind = static_cast<ExecutorKind>(state.range(0));
+
+    Observer observer;
+    auto event = sdeventplus::Event::get_new();
+    auto bus = privateBus().connect();
+    bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+
+    Watchdog::ActionTargetMap targets;
+    targets[Watchdog::Action::HardReset] = wdogTarget(0);
+    Watchdog wdog(bus, wdogPath(0).c_str(), event, std::move(targets));
+    wdog.expireAction(Watchdog::Action::HardReset);
+    wdog.interval(milliseconds(LATENCY_INTERVAL).count());
+    if (kind == ExecutorKind::Property)
+    {
+        wdog.setExecutor(Watchdog::Action::HardReset,
+                         std::make_unique<PropertyExecutor>(
+                             bus, STATE_SERVICE, STATE_PATH,
+                             "xyz.openbmc_project.State.Chassis",
+                             "RequestedPowerTransition",
+                             "xyz.openbmc_project.State.Chassis.Transition."
+                             "PowerCycle"));
+    }
+    else if (kind == ExecutorKind::File)
+    {
+        if (observer.linePath.empty())
+        {
+            state.SkipWithError("failed to create the FIFO");
+            return;
+        }
+        wdog.setExecutor(Watchdog::Action::HardReset,
+                         std::make_unique<FileExecutor>(observer.linePath,
+                                                        "1"));
+    }
+
+    // Time the action took effect at the stand-in, if it has
+    auto effect = [&]() -> std::optional<MonotonicTime> {
+        std::lock_guard lock(observer.mutex);
+        switch (kind)
+        {
+            case ExecutorKind::Systemd:
+            {
+                auto it = observer.startUnits.find(wdogTarget(0));
+                if (it == observer.startUnits.end())
+                {
+                    return std::nullopt;
+                }
+                return it->second;
+            }
+            case ExecutorKind::Property:
+                return observer.propertySet;
+            case ExecutorKind::File:
+                return observer.lineWritten;
+        }
+        return std::nullopt;
+    };
+
+    std::vector<double> effectUs;
+    for (auto _ : state)
+    {
+        observer.reset();
+        wdog.enabled(true);
+        auto deadline = deadlineOf(wdog);
+
+        if (!runUntil(event, [&] {
+                return effect().has_value() && !wdog.actionPending();
+            }))
+        {
+            state.SkipWithError("timed out waiting for the action");
+            return;
+        }
+        effectUs.push_back(
+            duration<double, std::micro>(*effect() - deadline).count());
+    }
+
+    reportLatency(state, "effect", effectUs);
+}
+BENCHMARK(BM_ExecutorLatency)
+    ->ArgNames({"executor"})
+    ->Arg(static_cast<int>(ExecutorKind::Systemd))
+    ->Arg(static_cast<int>(ExecutorKind::Property))
+    ->Arg(static_cast<int>(ExecutorKind::File))
+    ->Iterations(50)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace watchdog
+} // namespace phosphor
+
+BENCHMARK_MAIN();
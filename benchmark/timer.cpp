@@ -0,0 +1,138 @@
+#include "timer_queue.hpp"
+
+#include <sdeventplus/clock.hpp>
+#include <sdeventplus/event.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+using MonotonicClock = sdeventplus::Clock<sdeventplus::ClockId::Monotonic>;
+
+// Long enough that nothing expires while we are kicking
+constexpr auto kickInterval = 60s;
+
+// Short enough to keep each expiry round quick
+constexpr auto expiryInterval = 2ms;
+
+// Kicks every timer in turn, running one loop iteration per round so that
+// the cost of reprogramming the kernel timer is accounted for
+template <typename MakeTimer>
+void kickTimers(benchmark::State& state, const sdeventplus::Event& event,
+                MakeTimer&& makeTimer)
+{
+    std::vector<std::unique_ptr<Timer>> timers;
+    for (int64_t i = 0; i < state.range(0); ++i)
+    {
+        timers.emplace_back(makeTimer())->restart(kickInterval);
+    }
+
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        timers[i]->setRemaining(kickInterval);
+        if (++i == timers.size())
+        {
+            i = 0;
+            event.run(0us);
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Arms every timer for the same interval and measures how late each
+// expiration is delivered relative to its deadline
+template <typename MakeTimer>
+void expireTimers(benchmark::State& state, const sdeventplus::Event& event,
+                  MakeTimer&& makeTimer)
+{
+    MonotonicClock clock(event);
+    const auto count = static_cast<size_t>(state.range(0));
+
+    std::vector<std::unique_ptr<Timer>> timers;
+    std::vector<MonotonicClock::time_point> deadlines(count);
+    size_t fired = 0;
+    double totalLateUs = 0;
+    double maxLateUs = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto& timer = timers.emplace_back(makeTimer());
+        timer->setCallback([&, i] {
+            auto late = duration<double, std::micro>(clock.now() - deadlines[i])
+                            .count();
+            totalLateUs += late;
+            maxLateUs = std::max(maxLateUs, late);
+            timers[i]->setEnabled(false);
+            fired++;
+        });
+    }
+
+    for (auto _ : state)
+    {
+        fired = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            deadlines[i] = clock.now() + expiryInterval;
+            timers[i]->restart(expiryInterval);
+        }
+        while (fired < count)
+        {
+            event.run(std::nullopt);
+        }
+    }
+
+    auto expirations = static_cast<double>(state.iterations() * count);
+    state.counters["mean_late_us"] = totalLateUs / expirations;
+    state.counters["max_late_us"] = maxLateUs;
+}
+
+void BM_EventTimerKick(benchmark::State& state)
+{
+    auto event = sdeventplus::Event::get_new();
+    kickTimers(state, event,
+               [&] { return std::make_unique<EventTimer>(event); });
+}
+BENCHMARK(BM_EventTimerKick)->Range(1, 4096);
+
+void BM_QueuedTimerKick(benchmark::State& state)
+{
+    auto event = sdeventplus::Event::get_new();
+    TimerQueue queue(event);
+    kickTimers(state, event,
+               [&] { return std::make_unique<QueuedTimer>(queue); });
+}
+BENCHMARK(BM_QueuedTimerKick)->Range(1, 4096);
+
+void BM_EventTimerExpiry(benchmark::State& state)
+{
+    auto event = sdeventplus::Event::get_new();
+    expireTimers(state, event,
+                 [&] { return std::make_unique<EventTimer>(event); });
+}
+BENCHMARK(BM_EventTimerExpiry)->Range(1, 4096)->UseRealTime();
+
+void BM_QueuedTimerExpiry(benchmark::State& state)
+{
+    auto event = sdeventplus::Event::get_new();
+    TimerQueue queue(event);
+    expireTimers(state, event,
+                 [&] { return std::make_unique<QueuedTimer>(queue); });
+}
+BENCHMARK(BM_QueuedTimerExpiry)->Range(1, 4096)->UseRealTime();
+
+} // namespace watchdog
+} // namespace phosphor
+
+BENCHMARK_MAIN();
@@ -0,0 +1,270 @@
+#include "private_bus.hpp"
+#include "state_file.hpp"
+#include "tmp_dir.hpp"
+#include "watchdog.hpp"
+
+#include <systemd/sd-bus.h>
+#include <unistd.h>
+
+#include <sdbusplus/bus.hpp>
+#include <sdeventplus/event.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <optional>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+std::atomic<size_t> allocations{0};
+
+} // namespace
+
+void* operator new(size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+constexpr auto BENCH_PATH = "/bench/path";
+constexpr uint64_t BENCH_INTERVAL_MS = 60000;
+
+// Skips the benchmark when we could not bring up a private bus
+bool busRunning(benchmark::State& state)
+{
+    if (!privateBus().running())
+    {
+        state.SkipWithError("dbus-daemon is not available");
+        return false;
+    }
+    return true;
+}
+
+// A watchdog on its own connection to the private bus
+struct WatchdogBench
+{
+    explicit WatchdogBench(std::optional<Watchdog::Fallback> fallback) :
+        bus(privateBus().connect()),
+        wdog(bus, BENCH_PATH, event, Watchdog::ActionTargetMap(),
+             std::move(fallback))
+    {
+        bus.attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+        wdog.interval(BENCH_INTERVAL_MS);
+    }
+
+    WatchdogBench() : WatchdogBench(std::nullopt) {}
+
+    // Keeps the outgoing signals from piling up in the write queue
+    void drain(size_t iteration)
+    {
+        if ((iteration & 0xff) == 0)
+        {
+            sd_bus_flush(bus.get());
+            event.run(0us);
+        }
+    }
+
+    sdeventplus::Event event = sdeventplus::Event::get_new();
+    sdbusplus::bus_t bus;
+    Watchdog wdog;
+};
+
+// Runs op every iteration and reports the allocations made per operation
+template <typename Op>
+void measure(benchmark::State& state, WatchdogBench& bench, Op&& op,
+             size_t opsPerIteration = 1)
+{
+    size_t iteration = 0;
+    auto before = allocations.load(std::memory_order_relaxed);
+    for (auto _ : state)
+    {
+        op(iteration);
+        bench.drain(++iteration);
+    }
+    auto allocs = allocations.load(std::memory_order_relaxed) - before;
+
+    state.SetItemsProcessed(state.iterations() * opsPerIteration);
+    state.counters["allocs_per_op"] = benchmark::Counter(
+        static_cast<double>(allocs) / opsPerIteration,
+        benchmark::Counter::kAvgIterations);
+}
+
+void BM_ResetTimeRemaining(benchmark::State& state)
+{
+    if (!busRunning(state))
+    {
+        return;
+    }
+
+    WatchdogBench bench;
+    bench.wdog.enabled(true);
+    measure(state, bench,
+            [&](size_t) { bench.wdog.resetTimeRemaining(false); });
+}
+BENCHMARK(BM_ResetTimeRemaining);
+
+void BM_ResetTimeRemainingStateFile(benchmark::State& state)
+{
+    if (!busRunning(state))
+    {
+        return;
+    }
+
+    TmpDir dir("bench");
+    if (!dir.created())
+    {
+        state.SkipWithError("no temporary directory");
+        return;
+    }
+    WatchdogBench bench;
+    bench.wdog.setStateFile(dir.file("state"), 1s);
+    bench.wdog.enabled(true);
+    measure(state, bench,
+            [&](size_t) { bench.wdog.resetTimeRemaining(false); });
+}
+BENCHMARK(BM_ResetTimeRemainingStateFile);
+
+void BM_StateFileSave(benchmark::State& state)
+{
+    TmpDir dir("bench");
+    if (!dir.created())
+    {
+        state.SkipWithError("no temporary directory");
+        return;
+    }
+    StateFile file(dir.file("state"));
+    SavedState saved;
+    for (auto _ : state)
+    {
+        saved.status.deadline++;
+        benchmark::DoNotOptimize(file.save(saved));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StateFileSave);
+
+void BM_TimeRemainingGet(benchmark::State& state)
+{
+    if (!busRunning(state))
+    {
+        return;
+    }
+
+    WatchdogBench bench;
+    bench.wdog.enabled(true);
+    measure(state, bench, [&](size_t) {
+        benchmark::DoNotOptimize(bench.wdog.timeRemaining());
+    });
+}
+BENCHMARK(BM_TimeRemainingGet);
+
+void BM_TimeRemainingSet(benchmark::State& state)
+{
+    if (!busRunning(state))
+    {
+        return;
+    }
+
+    WatchdogBench bench;
+    bench.wdog.enabled(true);
+    measure(state, bench, [&](size_t) {
+        benchmark::DoNotOptimize(bench.wdog.timeRemaining(BENCH_INTERVAL_MS));
+    });
+}
+BENCHMARK(BM_TimeRemainingSet);
+
+void BM_IntervalSet(benchmark::State& state)
+{
+    if (!busRunning(state))
+    {
+        return;
+    }
+
+    WatchdogBench bench;
+    // Alternate values so every set is a change that gets signaled
+    measure(state, bench, [&](size_t i) {
+        benchmark::DoNotOptimize(
+            bench.wdog.interval(BENCH_INTERVAL_MS + (i & 1)));
+    });
+}
+BENCHMARK(BM_IntervalSet);
+
+void BM_EnabledToggle(benchmark::State& state)
+{
+    if (!busRunning(state))
+    {
+        return;
+    }
+
+    WatchdogBench bench;
+    measure(
+        state, bench,
+        [&](size_t) {
+            bench.wdog.enabled(true);
+            bench.wdog.enabled(false);
+        },
+        2);
+}
+BENCHMARK(BM_EnabledToggle);
+
+void BM_EnabledAlreadyEnabled(benchmark::State& state)
+{
+    if (!busRunning(state))
+    {
+        return;
+    }
+
+    WatchdogBench bench;
+    bench.wdog.enabled(true);
+    measure(state, bench, [&](size_t) { bench.wdog.enabled(true); });
+}
+BENCHMARK(BM_EnabledAlreadyEnabled);
+
+void BM_TryFallbackOrDisable(benchmark::State& state)
+{
+    if (!busRunning(state))
+    {
+        return;
+    }
+
+    // Disabling with a fallback configured re-arms into the fallback
+    Watchdog::Fallback fallback;
+    fallback.action = Watchdog::Action::PowerOff;
+    fallback.interval = BENCH_INTERVAL_MS;
+    fallback.always = true;
+    WatchdogBench bench(fallback);
+    measure(state, bench, [&](size_t) { bench.wdog.enabled(false); });
+}
+BENCHMARK(BM_TryFallbackOrDisable);
+
+} // namespace watchdog
+} // namespace phosphor
+
+BENCHMARK_MAIN();
@@ -0,0 +1,182 @@
+#include "executor.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+using namespace std::chrono_literals;
+
+// Bounds the wait on a state manager that is stuck, so that the target
+// backing the executor gets started without the default 25s delay.
+constexpr auto SET_TIMEOUT = 2s;
+
+PropertyExecutor::PropertyExecutor(
+    sdbusplus::bus_t& bus, const std::string& service, const std::string& path,
+    const std::string& interface, const std::string& property,
+    const std::string& value) :
+    Executor("set " + interface + "." + property + " of " + path + " on " +
+             service + " to " + value),
+    bus(bus), service(service), path(path), interface(interface),
+    property(property), value(value)
+{}
+
+int PropertyExecutor::execute()
+{
+    // Built by hand so that the message libsystemd allocates is all the
+    // call costs, the sdbusplus wrappers allocate on top of it
+    sd_bus_message* method = nullptr;
+    sd_bus_slot* slot = nullptr;
+    int r = sd_bus_message_new_method_call(
+        bus.get(), &method, service.c_str(), path.c_str(),
+        "org.freedesktop.DBus.Properties", "Set");
+    if (r >= 0)
+    {
+        r = sd_bus_message_append(method, "ssv", interface.c_str(),
+                                  property.c_str(), "s", value.c_str());
+    }
+    if (r >= 0)
+    {
+        r = sd_bus_call_async(
+            bus.get(), &slot, method, &PropertyExecutor::done, this,
+            std::chrono::duration_cast<std::chrono::microseconds>(SET_TIMEOUT)
+                .count());
+    }
+    sd_bus_message_unref(method);
+
+    if (r < 0)
+    {
+        return r;
+    }
+    call.reset(slot);
+    return 0;
+}
+
+bool PropertyExecutor::pending() const
+{
+    return call != nullptr;
+}
+
+int PropertyExecutor::done(sd_bus_message* reply, void* context,
+                           sd_bus_error*)
+{
+    auto self = static_cast<PropertyExecutor*>(context);
+    int r = -sd_bus_message_get_errno(reply);
+    if (const auto* error = sd_bus_message_get_error(reply))
+    {
+        lg2::error("watchdog: failed to {EXECUTOR}: {ERROR}", "EXECUTOR",
+                   self->description(), "ERROR", error->message);
+        // Errors without a mapping to an errno still have to fail
+        r = r < 0 ? r : -EIO;
+    }
+    self->call.reset();
+    self->finished(r);
+    return 0;
+}
+
+FileExecutor::FileExecutor(const std::string& path, const std::string& value) :
+    Executor("write " + value + " to " + path), path(path), value(value)
+{
+    if (int r = open(); r < 0)
+    {
+        lg2::warning("watchdog: failed to open {PATH}, retrying on timeout: "
+                     "{ERROR}",
+                     "PATH", path, "ERROR", strerror(-r));
+    }
+}
+
+FileExecutor::~FileExecutor()
+{
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+}
+
+int FileExecutor::open()
+{
+    if (fd >= 0)
+    {
+        return 0;
+    }
+    // Non-blocking so that a line nobody is listening on cannot stall
+    // the loop
+    fd = ::open(path.c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+    return fd < 0 ? -errno : 0;
+}
+
+int FileExecutor::execute()
+{
+    if (int r = open(); r < 0)
+    {
+        return r;
+    }
+    auto written = write(fd, value.data(), value.size());
+    if (written < 0)
+    {
+        return -errno;
+    }
+    return written == static_cast<ssize_t>(value.size()) ? 0 : -EIO;
+}
+
+std::unique_ptr<Executor> makeExecutor(sdbusplus::bus_t& bus,
+                                       std::string_view spec)
+{
+    auto colon = spec.find(':');
+    if (colon == std::string_view::npos)
+    {
+        throw std::invalid_argument("missing executor type");
+    }
+    auto type = spec.substr(0, colon);
+    auto args = spec.substr(colon + 1);
+
+    if (type == "file")
+    {
+        // Paths may contain colons while values do not
+        auto last = args.rfind(':');
+        if (last == std::string_view::npos || last == 0)
+        {
+            throw std::invalid_argument("expected file:<path>:<value>");
+        }
+        return std::make_unique<FileExecutor>(
+            std::string(args.substr(0, last)),
+            std::string(args.substr(last + 1)));
+    }
+
+    if (type == "property")
+    {
+        // Everything past the fourth colon is the value
+        std::array<std::string, 5> fields;
+        for (size_t i = 0; i < fields.size() - 1; ++i)
+        {
+            auto next = args.find(':');
+            if (next == std::string_view::npos || next == 0)
+            {
+                throw std::invalid_argument(
+                    "expected property:<service>:<path>:<interface>:"
+                    "<property>:<value>");
+            }
+            fields[i] = args.substr(0, next);
+            args.remove_prefix(next + 1);
+        }
+        fields.back() = args;
+        return std::make_unique<PropertyExecutor>(
+            bus, fields[0], fields[1], fields[2], fields[3], fields[4]);
+    }
+
+    throw std::invalid_argument("unknown executor type " + std::string(type));
+}
+
+} // namespace watchdog
+} // namespace phosphor
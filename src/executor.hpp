@@ -0,0 +1,180 @@
+#pragma once
+
+#include <systemd/sd-bus.h>
+
+#include <sdbusplus/bus.hpp>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+/** @class Executor
+ *  @brief Carries out a timeout action directly instead of through a
+ *         systemd job.
+ *  @details Executors run on the event loop from the expiry handler, so
+ *  they must not block, and only libsystemd may allocate for a message
+ *  they send. Whatever is needed to carry out the action is resolved
+ *  when the executor is created.
+ */
+class Executor
+{
+  public:
+    Executor() = delete;
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+    Executor(Executor&&) = delete;
+    Executor& operator=(Executor&&) = delete;
+    virtual ~Executor() = default;
+
+    /** @brief Called with 0 or the negative errno once an action that
+     *         was started asynchronously has been carried out.
+     */
+    using Callback = std::function<void(int)>;
+
+    /** @brief Starts carrying out the action
+     *
+     *  @return 0, or the negative errno if it could not be started
+     */
+    virtual int execute() = 0;
+
+    /** @brief Is an action started by execute() still in flight
+     *  @details The callback is invoked once it is done.
+     */
+    virtual bool pending() const
+    {
+        return false;
+    }
+
+    /** @brief Sets the function told how asynchronous actions went */
+    inline void setCallback(Callback&& callback)
+    {
+        this->callback = std::move(callback);
+    }
+
+    /** @brief What the executor does, for the journal */
+    inline const std::string& description() const
+    {
+        return desc;
+    }
+
+  protected:
+    explicit Executor(std::string&& description) :
+        desc(std::move(description))
+    {}
+
+    /** @brief Reports how an asynchronous action went */
+    inline void finished(int result)
+    {
+        if (callback)
+        {
+            callback(result);
+        }
+    }
+
+  private:
+    /** @brief What the executor does */
+    std::string desc;
+
+    /** @brief Told how asynchronous actions went */
+    Callback callback;
+};
+
+/** @class PropertyExecutor
+ *  @brief Sets a string D-Bus property, e.g. the requested transition of
+ *         a chassis or host state manager.
+ *  @details The Set call is asynchronous. A failure to send it is
+ *  returned by execute() while the reply, including an error or no reply
+ *  at all, is reported to the callback.
+ */
+class PropertyExecutor : public Executor
+{
+  public:
+    /** @brief Resolves the property to set
+     *
+     *  @param[in] bus       - bus to call on
+     *  @param[in] service   - service owning the object
+     *  @param[in] path      - object path
+     *  @param[in] interface - interface of the property
+     *  @param[in] property  - property to set
+     *  @param[in] value     - string, or enum string, to set it to
+     */
+    PropertyExecutor(sdbusplus::bus_t& bus, const std::string& service,
+                     const std::string& path, const std::string& interface,
+                     const std::string& property, const std::string& value);
+
+    int execute() override;
+    bool pending() const override;
+
+  private:
+    sdbusplus::bus_t& bus;
+    std::string service;
+    std::string path;
+    std::string interface;
+    std::string property;
+    std::string value;
+
+    /** @brief Outstanding Set call, replaced by the next one */
+    std::unique_ptr<sd_bus_slot, decltype(&sd_bus_slot_unref)> call{
+        nullptr, sd_bus_slot_unref};
+
+    /** @brief Handles the reply to Set */
+    static int done(sd_bus_message* reply, void* context,
+                    sd_bus_error* error);
+};
+
+/** @class FileExecutor
+ *  @brief Writes a value to a file, e.g. the value of a sysfs GPIO line
+ *         wired to the reset of the host.
+ *  @details The file is kept open from the first successful open on so
+ *  that expiring costs a single write.
+ */
+class FileExecutor : public Executor
+{
+  public:
+    /** @brief Opens the file, retried on execute() if that fails
+     *
+     *  @param[in] path  - file to write
+     *  @param[in] value - data written on every execute()
+     */
+    FileExecutor(const std::string& path, const std::string& value);
+
+    ~FileExecutor() override;
+
+    int execute() override;
+
+  private:
+    std::string path;
+    std::string value;
+
+    /** @brief Open file, -1 if it could not be opened yet */
+    int fd = -1;
+
+    /** @brief Opens the file if needed
+     *
+     *  @return 0, or the negative errno of opening it
+     */
+    int open();
+};
+
+/** @brief Creates an executor from its description on the command line
+ *  @details Takes one of
+ *
+ *    file:<path>:<value>
+ *    property:<service>:<path>:<interface>:<property>:<value>
+ *
+ *  @param[in] bus  - bus property executors call on
+ *  @param[in] spec - executor description
+ *
+ *  @throws std::invalid_argument if the description is malformed
+ */
+std::unique_ptr<Executor> makeExecutor(sdbusplus::bus_t& bus,
+                                       std::string_view spec);
+
+} // namespace watchdog
+} // namespace phosphor
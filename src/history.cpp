@@ -0,0 +1,118 @@
+#include "history.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+using namespace std::chrono;
+
+const char* historyEventName(HistoryEvent event)
+{
+    switch (event)
+    {
+        case HistoryEvent::Kick:
+            return "kick";
+        case HistoryEvent::Interval:
+            return "interval";
+        case HistoryEvent::Enabled:
+            return "enabled";
+        case HistoryEvent::Disabled:
+            return "disabled";
+        case HistoryEvent::Fallback:
+            return "fallback";
+        case HistoryEvent::Timeout:
+            return "timeout";
+    }
+    return "unknown";
+}
+
+History::History(size_t size) : ring(size) {}
+
+void History::resize(size_t size)
+{
+    ring.assign(size, HistoryEntry{});
+    next = 0;
+    count = 0;
+}
+
+void History::record(TimePoint when, HistoryEvent event, uint64_t value)
+{
+    if (ring.empty())
+    {
+        return;
+    }
+    auto& entry = ring[next];
+    entry.time = duration_cast<microseconds>(when.time_since_epoch()).count();
+    entry.event = event;
+    entry.value = value;
+    next = (next + 1) % ring.size();
+    count = std::min(count + 1, ring.size());
+}
+
+const HistoryEntry& History::at(size_t i) const
+{
+    return ring[(next + ring.size() - count + i) % ring.size()];
+}
+
+std::vector<HistoryEntry> History::entries() const
+{
+    std::vector<HistoryEntry> result;
+    result.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        result.push_back(at(i));
+    }
+    return result;
+}
+
+void History::setDumpFile(const std::string& path)
+{
+    dumpPath = path;
+    dumpTmpPath = path.empty() ? std::string() : path + ".tmp";
+}
+
+bool History::dump() const
+{
+    if (dumpPath.empty())
+    {
+        return true;
+    }
+
+    int fd = open(dumpTmpPath.c_str(),
+                  O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    bool ok = true;
+    for (size_t i = 0; i < count && ok; ++i)
+    {
+        const auto& entry = at(i);
+        char line[64];
+        int length = std::snprintf(
+            line, sizeof(line), "%llu %s %llu\n",
+            static_cast<unsigned long long>(entry.time),
+            historyEventName(entry.event),
+            static_cast<unsigned long long>(entry.value));
+        ok = length > 0 && write(fd, line, length) == length;
+    }
+    ok = close(fd) == 0 && ok;
+    if (!ok || rename(dumpTmpPath.c_str(), dumpPath.c_str()) != 0)
+    {
+        unlink(dumpTmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace watchdog
+} // namespace phosphor
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "timer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+/** @brief Kinds of events kept in a watchdog history */
+enum class HistoryEvent : uint32_t
+{
+    /** @brief Countdown reset, value is the time that was left in ms */
+    Kick,
+    /** @brief Interval changed, value is the new interval in ms */
+    Interval,
+    /** @brief Countdown armed, value is its length in ms */
+    Enabled,
+    /** @brief Countdown stopped, value is unused */
+    Disabled,
+    /** @brief Fallback armed, value is its length in ms */
+    Fallback,
+    /** @brief Timer ran out, value is the Action taken */
+    Timeout,
+};
+
+/** @brief Name of an event in dumps */
+const char* historyEventName(HistoryEvent event);
+
+/** @brief A single recorded event */
+struct HistoryEntry
+{
+    /** @brief CLOCK_MONOTONIC microseconds of the event */
+    uint64_t time;
+    HistoryEvent event;
+    uint64_t value;
+};
+
+/** @class History
+ *  @brief Ring buffer of the latest events of a watchdog.
+ *  @details The buffer is allocated up front. Recording overwrites the
+ *  oldest entry once full and never allocates, and neither does dumping
+ *  to a file, so both can be done from the timeout path.
+ */
+class History
+{
+  public:
+    using TimePoint = Timer::TimePoint;
+
+    static constexpr size_t DEFAULT_SIZE = 256;
+
+    /** @brief Constructs the buffer
+     *
+     *  @param[in] size - number of events kept, 0 to keep none
+     */
+    explicit History(size_t size = DEFAULT_SIZE);
+
+    /** @brief Resizes the buffer, dropping what was recorded */
+    void resize(size_t size);
+
+    /** @brief Records an event, dropping the oldest if full */
+    void record(TimePoint when, HistoryEvent event, uint64_t value = 0);
+
+    /** @brief Number of events currently held */
+    inline size_t size() const
+    {
+        return count;
+    }
+
+    /** @brief Copies the held events, oldest first */
+    std::vector<HistoryEntry> entries() const;
+
+    /** @brief Sets the file dumped to on timeout
+     *
+     *  @param[in] path - file to write, empty to not dump
+     */
+    void setDumpFile(const std::string& path);
+
+    /** @brief Writes the held events to the dump file, if one is set
+     *  @details One "<time> <event> <value>" line per event, oldest
+     *  first. The file is replaced atomically.
+     *
+     *  @return false if the file could not be written
+     */
+    bool dump() const;
+
+  private:
+    /** @brief Preallocated storage */
+    std::vector<HistoryEntry> ring;
+
+    /** @brief Index the next event is written to */
+    size_t next = 0;
+
+    /** @brief Number of events held */
+    size_t count = 0;
+
+    /** @brief File dumped to and its temporary, empty if none */
+    std::string dumpPath;
+    std::string dumpTmpPath;
+
+    /** @brief Gets the i-th oldest held event */
+    const HistoryEntry& at(size_t i) const;
+};
+
+} // namespace watchdog
+} // namespace phosphor
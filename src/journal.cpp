@@ -0,0 +1,81 @@
+#include "journal.hpp"
+
+#include <systemd/sd-journal.h>
+
+#include <sdbusplus/server/transaction.hpp>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+JournalEntry::JournalEntry(int priority, const char* format, ...)
+{
+    int length = 0;
+    if (count < fields.size())
+    {
+        char* field = buffer.data() + used;
+        size_t room = buffer.size() - used;
+        length = snprintf(field, room, "MESSAGE=");
+        va_list args;
+        va_start(args, format);
+        length += vsnprintf(field + length, room - length, format, args);
+        va_end(args);
+    }
+    commit(length);
+    append("PRIORITY=%d", priority);
+    add("TRANSACTION_ID", sdbusplus::server::transaction::get_id());
+}
+
+JournalEntry& JournalEntry::add(const char* name, uint64_t value)
+{
+    append("%s=%" PRIu64, name, value);
+    return *this;
+}
+
+JournalEntry& JournalEntry::add(const char* name, std::string_view value)
+{
+    append("%s=%.*s", name, static_cast<int>(value.size()), value.data());
+    return *this;
+}
+
+int JournalEntry::send()
+{
+    return sd_journal_sendv(fields.data(), count);
+}
+
+void JournalEntry::append(const char* format, ...)
+{
+    if (count == fields.size() || used == buffer.size())
+    {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    int length =
+        vsnprintf(buffer.data() + used, buffer.size() - used, format, args);
+    va_end(args);
+    commit(length);
+}
+
+void JournalEntry::commit(int length)
+{
+    if (length <= 0 || count == fields.size())
+    {
+        return;
+    }
+    // snprintf reports the untruncated length, the terminator is not sent
+    size_t size = std::min<size_t>(length, buffer.size() - used - 1);
+    fields[count].iov_base = buffer.data() + used;
+    fields[count].iov_len = size;
+    count++;
+    used += size + 1;
+}
+
+} // namespace watchdog
+} // namespace phosphor
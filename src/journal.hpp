@@ -0,0 +1,84 @@
+#pragma once
+
+#include <sys/uio.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+/** @class JournalEntry
+ *  @brief Journal record formatted on the stack.
+ *  @details lg2 and log<>() format every field on the heap. Messages
+ *  logged while arming, kicking or expiring the timer go through this
+ *  instead and are written with sd_journal_sendv(), so logging them
+ *  never allocates. Whatever does not fit in the buffer is truncated.
+ */
+class JournalEntry
+{
+  public:
+    JournalEntry() = delete;
+    JournalEntry(const JournalEntry&) = delete;
+    JournalEntry& operator=(const JournalEntry&) = delete;
+    JournalEntry(JournalEntry&&) = delete;
+    JournalEntry& operator=(JournalEntry&&) = delete;
+
+    /** @brief Starts a record with its MESSAGE, PRIORITY and the
+     *         TRANSACTION_ID of the D-Bus call being handled, like log<>()
+     *
+     *  @param[in] priority - syslog priority of the record, e.g. LOG_INFO
+     *  @param[in] format   - printf format of the message
+     */
+    JournalEntry(int priority, const char* format, ...)
+        __attribute__((format(printf, 3, 4)));
+
+    /** @brief Adds a numeric field
+     *
+     *  @param[in] name  - field name, upper case
+     *  @param[in] value - field value
+     */
+    JournalEntry& add(const char* name, uint64_t value);
+
+    /** @brief Adds a string field
+     *
+     *  @param[in] name  - field name, upper case
+     *  @param[in] value - field value
+     */
+    JournalEntry& add(const char* name, std::string_view value);
+
+    /** @brief Writes the record to the journal
+     *
+     *  @return 0, or the negative errno of writing it
+     */
+    int send();
+
+  private:
+    static constexpr size_t MAX_FIELDS = 8;
+    static constexpr size_t BUFFER_SIZE = 1024;
+
+    /** @brief Formatted fields, back to back */
+    std::array<char, BUFFER_SIZE> buffer;
+
+    /** @brief Bytes of the buffer in use */
+    size_t used = 0;
+
+    /** @brief Fields handed to the journal */
+    std::array<iovec, MAX_FIELDS> fields;
+
+    /** @brief Number of fields in use */
+    size_t count = 0;
+
+    /** @brief Formats a field into the buffer */
+    void append(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+    /** @brief Records the field just formatted into the buffer */
+    void commit(int length);
+};
+
+} // namespace watchdog
+} // namespace phosphor
@@ -0,0 +1,172 @@
+#include "kernel_watchdog.hpp"
+
+#include <fcntl.h>
+#include <linux/watchdog.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+using namespace std::chrono;
+
+// Bounds on retrying a device that could not be opened
+constexpr auto OPEN_RETRY_MIN = 1s;
+constexpr auto OPEN_RETRY_MAX = 64s;
+
+KernelWatchdog::KernelWatchdog(const sdeventplus::Event& event,
+                               const std::string& path, seconds margin,
+                               Control&& control) :
+    path(path), margin(std::max(margin, seconds(1))),
+    control(std::move(control)), clock(event),
+    refresh(event, std::bind(&KernelWatchdog::arm, this))
+{}
+
+KernelWatchdog::~KernelWatchdog()
+{
+    disarm();
+}
+
+int KernelWatchdog::defaultControl(int fd, unsigned long request, int* arg)
+{
+    return ioctl(fd, request, arg);
+}
+
+void KernelWatchdog::update(uint64_t deadline)
+{
+    target = deadline;
+    if (target == 0)
+    {
+        disarm();
+        return;
+    }
+
+    // A device that failed to open is retried by the refresh
+    if (!armed())
+    {
+        if (!refresh.isEnabled())
+        {
+            arm();
+        }
+        return;
+    }
+
+    // Reprogram for a deadline the device would overshoot by more than its
+    // rounding, or one pushed past its expiry so that a crash never resets
+    // before the deadline. The latter happens at most once per margin, any
+    // other later deadline is picked up by the refresh.
+    auto latest = target + duration_cast<microseconds>(margin + 1s).count();
+    if (latest < expiry || (target > expiry && !clamped))
+    {
+        arm();
+    }
+}
+
+uint64_t KernelWatchdog::now() const
+{
+    return duration_cast<microseconds>(clock.now().time_since_epoch())
+        .count();
+}
+
+void KernelWatchdog::arm()
+{
+    if (target == 0)
+    {
+        return;
+    }
+
+    if (!fd)
+    {
+        // Opening the device starts it
+        int opened = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+        if (opened < 0)
+        {
+            // Retries back off, so only report the first failure
+            if (!openFailed)
+            {
+                lg2::error("watchdog: failed to open {PATH}: {ERROR}", "PATH",
+                           path, "ERROR", strerror(errno));
+            }
+            openFailed = true;
+            openRetry = openRetry == seconds(0)
+                            ? OPEN_RETRY_MIN
+                            : std::min<seconds>(openRetry * 2, OPEN_RETRY_MAX);
+            refresh.restartOnce(openRetry);
+            return;
+        }
+        fd.emplace(std::move(opened));
+        openFailed = false;
+        openRetry = seconds(0);
+    }
+
+    auto current = now();
+    auto remaining = target > current ? target - current : 0;
+    int wanted = static_cast<int>((remaining + 999999) / 1000000) +
+                 static_cast<int>(margin.count());
+    if (wanted != timeoutS)
+    {
+        // The driver writes back the timeout it settled for
+        int value = wanted;
+        if (control(fd->get(), WDIOC_SETTIMEOUT, &value) == 0)
+        {
+            timeoutS = value;
+        }
+        else
+        {
+            lg2::error("watchdog: failed to set the timeout of {PATH}: "
+                       "{ERROR}",
+                       "PATH", path, "ERROR", strerror(errno));
+            // Carry on with whatever the device runs at
+            value = 0;
+            control(fd->get(), WDIOC_GETTIMEOUT, &value);
+            timeoutS = value;
+        }
+    }
+    clamped = timeoutS < wanted;
+    int unused = 0;
+    if (control(fd->get(), WDIOC_KEEPALIVE, &unused) < 0)
+    {
+        lg2::error("watchdog: failed to ping {PATH}: {ERROR}", "PATH", path,
+                   "ERROR", strerror(errno));
+    }
+
+    // Come back a margin ahead of the expiry, or halfway for timeouts no
+    // longer than the margin
+    microseconds period = timeoutS > 0 ? seconds(timeoutS) : margin;
+    auto ahead = period > margin ? period - margin : period / 2;
+    expiry = current + period.count();
+    refresh.restartOnce(ahead);
+}
+
+void KernelWatchdog::disarm()
+{
+    refresh.setEnabled(false);
+    openRetry = seconds(0);
+    if (!fd)
+    {
+        return;
+    }
+
+    // The magic character stops the device rather than letting it expire,
+    // it has to be written before the device is closed
+    if (write(fd->get(), "V", 1) != 1)
+    {
+        lg2::error("watchdog: failed to stop {PATH}: {ERROR}", "PATH", path,
+                   "ERROR", strerror(errno));
+    }
+    fd.reset();
+    timeoutS = 0;
+    expiry = 0;
+}
+
+} // namespace watchdog
+} // namespace phosphor
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <sdeventplus/clock.hpp>
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/utility/timer.hpp>
+#include <stdplus/fd/managed.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+/** @class KernelWatchdog
+ *  @brief Mirrors a watchdog deadline into a Linux watchdog device so the
+ *         kernel carries the countdown if the daemon goes away.
+ *  @details The device is opened, and so started, while the deadline is
+ *  set and closed with the magic character when it is cleared or the
+ *  daemon shuts down cleanly. A crash leaves it running.
+ *
+ *  The device timeout is whole seconds, so it is set to cover the time
+ *  left plus a margin. Kicks pushing the deadline out only reprogram the
+ *  device once the deadline passes its expiry, so at most once per
+ *  margin, and a crash resets no earlier than the deadline and no later
+ *  than a margin and a second past it. Otherwise a timer refreshes the
+ *  device a margin ahead of its expiry with the deadline current at that
+ *  time. This also covers deadlines longer than the device can count,
+ *  for which a crash resets when the device runs out. A deadline pulled
+ *  in reprograms the device straight away. A device that fails to open
+ *  is retried from the same timer with a backoff.
+ */
+class KernelWatchdog
+{
+  public:
+    /** @brief Issues an ioctl to the device, ::ioctl outside of tests */
+    using Control = std::function<int(int fd, unsigned long request,
+                                      int* arg)>;
+
+    KernelWatchdog() = delete;
+    KernelWatchdog(const KernelWatchdog&) = delete;
+    KernelWatchdog& operator=(const KernelWatchdog&) = delete;
+    KernelWatchdog(KernelWatchdog&&) = delete;
+    KernelWatchdog& operator=(KernelWatchdog&&) = delete;
+
+    /** @brief Sets up the mirror, leaving the device closed
+     *
+     *  @param[in] event   - event loop the device is refreshed from
+     *  @param[in] path    - watchdog device, e.g. /dev/watchdog1
+     *  @param[in] margin  - time the device runs past the deadline, at
+     *                       least a second
+     *  @param[in] control - ioctl implementation
+     */
+    KernelWatchdog(const sdeventplus::Event& event, const std::string& path,
+                   std::chrono::seconds margin = std::chrono::seconds(2),
+                   Control&& control = defaultControl);
+
+    /** @brief Stops the device with a magic close */
+    ~KernelWatchdog();
+
+    /** @brief Follows a new deadline
+     *
+     *  @param[in] deadline - CLOCK_MONOTONIC microseconds, 0 to stop
+     */
+    void update(uint64_t deadline);
+
+    /** @brief Is the device open and counting down */
+    inline bool armed() const
+    {
+        return fd.has_value();
+    }
+
+    /** @brief Timeout of the device in seconds, 0 while stopped */
+    inline int timeout() const
+    {
+        return timeoutS;
+    }
+
+  private:
+    /** @brief Calls ::ioctl */
+    static int defaultControl(int fd, unsigned long request, int* arg);
+
+    /** @brief Path of the device */
+    std::string path;
+
+    /** @brief Time the device runs past the deadline */
+    std::chrono::seconds margin;
+
+    /** @brief ioctl implementation */
+    Control control;
+
+    /** @brief Clock of the event loop */
+    sdeventplus::Clock<sdeventplus::ClockId::Monotonic> clock;
+
+    /** @brief Refreshes the device ahead of its expiry, or retries opening
+     *         it
+     */
+    sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic> refresh;
+
+    /** @brief Open device, none while stopped */
+    std::optional<stdplus::ManagedFd> fd;
+
+    /** @brief Timeout programmed into the device */
+    int timeoutS = 0;
+
+    /** @brief Did the last attempt to open the device fail */
+    bool openFailed = false;
+
+    /** @brief Delay before the next attempt to open the device */
+    std::chrono::seconds openRetry{0};
+
+    /** @brief Is the device timeout short of the deadline it was set for */
+    bool clamped = false;
+
+    /** @brief Deadline being mirrored, 0 if none */
+    uint64_t target = 0;
+
+    /** @brief Time the device expires unless refreshed */
+    uint64_t expiry = 0;
+
+    /** @brief Gets the event loop time in microseconds */
+    uint64_t now() const;
+
+    /** @brief Opens the device if needed and programs it for the target */
+    void arm();
+
+    /** @brief Stops the device with a magic close */
+    void disarm();
+};
+
+} // namespace watchdog
+} // namespace phosphor
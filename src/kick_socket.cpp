@@ -0,0 +1,150 @@
+#include "kick_socket.hpp"
+
+#include "journal.hpp"
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <syslog.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+// Datagrams read per wakeup. Senders refilling the queue as fast as it is
+// drained would otherwise keep the event loop, and the timer with it, in
+// here. Anything left over wakes the loop again on its next iteration.
+constexpr auto MAX_DATAGRAMS_PER_WAKEUP = 64;
+
+namespace
+{
+
+/** @brief Creates the bound datagram socket */
+int bindSocket(const std::string& path)
+{
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path))
+    {
+        throw std::system_error(ENAMETOOLONG, std::generic_category(),
+                                "kick socket path");
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    int fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), "socket");
+    }
+
+    int one = 1;
+    unlink(path.c_str());
+    if (setsockopt(fd, SOL_SOCKET, SO_PASSCRED, &one, sizeof(one)) < 0 ||
+        bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        chmod(path.c_str(), 0666) < 0)
+    {
+        int error = errno;
+        close(fd);
+        throw std::system_error(error, std::generic_category(),
+                                "kick socket " + path);
+    }
+    return fd;
+}
+
+} // namespace
+
+KickSocket::KickSocket(const sdeventplus::Event& event,
+                       const std::string& path, std::vector<uid_t>&& uids,
+                       Callback&& callback) :
+    path(path), uids(std::move(uids)), callback(std::move(callback)),
+    fd(bindSocket(path)),
+    source(event, fd.get(), EPOLLIN,
+           [this](auto&, int, uint32_t) { receive(); }),
+    clock(event)
+{}
+
+KickSocket::~KickSocket()
+{
+    unlink(path.c_str());
+}
+
+void KickSocket::receive()
+{
+    bool kicked = false;
+    for (int i = 0; i < MAX_DATAGRAMS_PER_WAKEUP; ++i)
+    {
+        char data;
+        iovec iov{&data, sizeof(data)};
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(ucred))];
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        if (recvmsg(fd.get(), &msg, MSG_DONTWAIT) < 0)
+        {
+            int error = errno;
+            if (error == EINTR)
+            {
+                continue;
+            }
+            if (error != EAGAIN &&
+                logs.admit(LogEvent::KickReceiveFailed, clock.now(), error))
+            {
+                JournalEntry(LOG_ERR,
+                             "watchdog: kick socket receive failed: %s",
+                             strerror(error))
+                    .add("PATH", path)
+                    .add("ERRNO", static_cast<uint64_t>(error))
+                    .send();
+            }
+            break;
+        }
+
+        const ucred* cred = nullptr;
+        for (auto* c = CMSG_FIRSTHDR(&msg); c != nullptr;
+             c = CMSG_NXTHDR(&msg, c))
+        {
+            if (c->cmsg_level == SOL_SOCKET &&
+                c->cmsg_type == SCM_CREDENTIALS)
+            {
+                cred = reinterpret_cast<const ucred*>(CMSG_DATA(c));
+            }
+        }
+
+        if (cred == nullptr || !allowed(cred->uid))
+        {
+            rejectedCount++;
+            continue;
+        }
+        acceptedCount++;
+        kicked = true;
+    }
+
+    // Kicks queued up while we were busy are all satisfied by one reset
+    if (kicked && callback)
+    {
+        callback();
+    }
+}
+
+bool KickSocket::allowed(uid_t uid) const
+{
+    if (uids.empty())
+    {
+        return uid == 0;
+    }
+    return std::ranges::find(uids, uid) != uids.end();
+}
+
+} // namespace watchdog
+} // namespace phosphor
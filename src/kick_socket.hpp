@@ -0,0 +1,104 @@
+#pragma once
+
+#include "log_limiter.hpp"
+
+#include <sys/types.h>
+
+#include <sdeventplus/clock.hpp>
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/source/io.hpp>
+#include <stdplus/fd/managed.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+/** @class KickSocket
+ *  @brief Unix datagram endpoint that kicks a watchdog for every
+ *         datagram received from an allowed user.
+ *  @details Lets local agents pet the watchdog with a single sendto()
+ *  instead of a D-Bus method call. The socket is unconnected, so rather
+ *  than SO_PEERCRED the credentials the kernel attaches to every
+ *  datagram through SO_PASSCRED are checked. The payload is ignored.
+ */
+class KickSocket
+{
+  public:
+    using Callback = std::function<void()>;
+
+    KickSocket() = delete;
+    KickSocket(const KickSocket&) = delete;
+    KickSocket& operator=(const KickSocket&) = delete;
+    KickSocket(KickSocket&&) = delete;
+    KickSocket& operator=(KickSocket&&) = delete;
+
+    /** @brief Binds the socket and starts listening for kicks
+     *  @details Any stale socket at the path is replaced. The socket is
+     *  left writable by everyone so that access is decided by the
+     *  credentials alone.
+     *
+     *  @param[in] event    - event loop the socket is serviced from
+     *  @param[in] path     - filesystem path to bind to
+     *  @param[in] uids     - users allowed to kick, only root if empty
+     *  @param[in] callback - called for every batch of accepted kicks
+     *
+     *  @throws std::system_error if the socket could not be set up
+     */
+    KickSocket(const sdeventplus::Event& event, const std::string& path,
+               std::vector<uid_t>&& uids, Callback&& callback);
+
+    ~KickSocket();
+
+    /** @brief Number of datagrams accepted as kicks */
+    inline uint64_t accepted() const
+    {
+        return acceptedCount;
+    }
+
+    /** @brief Number of datagrams dropped for bad credentials */
+    inline uint64_t rejected() const
+    {
+        return rejectedCount;
+    }
+
+  private:
+    /** @brief Path the socket is bound to */
+    std::string path;
+
+    /** @brief Users allowed to kick, only root if empty */
+    std::vector<uid_t> uids;
+
+    /** @brief Called when kicked */
+    Callback callback;
+
+    /** @brief The bound socket */
+    stdplus::ManagedFd fd;
+
+    /** @brief Watches the socket for datagrams */
+    sdeventplus::source::IO source;
+
+    /** @brief Clock of the event loop, timestamps logged errors */
+    sdeventplus::Clock<sdeventplus::ClockId::Monotonic> clock;
+
+    /** @brief Keeps a persistent receive error from flooding the journal */
+    LogLimiter logs;
+
+    /** @brief Datagram counters */
+    uint64_t acceptedCount = 0;
+    uint64_t rejectedCount = 0;
+
+    /** @brief Drains the queued datagrams, up to a bounded batch */
+    void receive();
+
+    /** @brief Is the sender allowed to kick */
+    bool allowed(uid_t uid) const;
+};
+
+} // namespace watchdog
+} // namespace phosphor
@@ -0,0 +1,135 @@
+#include "log_limiter.hpp"
+
+#include "journal.hpp"
+
+#include <syslog.h>
+
+#include <algorithm>
+#include <cinttypes>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+using namespace std::chrono;
+
+namespace
+{
+
+/** @brief Names of the messages in summary records */
+const char* eventName(LogEvent event)
+{
+    switch (event)
+    {
+        case LogEvent::Enabled:
+            return "enabled";
+        case LogEvent::FallingBack:
+            return "falling back";
+        case LogEvent::Disabled:
+            return "disabled";
+        case LogEvent::TimedOut:
+            return "timed out";
+        case LogEvent::StartUnitRetry:
+            return "start unit retry";
+        case LogEvent::KickReceiveFailed:
+            return "kick receive failed";
+    }
+    return "unknown";
+}
+
+} // namespace
+
+LogLimiter::LogLimiter(Duration window, size_t burst) :
+    window(window), burst(std::max<size_t>(burst, 1))
+{}
+
+LogLimiter::~LogLimiter()
+{
+    for (size_t i = 0; i < states.size(); ++i)
+    {
+        if (states[i].pending)
+        {
+            summarize(static_cast<LogEvent>(i), states[i]);
+        }
+    }
+}
+
+void LogLimiter::setLimit(Duration window, size_t burst)
+{
+    this->window = window;
+    this->burst = std::max<size_t>(burst, 1);
+}
+
+bool LogLimiter::admit(LogEvent event, TimePoint now, uint64_t detail)
+{
+    auto& state = states[static_cast<size_t>(event)];
+    if (!state.seen || detail != state.detail ||
+        now - state.windowStart >= window)
+    {
+        if (state.pending)
+        {
+            summarize(event, state);
+        }
+        state.seen = true;
+        state.windowStart = now;
+        state.detail = detail;
+        state.admitted = 1;
+        return true;
+    }
+
+    if (state.admitted < burst)
+    {
+        state.admitted++;
+        return true;
+    }
+
+    state.pending++;
+    state.totalSuppressed++;
+    state.lastSuppressed = now;
+    return false;
+}
+
+void LogLimiter::flush(TimePoint now)
+{
+    for (size_t i = 0; i < states.size(); ++i)
+    {
+        auto& state = states[i];
+        if (state.pending && now - state.windowStart >= window)
+        {
+            summarize(static_cast<LogEvent>(i), state);
+        }
+    }
+}
+
+std::optional<LogLimiter::TimePoint> LogLimiter::nextFlush() const
+{
+    std::optional<TimePoint> next;
+    for (const auto& state : states)
+    {
+        if (state.pending && (!next || state.windowStart + window < *next))
+        {
+            next = state.windowStart + window;
+        }
+    }
+    return next;
+}
+
+void LogLimiter::summarize(LogEvent event, State& state)
+{
+    uint64_t elapsed =
+        duration_cast<milliseconds>(state.lastSuppressed - state.windowStart)
+            .count();
+    JournalEntry(LOG_INFO,
+                 "watchdog: suppressed %" PRIu64 " repeats of %s over "
+                 "%" PRIu64 "ms",
+                 state.pending, eventName(event), elapsed)
+        .add("EVENT", eventName(event))
+        .add("COUNT", state.pending)
+        .add("ELAPSED_MS", elapsed)
+        .send();
+    state.pending = 0;
+}
+
+} // namespace watchdog
+} // namespace phosphor
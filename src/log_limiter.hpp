@@ -0,0 +1,130 @@
+#pragma once
+
+#include "timer.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+/** @brief Watchdog messages that can repeat for as long as a host flaps */
+enum class LogEvent : size_t
+{
+    Enabled,
+    FallingBack,
+    Disabled,
+    TimedOut,
+    StartUnitRetry,
+    KickReceiveFailed,
+};
+
+/** @class LogLimiter
+ *  @brief Decides which occurrences of a repeating message get logged.
+ *  @details The first occurrence of each message in a window is let
+ *  through with its full detail and later ones are only counted, until
+ *  the window runs out or the detail of the message changes. The count
+ *  is reported in a summary record once the window runs out, see flush(),
+ *  or ahead of the next occurrence that is let through, so a flapping
+ *  host produces one record per message per window instead of one per
+ *  flap. Neither suppressing nor summarizing allocates.
+ */
+class LogLimiter
+{
+  public:
+    using Duration = Timer::Duration;
+    using TimePoint = Timer::TimePoint;
+
+    static constexpr Duration DEFAULT_WINDOW = std::chrono::minutes(1);
+    static constexpr size_t DEFAULT_BURST = 1;
+
+    LogLimiter(const LogLimiter&) = delete;
+    LogLimiter& operator=(const LogLimiter&) = delete;
+    LogLimiter(LogLimiter&&) = delete;
+    LogLimiter& operator=(LogLimiter&&) = delete;
+
+    /** @brief Constructs the limiter
+     *
+     *  @param[in] window - length of a rate limiting window, 0 to let
+     *                      every occurrence through
+     *  @param[in] burst  - occurrences let through in every window
+     */
+    explicit LogLimiter(Duration window = DEFAULT_WINDOW,
+                        size_t burst = DEFAULT_BURST);
+
+    /** @brief Summarizes whatever is still being suppressed */
+    ~LogLimiter();
+
+    /** @brief Changes the rate limit, applies from the next window
+     *
+     *  @param[in] window - length of a rate limiting window, 0 to let
+     *                      every occurrence through
+     *  @param[in] burst  - occurrences let through in every window
+     */
+    void setLimit(Duration window, size_t burst = DEFAULT_BURST);
+
+    /** @brief Records an occurrence of a message
+     *  @details Logs the summary of earlier suppressed occurrences when
+     *  the occurrence is let through.
+     *
+     *  @param[in] event  - the message that occurred
+     *  @param[in] now    - time of the occurrence
+     *  @param[in] detail - the state the message reports, a change is
+     *                      always let through
+     *
+     *  @return true if the caller should log the occurrence
+     */
+    bool admit(LogEvent event, TimePoint now, uint64_t detail = 0);
+
+    /** @brief Summarizes the messages whose window has run out
+     *
+     *  @param[in] now - current time
+     */
+    void flush(TimePoint now);
+
+    /** @brief Time flush() has a summary to log at, if any */
+    std::optional<TimePoint> nextFlush() const;
+
+    /** @brief Number of occurrences of the message suppressed so far */
+    uint64_t suppressed(LogEvent event) const
+    {
+        return states[static_cast<size_t>(event)].totalSuppressed;
+    }
+
+    /** @brief Number of those not yet reported in a summary */
+    uint64_t pending(LogEvent event) const
+    {
+        return states[static_cast<size_t>(event)].pending;
+    }
+
+  private:
+    static constexpr size_t EVENT_COUNT =
+        static_cast<size_t>(LogEvent::KickReceiveFailed) + 1;
+
+    /** @brief Rate limiting state of a single message */
+    struct State
+    {
+        bool seen = false;
+        TimePoint windowStart;
+        TimePoint lastSuppressed;
+        uint64_t detail = 0;
+        size_t admitted = 0;
+        uint64_t pending = 0;
+        uint64_t totalSuppressed = 0;
+    };
+
+    /** @brief Logs and clears the pending count of a message */
+    static void summarize(LogEvent event, State& state);
+
+    Duration window;
+    size_t burst;
+    std::array<State, EVENT_COUNT> states;
+};
+
+} // namespace watchdog
+} // namespace phosphor
@@ -0,0 +1,45 @@
+#include "loop_lag.hpp"
+
+#include <time.h>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+using namespace std::chrono;
+
+LoopLagProbe::LoopLagProbe(const sdeventplus::Event& event,
+                           Duration period) :
+    period(period),
+    source(event,
+           sdeventplus::Clock<sdeventplus::ClockId::Monotonic>(event).now() +
+               period,
+           microseconds(1),
+           [this](auto&, TimePoint scheduled) { probe(scheduled); })
+{
+    source.set_priority(TIMER_PRIORITY);
+    source.set_enabled(sdeventplus::source::Enabled::On);
+}
+
+void LoopLagProbe::probe(TimePoint scheduled)
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    auto now = TimePoint(seconds(ts.tv_sec) + nanoseconds(ts.tv_nsec));
+    auto lag = now > scheduled ? duration_cast<microseconds>(now - scheduled)
+                               : microseconds(0);
+    loop.lag.record(lag.count());
+
+    // Skip the probes missed while the loop was stuck rather than firing
+    // them back to back
+    auto next = scheduled + period;
+    if (next <= now)
+    {
+        next = now + period;
+    }
+    source.set_time(next);
+}
+
+} // namespace watchdog
+} // namespace phosphor
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "metrics.hpp"
+#include "timer.hpp"
+
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/source/time.hpp>
+
+#include <chrono>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+/** @class LoopLagProbe
+ *  @brief Periodic timer measuring how late the event loop dispatches it.
+ *  @details The probe runs at TIMER_PRIORITY, so its lag is the delay a
+ *  watchdog expiry would see when it is due at the same moment. The lag
+ *  is measured against CLOCK_MONOTONIC at dispatch rather than the time
+ *  cached by sd-event for the loop iteration.
+ */
+class LoopLagProbe
+{
+  public:
+    using Duration = Timer::Duration;
+    using TimePoint = Timer::TimePoint;
+
+    LoopLagProbe() = delete;
+    LoopLagProbe(const LoopLagProbe&) = delete;
+    LoopLagProbe& operator=(const LoopLagProbe&) = delete;
+    LoopLagProbe(LoopLagProbe&&) = delete;
+    LoopLagProbe& operator=(LoopLagProbe&&) = delete;
+
+    /** @brief Starts probing
+     *
+     *  @param[in] event  - event loop to probe
+     *  @param[in] period - time between probes
+     */
+    LoopLagProbe(const sdeventplus::Event& event, Duration period);
+
+    /** @brief Gets the lag measured so far */
+    inline const LoopMetrics& metrics() const
+    {
+        return loop;
+    }
+
+  private:
+    /** @brief Time between probes */
+    Duration period;
+
+    /** @brief Probe timer */
+    sdeventplus::source::Time<sdeventplus::ClockId::Monotonic> source;
+
+    /** @brief Measured lag */
+    LoopMetrics loop;
+
+    /** @brief Records the lag of a probe and schedules the next */
+    void probe(TimePoint scheduled);
+};
+
+} // namespace watchdog
+} // namespace phosphor
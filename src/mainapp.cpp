@@ -14,8 +14,19 @@
  * limitations under the License.
  */
 
+#include "executor.hpp"
+#include "kernel_watchdog.hpp"
+#include "kick_socket.hpp"
+#include "loop_lag.hpp"
+#include "metrics_socket.hpp"
+#include "rt_timer.hpp"
+#include "service_notifier.hpp"
+#include "status_writer.hpp"
+#include "timer_queue.hpp"
 #include "watchdog.hpp"
 
+#include <sys/mman.h>
+
 #include <CLI/CLI.hpp>
 #include <phosphor-logging/elog-errors.hpp>
 #include <phosphor-logging/elog.hpp>
@@ -29,10 +40,20 @@
 #include <stdplus/signal.hpp>
 #include <xyz/openbmc_project/Common/error.hpp>
 
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
 #include <functional>
 #include <iostream>
+#include <memory>
 #include <optional>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
 
 using phosphor::watchdog::Watchdog;
 using sdbusplus::xyz::openbmc_project::State::server::convertForMessage;
@@ -58,60 +79,126 @@ void printFallback(const Watchdog::Fallback& fallback)
     std::cerr << std::flush;
 }
 
-int main(int argc, char* argv[])
+/** @brief Command line options describing a single watchdog instance */
+struct WatchdogOptions
 {
-    using namespace phosphor::logging;
-    using InternalFailure =
-        sdbusplus::xyz::openbmc_project::Common::Error::InternalFailure;
+    std::string path;
+    std::optional<std::string> target;
+    std::vector<std::string> actionTargets;
+    std::vector<std::string> actionExecutors;
+    std::optional<std::string> fallbackAction;
+    std::optional<unsigned> fallbackIntervalMs;
+    bool fallbackAlways{false};
+    bool watchPostcodes{false};
+    uint64_t kickCoalesceMs = 0;
+    uint64_t logWindowS = 60;
+    bool deferSignals{false};
+    std::optional<std::string> kickSocket;
+    std::vector<uid_t> kickUids;
+    std::optional<std::string> statusPage;
+    size_t historySize = phosphor::watchdog::History::DEFAULT_SIZE;
+    std::string historyFile;
+    std::string stateFile;
+    uint64_t stateSlackMs = 1000;
+    std::optional<std::string> kernelWatchdog;
+    uint64_t kernelMarginS = 2;
+    uint64_t minInterval = phosphor::watchdog::DEFAULT_MIN_INTERVAL_MS;
+    // 0 to indicate to use default from PDI if not passed in
+    uint64_t defaultInterval = 0;
+};
 
-    CLI::App app{"Canonical openbmc host watchdog daemon"};
+/** @brief Fully resolved parameters used to construct a watchdog */
+struct WatchdogConfig
+{
+    std::string path;
+    Watchdog::ActionTargetMap actionTargetMap;
+    std::vector<std::pair<Watchdog::Action, std::string>> actionExecutors;
+    std::optional<Watchdog::Fallback> fallback;
+    bool watchPostcodes;
+    uint64_t kickCoalesceMs;
+    uint64_t logWindowS;
+    bool deferSignals;
+    std::optional<std::string> kickSocket;
+    std::vector<uid_t> kickUids;
+    std::optional<std::string> statusPage;
+    size_t historySize;
+    std::string historyFile;
+    std::string stateFile;
+    uint64_t stateSlackMs;
+    std::optional<std::string> kernelWatchdog;
+    uint64_t kernelMarginS;
+    uint64_t minInterval;
+    uint64_t defaultInterval;
+};
 
+/** @brief Accepts D-Bus object paths, which commonObjectPath() relies on
+ *         to be absolute.
+ */
+const CLI::Validator objectPath(
+    [](std::string& path) -> std::string {
+        if (path == "/")
+        {
+            return {};
+        }
+        if (!path.starts_with('/') || path.ends_with('/') ||
+            path.find("//") != std::string::npos)
+        {
+            return "Object path must be absolute with no empty elements: " +
+                   path;
+        }
+        for (char c : path)
+        {
+            if (c != '/' && c != '_' &&
+                !std::isalnum(static_cast<unsigned char>(c)))
+            {
+                return "Object path may only contain [A-Za-z0-9_/]: " + path;
+            }
+        }
+        return {};
+    },
+    "OBJECT_PATH");
+
+void addWatchdogOptions(CLI::App& app, WatchdogOptions& opts)
+{
     // Service related options
     const std::string serviceGroup = "Service Options";
-    std::string path;
-    app.add_option("-p,--path", path,
+    app.add_option("-p,--path", opts.path,
                    "DBus Object Path. "
                    "Ex: /xyz/openbmc_project/state/watchdog/host0")
-        ->required()
-        ->group(serviceGroup);
-    std::string service;
-    app.add_option("-s,--service", service,
-                   "DBus Service Name. "
-                   "Ex: xyz.openbmc_project.State.Watchdog.Host")
-        ->required()
-        ->group(serviceGroup);
-    bool continueAfterTimeout{false};
-    app.add_flag("-c,--continue", continueAfterTimeout,
-                 "Continue daemon after watchdog timeout")
+        ->check(objectPath)
         ->group(serviceGroup);
 
     // Target related options
     const std::string targetGroup = "Target Options";
-    std::optional<std::string> target;
-    app.add_option("-t,--target", target,
+    app.add_option("-t,--target", opts.target,
                    "Systemd unit to be called on "
                    "timeout for all actions but NONE. "
                    "Deprecated, use --action_target instead.")
         ->group(targetGroup);
-    std::vector<std::string> actionTargets;
-    app.add_option("-a,--action_target", actionTargets,
+    app.add_option("-a,--action_target", opts.actionTargets,
                    "Map of action to "
                    "systemd unit to be called on timeout if that action is "
                    "set for ExpireAction when the timer expires.")
         ->group(targetGroup);
+    app.add_option("--action_executor", opts.actionExecutors,
+                   "Map of action to an executor carrying it out directly "
+                   "instead of through a systemd job. The target of the "
+                   "action is only started if the executor fails. Ex: "
+                   "HardReset=file:/sys/class/gpio/gpio42/value:1 or "
+                   "PowerOff=property:<service>:<path>:<interface>:"
+                   "<property>:<value>")
+        ->group(targetGroup);
 
     // Fallback related options
     const std::string fallbackGroup = "Fallback Options";
-    std::optional<std::string> fallbackAction;
     auto fallbackActionOpt =
-        app.add_option("-f,--fallback_action", fallbackAction,
+        app.add_option("-f,--fallback_action", opts.fallbackAction,
                        "Enables the "
                        "watchdog even when disabled via the dbus interface. "
                        "Perform this action when the fallback expires.")
             ->group(fallbackGroup);
-    std::optional<unsigned> fallbackIntervalMs;
     auto fallbackIntervalOpt =
-        app.add_option("-i,--fallback_interval", fallbackIntervalMs,
+        app.add_option("-i,--fallback_interval", opts.fallbackIntervalMs,
                        "Enables the "
                        "watchdog even when disabled via the dbus interface. "
                        "Waits for this interval before performing the fallback "
@@ -119,8 +206,7 @@ int main(int argc, char* argv[])
             ->group(fallbackGroup);
     fallbackIntervalOpt->needs(fallbackActionOpt);
     fallbackActionOpt->needs(fallbackIntervalOpt);
-    bool fallbackAlways{false};
-    app.add_flag("-e,--fallback_always", fallbackAlways,
+    app.add_flag("-e,--fallback_always", opts.fallbackAlways,
                  "Enables the "
                  "watchdog even when disabled by the dbus interface. "
                  "This option is only valid with a fallback specified")
@@ -129,93 +215,345 @@ int main(int argc, char* argv[])
         ->needs(fallbackIntervalOpt);
 
     // Should we watch for postcodes
-    bool watchPostcodes{false};
-    app.add_flag("-w,--watch_postcodes", watchPostcodes,
+    app.add_flag("-w,--watch_postcodes", opts.watchPostcodes,
                  "Should we reset the time remaining any time a postcode "
                  "is signaled.");
+    app.add_option("-k,--kick_coalesce", opts.kickCoalesceMs,
+                   "Absorb postcode kicks arriving within this many "
+                   "milliseconds of the last applied one. The deadline is "
+                   "only extended when the timer would otherwise expire.");
+
+    // How often repeating messages are logged
+    app.add_option("-l,--log_window", opts.logWindowS,
+                   "Log a repeating message at most once in this many "
+                   "seconds, summarizing the repeats suppressed in "
+                   "between. 0 logs every repeat.");
+
+    // Should property changes be batched
+    app.add_flag("-b,--batch_signals", opts.deferSignals,
+                 "Signal property changes once per event loop iteration "
+                 "rather than on every change.");
+
+    // Local kick endpoint
+    auto kickSocketOpt =
+        app.add_option("-x,--kick_socket", opts.kickSocket,
+                       "Reset the time remaining for every datagram "
+                       "received on a unix socket bound to this path.");
+    app.add_option("-u,--kick_uid", opts.kickUids,
+                   "User allowed to kick through the socket. Only root is "
+                   "allowed if none are given.")
+        ->needs(kickSocketOpt);
+
+    // Memory mapped state
+    app.add_option("-o,--status_page", opts.statusPage,
+                   "Publish the watchdog state to a memory mapped page at "
+                   "this path. Ex: /run/watchdog/host0.status");
+
+    // Event history
+    app.add_option("-z,--history_size", opts.historySize,
+                   "Number of the latest kicks, interval changes, arms and "
+                   "timeouts kept for DumpHistory.");
+    app.add_option("-j,--history_file", opts.historyFile,
+                   "Write the history to this file on every timeout. "
+                   "Ex: /run/watchdog/host0.history");
+    app.add_option("-v,--state_file", opts.stateFile,
+                   "Checkpoint the configuration and countdown to this file "
+                   "and resume from it when restarted. "
+                   "Ex: /run/watchdog/host0.state");
+    app.add_option("--state_slack", opts.stateSlackMs,
+                   "Longest a kick may go without being checkpointed, in "
+                   "milliseconds. Kicks are batched up to this long so that "
+                   "they never wait on the file.");
+    app.add_option("-K,--kernel_watchdog", opts.kernelWatchdog,
+                   "Mirror the countdown into this Linux watchdog device so "
+                   "the kernel carries it if the daemon dies. It is stopped "
+                   "with a magic close when the daemon exits cleanly. "
+                   "Ex: /dev/watchdog1");
+    app.add_option("--kernel_margin", opts.kernelMarginS,
+                   "Seconds the kernel watchdog runs past the countdown. If "
+                   "the daemon dies, the host is reset between the deadline "
+                   "and this many seconds plus one past it. Kicks reprogram "
+                   "the device at most once per margin.")
+        ->check(CLI::PositiveNumber);
 
     // Interval related options
-    uint64_t minInterval = phosphor::watchdog::DEFAULT_MIN_INTERVAL_MS;
-    app.add_option("-m,--min_interval", minInterval,
+    app.add_option("-m,--min_interval", opts.minInterval,
                    "Set minimum interval for watchdog in milliseconds");
-
-    // 0 to indicate to use default from PDI if not passed in
-    uint64_t defaultInterval = 0;
-    app.add_option("-d,--default_interval", defaultInterval,
+    app.add_option("-d,--default_interval", opts.defaultInterval,
                    "Set default interval for watchdog in milliseconds");
+}
 
-    CLI11_PARSE(app, argc, argv);
+/** @brief Splits an <action>=<value> option into its action and value
+ *
+ *  @param[in] arg    - option value
+ *  @param[in] option - option name for errors
+ *  @param[in] what   - what the value is for errors
+ */
+std::optional<std::pair<Watchdog::Action, std::string>>
+    parseActionOption(const std::string& arg, std::string_view option,
+                      std::string_view what)
+{
+    size_t keyValueSplit = arg.find("=");
+    if (keyValueSplit == std::string::npos)
+    {
+        std::cerr << "Invalid " << option << " format, expect <action>=<"
+                  << what << ">." << std::endl;
+        return std::nullopt;
+    }
+
+    std::string key = arg.substr(0, keyValueSplit);
+    std::string value = arg.substr(keyValueSplit + 1);
+
+    // Convert an action from a fully namespaced value
+    try
+    {
+        return std::make_pair(Watchdog::convertActionFromString(key),
+                              std::move(value));
+    }
+    catch (const sdbusplus::exception::InvalidEnumString&)
+    {
+        std::cerr << "Bad action specified: " << key << std::endl;
+        return std::nullopt;
+    }
+}
 
+std::optional<WatchdogConfig> buildWatchdogConfig(WatchdogOptions&& opts)
+{
     // Put together a list of actions and associated systemd targets
     // The new --action_target options take precedence over the legacy
     // --target
     Watchdog::ActionTargetMap actionTargetMap;
-    if (target)
+    if (opts.target)
     {
-        actionTargetMap[Watchdog::Action::HardReset] = *target;
-        actionTargetMap[Watchdog::Action::PowerOff] = *target;
-        actionTargetMap[Watchdog::Action::PowerCycle] = *target;
+        actionTargetMap[Watchdog::Action::HardReset] = *opts.target;
+        actionTargetMap[Watchdog::Action::PowerOff] = *opts.target;
+        actionTargetMap[Watchdog::Action::PowerCycle] = *opts.target;
     }
-    for (const auto& actionTarget : actionTargets)
+    for (const auto& actionTarget : opts.actionTargets)
     {
-        size_t keyValueSplit = actionTarget.find("=");
-        if (keyValueSplit == std::string::npos)
+        auto parsed = parseActionOption(actionTarget, "action_target",
+                                        "target");
+        if (!parsed)
         {
-            std::cerr << "Invalid action_target format, "
-                         "expect <action>=<target>."
+            return std::nullopt;
+        }
+        auto& [action, value] = *parsed;
+
+        // Detect duplicate action target arguments
+        if (actionTargetMap.find(action) != actionTargetMap.end())
+        {
+            std::cerr << "Got duplicate action: " << convertForMessage(action)
                       << std::endl;
-            return 1;
+            return std::nullopt;
         }
 
-        std::string key = actionTarget.substr(0, keyValueSplit);
-        std::string value = actionTarget.substr(keyValueSplit + 1);
+        actionTargetMap[action] = std::move(value);
+    }
+    printActionTargetMap(actionTargetMap);
 
-        // Convert an action from a fully namespaced value
-        Watchdog::Action action;
-        try
+    // Executors are only created once the bus is up
+    std::vector<std::pair<Watchdog::Action, std::string>> actionExecutors;
+    for (const auto& actionExecutor : opts.actionExecutors)
+    {
+        auto parsed = parseActionOption(actionExecutor, "action_executor",
+                                        "executor");
+        if (!parsed)
         {
-            action = Watchdog::convertActionFromString(key);
+            return std::nullopt;
         }
-        catch (const sdbusplus::exception::InvalidEnumString&)
+        for (const auto& [action, spec] : actionExecutors)
         {
-            std::cerr << "Bad action specified: " << key << std::endl;
-            return 1;
+            if (action == parsed->first)
+            {
+                std::cerr << "Got duplicate executor action: "
+                          << convertForMessage(action) << std::endl;
+                return std::nullopt;
+            }
         }
-
-        // Detect duplicate action target arguments
-        if (actionTargetMap.find(action) != actionTargetMap.end())
+        actionExecutors.push_back(std::move(*parsed));
+    }
+    if (!actionExecutors.empty())
+    {
+        std::cerr << "Action Executors:\n";
+        for (const auto& [action, spec] : actionExecutors)
         {
-            std::cerr << "Got duplicate action: " << key << std::endl;
-            return 1;
+            std::cerr << "  " << convertForMessage(action) << " -> " << spec
+                      << "\n";
         }
-
-        actionTargetMap[action] = std::move(value);
     }
-    printActionTargetMap(actionTargetMap);
 
     // Build the fallback option used for the Watchdog
     std::optional<Watchdog::Fallback> maybeFallback;
-    if (fallbackAction)
+    if (opts.fallbackAction)
     {
         Watchdog::Fallback fallback;
         try
         {
             fallback.action =
-                Watchdog::convertActionFromString(*fallbackAction);
+                Watchdog::convertActionFromString(*opts.fallbackAction);
         }
         catch (const sdbusplus::exception::InvalidEnumString&)
         {
-            std::cerr << "Bad fallback action specified: " << *fallbackAction
-                      << std::endl;
-            return 1;
+            std::cerr << "Bad fallback action specified: "
+                      << *opts.fallbackAction << std::endl;
+            return std::nullopt;
         }
-        fallback.interval = *fallbackIntervalMs;
-        fallback.always = fallbackAlways;
+        fallback.interval = *opts.fallbackIntervalMs;
+        fallback.always = opts.fallbackAlways;
 
         printFallback(fallback);
         maybeFallback = fallback;
     }
 
+    return WatchdogConfig{std::move(opts.path),
+                          std::move(actionTargetMap),
+                          std::move(actionExecutors),
+                          std::move(maybeFallback),
+                          opts.watchPostcodes,
+                          opts.kickCoalesceMs,
+                          opts.logWindowS,
+                          opts.deferSignals,
+                          std::move(opts.kickSocket),
+                          std::move(opts.kickUids),
+                          std::move(opts.statusPage),
+                          opts.historySize,
+                          std::move(opts.historyFile),
+                          std::move(opts.stateFile),
+                          opts.stateSlackMs,
+                          std::move(opts.kernelWatchdog),
+                          opts.kernelMarginS,
+                          opts.minInterval,
+                          opts.defaultInterval};
+}
+
+/** @brief Finds the deepest object path that is a parent of every path
+ *         so that a single object manager can serve all of them.
+ */
+std::string commonObjectPath(const std::vector<WatchdogConfig>& configs)
+{
+    std::string common = configs.front().path;
+    for (const auto& config : configs)
+    {
+        // Trim path elements until this is a parent of the config path
+        while (config.path != common && !config.path.starts_with(common + "/"))
+        {
+            common.resize(common.rfind('/'));
+        }
+    }
+    return common.empty() ? "/" : common;
+}
+
+int main(int argc, char* argv[])
+{
+    using namespace phosphor::logging;
+    using InternalFailure =
+        sdbusplus::xyz::openbmc_project::Common::Error::InternalFailure;
+
+    CLI::App app{"Canonical openbmc host watchdog daemon"};
+
+    // Service related options
+    const std::string serviceGroup = "Service Options";
+    std::string service;
+    app.add_option("-s,--service", service,
+                   "DBus Service Name. "
+                   "Ex: xyz.openbmc_project.State.Watchdog.Host")
+        ->required()
+        ->group(serviceGroup);
+    bool continueAfterTimeout{false};
+    app.add_flag("-c,--continue", continueAfterTimeout,
+                 "Continue daemon after watchdog timeout. "
+                 "Implied when hosting multiple instances.")
+        ->group(serviceGroup);
+    std::vector<std::string> instances;
+    app.add_option("-n,--instance", instances,
+                   "Host an additional watchdog in this daemon. Takes a "
+                   "quoted list of the per watchdog options. "
+                   "Ex: \"-p /xyz/openbmc_project/watchdog/host1 -a ...\"")
+        ->group(serviceGroup);
+    bool sharedTimer{false};
+    auto sharedTimerOpt =
+        app.add_flag("-q,--shared_timer", sharedTimer,
+                     "Drive every hosted watchdog from a single shared timer "
+                     "instead of one sd-event timer per watchdog.")
+            ->group(serviceGroup);
+    int rtPriority{0};
+    app.add_option("-r,--rt_priority", rtPriority,
+                   "Detect expiries on a dedicated thread per watchdog "
+                   "running SCHED_FIFO at this priority, with the daemon "
+                   "memory locked, so a stalled D-Bus handler cannot delay "
+                   "them. 0 keeps expiries on the event loop.")
+        ->check(CLI::Range(0, 99))
+        ->excludes(sharedTimerOpt)
+        ->group(serviceGroup);
+
+    std::optional<std::string> metricsSocket;
+    app.add_option("-y,--metrics_socket", metricsSocket,
+                   "Serve the metrics of every hosted watchdog in the "
+                   "Prometheus text format on a unix socket bound to this "
+                   "path. Ex: /run/watchdog/metrics.sock")
+        ->group(serviceGroup);
+    uint64_t lagProbeInterval{0};
+    app.add_option("-g,--lag_probe_interval", lagProbeInterval,
+                   "Measure how late the event loop dispatches timers every "
+                   "this many milliseconds and add the lag to the metrics "
+                   "socket. 0 disables the probe.")
+        ->group(serviceGroup);
+
+    WatchdogOptions mainOptions;
+    addWatchdogOptions(app, mainOptions);
+
+    CLI11_PARSE(app, argc, argv);
+
+    // Every instance shares the event loop, bus and object manager but
+    // is otherwise configured independently
+    std::vector<WatchdogOptions> allOptions;
+    allOptions.reserve(instances.size() + 1);
+    if (!mainOptions.path.empty())
+    {
+        allOptions.push_back(std::move(mainOptions));
+    }
+    for (const auto& instance : instances)
+    {
+        CLI::App instanceApp{"Watchdog instance"};
+        WatchdogOptions& opts = allOptions.emplace_back();
+        addWatchdogOptions(instanceApp, opts);
+        try
+        {
+            instanceApp.parse(instance);
+        }
+        catch (const CLI::ParseError& e)
+        {
+            std::cerr << "Bad instance specified: " << instance << std::endl;
+            return instanceApp.exit(e);
+        }
+    }
+    if (allOptions.empty())
+    {
+        std::cerr << "--path or --instance is required" << std::endl;
+        return 1;
+    }
+
+    std::vector<WatchdogConfig> configs;
+    configs.reserve(allOptions.size());
+    for (auto& opts : allOptions)
+    {
+        if (opts.path.empty())
+        {
+            std::cerr << "Instance is missing --path" << std::endl;
+            return 1;
+        }
+        auto config = buildWatchdogConfig(std::move(opts));
+        if (!config)
+        {
+            return 1;
+        }
+        configs.push_back(std::move(*config));
+    }
+
+    // Exiting on timeout would tear down every other watchdog hosted
+    // by this daemon along with the one that expired.
+    bool exitAfterTimeout = !continueAfterTimeout && configs.size() == 1;
+
     try
     {
         // Get a default event loop
@@ -225,29 +563,231 @@ int main(int argc, char* argv[])
         auto bus = sdbusplus::bus::new_default();
 
         // Add systemd object manager.
-        sdbusplus::server::manager_t watchdogManager(bus, path.c_str());
+        std::string managerPath = commonObjectPath(configs);
+        sdbusplus::server::manager_t watchdogManager(bus, managerPath.c_str());
 
-        // Create a watchdog object
-        Watchdog watchdog(bus, path.c_str(), event, std::move(actionTargetMap),
-                          std::move(maybeFallback), minInterval,
-                          defaultInterval,
-                          /*exitAfterTimeout=*/!continueAfterTimeout);
+        // Keep the expiry threads from stalling on page faults
+        if (rtPriority > 0 && mlockall(MCL_CURRENT | MCL_FUTURE) < 0)
+        {
+            std::cerr << "Failed to lock memory: " << strerror(errno)
+                      << std::endl;
+        }
+
+        // The shared queue drives every watchdog from one time source so
+        // kicks no longer reprogram a timer of their own
+        std::optional<phosphor::watchdog::TimerQueue> timerQueue;
+        if (sharedTimer)
+        {
+            timerQueue.emplace(event);
+        }
+
+        // Status pages outlive the watchdogs updating them
+        std::vector<std::unique_ptr<phosphor::watchdog::StatusWriter>>
+            statusWriters;
+        // So do the kernel watchdogs, they are stopped when the daemon
+        // exits cleanly
+        std::vector<std::unique_ptr<phosphor::watchdog::KernelWatchdog>>
+            kernelWatchdogs;
+
+        // Create the watchdog objects
+        std::vector<std::unique_ptr<Watchdog>> watchdogs;
+        std::vector<std::unique_ptr<sdbusplus::bus::match_t>>
+            watchPostcodeMatches;
+        std::vector<std::unique_ptr<phosphor::watchdog::KickSocket>>
+            kickSockets;
+        for (auto& config : configs)
+        {
+            std::unique_ptr<phosphor::watchdog::Timer> timer;
+            if (rtPriority > 0)
+            {
+                try
+                {
+                    timer = std::make_unique<phosphor::watchdog::RtTimer>(
+                        event, rtPriority);
+                }
+                catch (const std::system_error& e)
+                {
+                    std::cerr << "Failed to set up expiry thread: "
+                              << e.what() << std::endl;
+                    return 1;
+                }
+            }
+            else if (timerQueue)
+            {
+                timer = std::make_unique<phosphor::watchdog::QueuedTimer>(
+                    *timerQueue);
+            }
+            else
+            {
+                timer = std::make_unique<phosphor::watchdog::EventTimer>(event);
+            }
+
+            auto& watchdog = *watchdogs.emplace_back(
+                std::make_unique<Watchdog>(
+                    bus, config.path.c_str(), event, std::move(timer),
+                    std::move(config.actionTargetMap),
+                    std::move(config.fallback), config.minInterval,
+                    config.defaultInterval, exitAfterTimeout));
+            watchdog.setKickCoalesceWindow(
+                std::chrono::milliseconds(config.kickCoalesceMs));
+            watchdog.setLogWindow(std::chrono::seconds(config.logWindowS));
+            watchdog.setDeferSignals(config.deferSignals);
+            watchdog.setHistorySize(config.historySize);
+            watchdog.setHistoryFile(config.historyFile);
+            for (const auto& [action, spec] : config.actionExecutors)
+            {
+                try
+                {
+                    watchdog.setExecutor(
+                        action, phosphor::watchdog::makeExecutor(bus, spec));
+                }
+                catch (const std::invalid_argument& e)
+                {
+                    std::cerr << "Bad executor specified: " << spec << ": "
+                              << e.what() << std::endl;
+                    return 1;
+                }
+            }
+
+            if (config.watchPostcodes)
+            {
+                watchPostcodeMatches.emplace_back(
+                    std::make_unique<sdbusplus::bus::match_t>(
+                        bus,
+                        sdbusplus::match_rules::propertiesChanged(
+                            "/xyz/openbmc_project/state/boot/raw0",
+                            "xyz.openbmc_project.State.Boot.Raw"),
+                        std::bind(&Watchdog::kick, std::ref(watchdog))));
+            }
 
-        std::optional<sdbusplus::match> watchPostcodeMatch;
-        if (watchPostcodes)
+            // Everything following the state of the watchdog
+            std::vector<Watchdog::StateCallback> followers;
+
+            if (config.statusPage)
+            {
+                try
+                {
+                    auto& writer = *statusWriters.emplace_back(
+                        std::make_unique<phosphor::watchdog::StatusWriter>(
+                            *config.statusPage));
+                    writer.update(phosphor::watchdog::statusOf(watchdog));
+                    followers.emplace_back([&writer, &watchdog] {
+                        writer.update(phosphor::watchdog::statusOf(watchdog));
+                    });
+                }
+                catch (const std::system_error& e)
+                {
+                    std::cerr << "Failed to set up status page: " << e.what()
+                              << std::endl;
+                    return 1;
+                }
+            }
+
+            if (config.kernelWatchdog)
+            {
+                auto& device = *kernelWatchdogs.emplace_back(
+                    std::make_unique<phosphor::watchdog::KernelWatchdog>(
+                        event, *config.kernelWatchdog,
+                        std::chrono::seconds(config.kernelMarginS)));
+                // Every countdown stops along with the loop, so the first
+                // of them holds off the kernel
+                device.update(watchdog.earliestDeadline());
+                followers.emplace_back([&device, &watchdog] {
+                    device.update(watchdog.earliestDeadline());
+                });
+            }
+
+            if (followers.size() == 1)
+            {
+                watchdog.setStateCallback(std::move(followers.front()));
+            }
+            else if (!followers.empty())
+            {
+                watchdog.setStateCallback(
+                    [followers = std::move(followers)] {
+                        for (const auto& follower : followers)
+                        {
+                            follower();
+                        }
+                    });
+            }
+
+            // Resume only once everything follows the watchdog
+            watchdog.setStateFile(
+                config.stateFile,
+                std::chrono::milliseconds(config.stateSlackMs));
+
+            if (config.kickSocket)
+            {
+                try
+                {
+                    kickSockets.emplace_back(
+                        std::make_unique<phosphor::watchdog::KickSocket>(
+                            event, *config.kickSocket,
+                            std::move(config.kickUids),
+                            std::bind(&Watchdog::kick, std::ref(watchdog))));
+                }
+                catch (const std::system_error& e)
+                {
+                    std::cerr << "Failed to set up kick socket: " << e.what()
+                              << std::endl;
+                    return 1;
+                }
+            }
+        }
+
+        std::optional<phosphor::watchdog::LoopLagProbe> lagProbe;
+        if (lagProbeInterval > 0)
         {
-            watchPostcodeMatch.emplace(
-                bus,
-                sdbusplus::match_rules::propertiesChanged(
-                    "/xyz/openbmc_project/state/boot/raw0",
-                    "xyz.openbmc_project.State.Boot.Raw"),
-                std::bind(&Watchdog::resetTimeRemaining, std::ref(watchdog),
-                          false));
+            lagProbe.emplace(event,
+                             std::chrono::milliseconds(lagProbeInterval));
+        }
+
+        std::optional<phosphor::watchdog::MetricsSocket> metricsServer;
+        if (metricsSocket)
+        {
+            std::vector<phosphor::watchdog::LabeledMetrics> sources;
+            for (size_t i = 0; i < watchdogs.size(); ++i)
+            {
+                sources.emplace_back(configs[i].path,
+                                     &watchdogs[i]->metrics());
+            }
+            try
+            {
+                const phosphor::watchdog::LoopMetrics* loop =
+                    lagProbe ? &lagProbe->metrics() : nullptr;
+                metricsServer.emplace(event, *metricsSocket, [sources, loop] {
+                    return phosphor::watchdog::formatMetrics(sources, loop);
+                });
+            }
+            catch (const std::system_error& e)
+            {
+                std::cerr << "Failed to set up metrics socket: " << e.what()
+                          << std::endl;
+                return 1;
+            }
         }
 
         // Claim the bus
         bus.request_name(service.c_str());
 
+        // Only report ready once the watchdogs can be reached on the bus,
+        // so units ordered after us no longer need to poll for the name.
+        // Pings stop if the loop stalls or a countdown goes unserviced.
+        auto pingPeriod = phosphor::watchdog::ServiceNotifier::pingPeriod();
+        phosphor::watchdog::ServiceNotifier notifier(
+            event, pingPeriod, [&watchdogs, pingPeriod] {
+                for (const auto& watchdog : watchdogs)
+                {
+                    if (!watchdog->healthy(*pingPeriod))
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            });
+        notifier.ready();
+
         auto intCb = [](sdeventplus::source::Signal& s,
                         const struct signalfd_siginfo*) {
             s.get_event().exit(0);
@@ -0,0 +1,125 @@
+#include "metrics.hpp"
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+namespace
+{
+
+/** @brief Appends the header of a metric family */
+void header(std::string& out, std::string_view name, std::string_view type,
+            std::string_view help)
+{
+    out.append("# HELP phosphor_watchdog_").append(name);
+    out.append(" ").append(help).append("\n");
+    out.append("# TYPE phosphor_watchdog_").append(name);
+    out.append(" ").append(type).append("\n");
+}
+
+/** @brief Appends a single sample, labeled with the path if given */
+void sample(std::string& out, std::string_view name, std::string_view path,
+            std::string_view le, uint64_t value)
+{
+    out.append("phosphor_watchdog_").append(name);
+    std::string_view separator = "{";
+    if (!path.empty())
+    {
+        out.append(separator).append("path=\"").append(path).append("\"");
+        separator = ",";
+    }
+    if (!le.empty())
+    {
+        out.append(separator).append("le=\"").append(le).append("\"");
+        separator = ",";
+    }
+    if (separator != "{")
+    {
+        out.append("}");
+    }
+    out.append(" ").append(std::to_string(value)).append("\n");
+}
+
+/** @brief Appends a counter family covering every watchdog */
+void counter(std::string& out, const std::vector<LabeledMetrics>& sources,
+             std::string_view name, std::string_view help,
+             const Counter WatchdogMetrics::*member)
+{
+    header(out, name, "counter", help);
+    for (const auto& [path, metrics] : sources)
+    {
+        sample(out, name, path, {}, (metrics->*member).get());
+    }
+}
+
+/** @brief Appends the samples of a single histogram */
+template <size_t N>
+void histogramSamples(std::string& out, std::string_view name,
+                      std::string_view path, const Histogram<N>& hist)
+{
+    auto bucketName = std::string(name) + "_bucket";
+    auto buckets = hist.buckets();
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < N; ++i)
+    {
+        cumulative += buckets[i];
+        sample(out, bucketName, path, std::to_string(hist.upperBounds()[i]),
+               cumulative);
+    }
+    cumulative += buckets[N];
+    sample(out, bucketName, path, "+Inf", cumulative);
+    sample(out, std::string(name) + "_sum", path, {}, hist.sum());
+    sample(out, std::string(name) + "_count", path, {}, cumulative);
+}
+
+/** @brief Appends a histogram family covering every watchdog */
+template <size_t N>
+void histogram(std::string& out, const std::vector<LabeledMetrics>& sources,
+               std::string_view name, std::string_view help,
+               const Histogram<N> WatchdogMetrics::*member)
+{
+    header(out, name, "histogram", help);
+    for (const auto& [path, metrics] : sources)
+    {
+        histogramSamples(out, name, path, metrics->*member);
+    }
+}
+
+} // namespace
+
+std::string formatMetrics(const std::vector<LabeledMetrics>& sources,
+                          const LoopMetrics* loop)
+{
+    std::string out;
+    counter(out, sources, "kicks_total",
+            "Resets of the countdown, including absorbed kicks.",
+            &WatchdogMetrics::kicks);
+    counter(out, sources, "expirations_total", "Times the timer ran out.",
+            &WatchdogMetrics::expirations);
+    counter(out, sources, "fallback_entries_total",
+            "Times the fallback countdown was armed.",
+            &WatchdogMetrics::fallbackEntries);
+    counter(out, sources, "start_unit_successes_total",
+            "Timeout actions started by systemd.",
+            &WatchdogMetrics::startUnitSuccesses);
+    counter(out, sources, "start_unit_failures_total",
+            "Timeout actions that failed to start after every retry.",
+            &WatchdogMetrics::startUnitFailures);
+    histogram(out, sources, "kick_margin_percent",
+              "Percent of the countdown left when kicked.",
+              &WatchdogMetrics::kickMargin);
+    histogram(out, sources, "start_unit_latency_ms",
+              "Time from expiry until StartUnit completed or gave up.",
+              &WatchdogMetrics::startUnitLatency);
+    if (loop != nullptr)
+    {
+        header(out, "loop_lag_us", "histogram",
+               "How late a timer at the watchdog priority was dispatched.");
+        histogramSamples(out, "loop_lag_us", {}, loop->lag);
+    }
+    return out;
+}
+
+} // namespace watchdog
+} // namespace phosphor
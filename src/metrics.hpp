@@ -0,0 +1,159 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+/** @class Counter
+ *  @brief Monotonic counter that can be read from any thread.
+ */
+class Counter
+{
+  public:
+    /** @brief Adds to the counter */
+    inline void add(uint64_t count = 1)
+    {
+        value.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    /** @brief Gets the current count */
+    inline uint64_t get() const
+    {
+        return value.load(std::memory_order_relaxed);
+    }
+
+  private:
+    std::atomic<uint64_t> value{0};
+};
+
+/** @class Histogram
+ *  @brief Lock free histogram over a fixed set of buckets.
+ *  @details A value lands in the first bucket whose upper bound it does
+ *  not exceed, or in the overflow bucket past the last bound.
+ */
+template <size_t N>
+class Histogram
+{
+  public:
+    using Bounds = std::array<uint64_t, N>;
+    using Buckets = std::array<uint64_t, N + 1>;
+
+    /** @brief Constructs the histogram
+     *
+     *  @param[in] bounds - inclusive upper bounds of the buckets, sorted
+     */
+    explicit Histogram(const Bounds& bounds) : bounds(bounds) {}
+
+    /** @brief Counts a value in its bucket */
+    inline void record(uint64_t value)
+    {
+        auto bucket = std::lower_bound(bounds.begin(), bounds.end(), value) -
+                      bounds.begin();
+        counts[bucket].fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    /** @brief Gets the upper bounds of the buckets */
+    inline const Bounds& upperBounds() const
+    {
+        return bounds;
+    }
+
+    /** @brief Gets the count of every bucket, overflow last */
+    Buckets buckets() const
+    {
+        Buckets result;
+        for (size_t i = 0; i < result.size(); ++i)
+        {
+            result[i] = counts[i].load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+    /** @brief Gets the sum of every recorded value */
+    inline uint64_t sum() const
+    {
+        return total.load(std::memory_order_relaxed);
+    }
+
+  private:
+    Bounds bounds;
+    std::array<std::atomic<uint64_t>, N + 1> counts{};
+    std::atomic<uint64_t> total{0};
+};
+
+/** @struct WatchdogMetrics
+ *  @brief Runtime counters of a single watchdog.
+ *  @details Everything is updated with relaxed atomics so the counters
+ *  never slow the timer paths and can be read from any thread.
+ */
+struct WatchdogMetrics
+{
+    /** @brief Kick margin buckets, percent of the countdown left */
+    static constexpr std::array<uint64_t, 10> MARGIN_BOUNDS = {
+        5, 10, 20, 30, 40, 50, 60, 70, 80, 90,
+    };
+
+    /** @brief StartUnit latency buckets, milliseconds */
+    static constexpr std::array<uint64_t, 12> LATENCY_BOUNDS_MS = {
+        1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000,
+    };
+
+    /** @brief Resets of the countdown, including absorbed kicks */
+    Counter kicks;
+    /** @brief Times the timer ran out */
+    Counter expirations;
+    /** @brief Times the fallback countdown was armed */
+    Counter fallbackEntries;
+    /** @brief Timeout actions started by systemd */
+    Counter startUnitSuccesses;
+    /** @brief Timeout actions that failed to start after every retry */
+    Counter startUnitFailures;
+
+    /** @brief Percent of the countdown left when kicked */
+    Histogram<MARGIN_BOUNDS.size()> kickMargin{MARGIN_BOUNDS};
+    /** @brief Time from expiry until StartUnit completed or gave up */
+    Histogram<LATENCY_BOUNDS_MS.size()> startUnitLatency{LATENCY_BOUNDS_MS};
+};
+
+/** @struct LoopMetrics
+ *  @brief Responsiveness of the event loop shared by the watchdogs.
+ */
+struct LoopMetrics
+{
+    /** @brief Loop lag buckets, microseconds */
+    static constexpr std::array<uint64_t, 12> LAG_BOUNDS_US = {
+        50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000,
+        250000,
+    };
+
+    /** @brief How late a timer at TIMER_PRIORITY was dispatched */
+    Histogram<LAG_BOUNDS_US.size()> lag{LAG_BOUNDS_US};
+};
+
+/** @brief Metrics of a watchdog labeled with its object path */
+using LabeledMetrics = std::pair<std::string, const WatchdogMetrics*>;
+
+/** @brief Renders metrics in the Prometheus text exposition format
+ *
+ *  @param[in] sources - the metrics of every watchdog to render
+ *  @param[in] loop    - the event loop metrics to render, if any
+ *
+ *  @return the rendered text
+ */
+std::string formatMetrics(const std::vector<LabeledMetrics>& sources,
+                          const LoopMetrics* loop = nullptr);
+
+} // namespace watchdog
+} // namespace phosphor
@@ -0,0 +1,118 @@
+#include "metrics_socket.hpp"
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+// Connections served per wakeup, so that scrapers connecting as fast as
+// they are served cannot hold up the event loop. The rest are picked up
+// on its next iteration.
+constexpr auto MAX_CLIENTS_PER_WAKEUP = 8;
+
+namespace
+{
+
+/** @brief Creates the listening stream socket */
+int listenSocket(const std::string& path)
+{
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path))
+    {
+        throw std::system_error(ENAMETOOLONG, std::generic_category(),
+                                "metrics socket path");
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), "socket");
+    }
+
+    unlink(path.c_str());
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        chmod(path.c_str(), 0666) < 0 || listen(fd, 8) < 0)
+    {
+        int error = errno;
+        close(fd);
+        throw std::system_error(error, std::generic_category(),
+                                "metrics socket " + path);
+    }
+    return fd;
+}
+
+} // namespace
+
+MetricsSocket::MetricsSocket(const sdeventplus::Event& event,
+                             const std::string& path, Render&& render) :
+    path(path), render(std::move(render)), fd(listenSocket(path)),
+    source(event, fd.get(), EPOLLIN,
+           [this](auto&, int, uint32_t) { accept(); })
+{}
+
+MetricsSocket::~MetricsSocket()
+{
+    unlink(path.c_str());
+}
+
+void MetricsSocket::accept()
+{
+    for (int i = 0; i < MAX_CLIENTS_PER_WAKEUP; ++i)
+    {
+        int client = accept4(fd.get(), nullptr, nullptr,
+                             SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client < 0)
+        {
+            int error = errno;
+            if (error == EINTR)
+            {
+                continue;
+            }
+            if (error != EAGAIN && error != EWOULDBLOCK)
+            {
+                lg2::error("watchdog: metrics socket accept failed: {ERROR}",
+                           "ERROR", strerror(error));
+            }
+            break;
+        }
+
+        // The rendering fits in the buffer of a fresh connection, so it is
+        // never waited on. Whatever does not fit is dropped.
+        auto text = render();
+        const char* data = text.data();
+        size_t left = text.size();
+        while (left > 0)
+        {
+            auto sent = send(client, data, left, MSG_NOSIGNAL);
+            if (sent < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (sent <= 0)
+            {
+                break;
+            }
+            data += sent;
+            left -= sent;
+        }
+        close(client);
+        servedCount++;
+    }
+}
+
+} // namespace watchdog
+} // namespace phosphor
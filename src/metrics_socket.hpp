@@ -0,0 +1,76 @@
+#pragma once
+
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/source/io.hpp>
+#include <stdplus/fd/managed.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+/** @class MetricsSocket
+ *  @brief Unix stream endpoint that writes the current metrics to every
+ *         client that connects.
+ *  @details Meant for local scrapers, e.g. `socat - UNIX:<path>`. Each
+ *  connection gets one rendering of the metrics and is then closed.
+ *  Nothing here blocks the event loop: connections are served a bounded
+ *  batch at a time and written to without waiting.
+ */
+class MetricsSocket
+{
+  public:
+    using Render = std::function<std::string()>;
+
+    MetricsSocket() = delete;
+    MetricsSocket(const MetricsSocket&) = delete;
+    MetricsSocket& operator=(const MetricsSocket&) = delete;
+    MetricsSocket(MetricsSocket&&) = delete;
+    MetricsSocket& operator=(MetricsSocket&&) = delete;
+
+    /** @brief Binds the socket and starts serving
+     *  @details Any stale socket at the path is replaced.
+     *
+     *  @param[in] event  - event loop the socket is serviced from
+     *  @param[in] path   - filesystem path to bind to
+     *  @param[in] render - renders the metrics for a client
+     *
+     *  @throws std::system_error if the socket could not be set up
+     */
+    MetricsSocket(const sdeventplus::Event& event, const std::string& path,
+                  Render&& render);
+
+    ~MetricsSocket();
+
+    /** @brief Number of clients served */
+    inline uint64_t served() const
+    {
+        return servedCount;
+    }
+
+  private:
+    /** @brief Path the socket is bound to */
+    std::string path;
+
+    /** @brief Renders the metrics */
+    Render render;
+
+    /** @brief The listening socket */
+    stdplus::ManagedFd fd;
+
+    /** @brief Watches the socket for connections */
+    sdeventplus::source::IO source;
+
+    /** @brief Clients served */
+    uint64_t servedCount = 0;
+
+    /** @brief Serves the pending connections, up to a bounded batch */
+    void accept();
+};
+
+} // namespace watchdog
+} // namespace phosphor
@@ -0,0 +1,29 @@
+#pragma once
+
+/** @file probes.hpp
+ *  @brief Static tracing probes of the phosphor_watchdog provider.
+ *  @details Building with -Dusdt=enabled turns every probe into a USDT
+ *  probe that bpftrace or perf can attach to. A probe site is a single
+ *  nop until something attaches, and without the option the probes and
+ *  their arguments are compiled out entirely. Every probe carries
+ *
+ *    arg0 - interval in milliseconds
+ *    arg1 - time remaining in milliseconds, before the kick for kick
+ *    arg2 - the Action taken on expiry
+ *    arg3 - a probe specific value, see the probe sites
+ *
+ *  See tools/watchdog.bt for an example.
+ */
+
+#ifdef WATCHDOG_USDT
+#include <sys/sdt.h>
+
+#define WATCHDOG_PROBE(name, interval, remaining, action, value)          \
+    DTRACE_PROBE4(phosphor_watchdog, name, interval, remaining,            \
+                  static_cast<int>(action), value)
+#else
+#define WATCHDOG_PROBE(name, interval, remaining, action, value)          \
+    do                                                                     \
+    {                                                                      \
+    } while (0)
+#endif
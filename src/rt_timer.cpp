@@ -0,0 +1,241 @@
+#include "rt_timer.hpp"
+
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+namespace
+{
+
+/** @brief Reads CLOCK_MONOTONIC in microseconds */
+int64_t monotonicUs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return int64_t{ts.tv_sec} * 1000000 + ts.tv_nsec / 1000;
+}
+
+/** @brief Wraps a descriptor returned by a system call */
+int checkFd(int fd, const char* what)
+{
+    if (fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+    return fd;
+}
+
+/** @brief Consumes the counter of an eventfd or timerfd */
+void drain(int fd)
+{
+    uint64_t count;
+    while (read(fd, &count, sizeof(count)) < 0 && errno == EINTR)
+    {}
+}
+
+/** @brief Adds one to the counter of an eventfd */
+void bump(int fd)
+{
+    uint64_t one = 1;
+    while (write(fd, &one, sizeof(one)) < 0 && errno == EINTR)
+    {}
+}
+
+} // namespace
+
+RtTimer::RtTimer(const sdeventplus::Event& event, int priority) :
+    wakeFd(checkFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC), "eventfd")),
+    timerFd(checkFd(timerfd_create(CLOCK_MONOTONIC,
+                                   TFD_NONBLOCK | TFD_CLOEXEC),
+                    "timerfd_create")),
+    notifyFd(checkFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC), "eventfd")),
+    source(event, notifyFd.get(), EPOLLIN,
+           [this](auto&, int, uint32_t) { dispatch(); })
+{
+    source.set_priority(TIMER_PRIORITY);
+    thread = std::thread(&RtTimer::run, this);
+
+    if (priority > 0)
+    {
+        sched_param param{};
+        param.sched_priority = priority;
+        int r = pthread_setschedparam(thread.native_handle(), SCHED_FIFO,
+                                      &param);
+        if (r != 0)
+        {
+            lg2::warning("watchdog: expiry thread left without real-time "
+                         "priority {PRIORITY}: {ERROR}",
+                         "PRIORITY", priority, "ERROR", strerror(r));
+        }
+    }
+}
+
+RtTimer::~RtTimer()
+{
+    stopping.store(true, std::memory_order_relaxed);
+    bump(wakeFd.get());
+    thread.join();
+}
+
+Timer::TimePoint RtTimer::now() const
+{
+    return TimePoint(Duration(monotonicUs()));
+}
+
+void RtTimer::setCallback(Callback&& callback)
+{
+    this->callback = std::move(callback);
+}
+
+bool RtTimer::hasExpired() const
+{
+    return expired.load(std::memory_order_acquire);
+}
+
+bool RtTimer::isEnabled() const
+{
+    return deadline.load(std::memory_order_acquire) != 0;
+}
+
+void RtTimer::setEnabled(bool enabled)
+{
+    if (!enabled)
+    {
+        publish(0);
+        return;
+    }
+    // Like an EventTimer, one never given a deadline is due straight away
+    publish(std::max<int64_t>(programmed.load(std::memory_order_relaxed), 1));
+}
+
+Timer::Duration RtTimer::getRemaining() const
+{
+    auto when = deadline.load(std::memory_order_acquire);
+    if (when == 0)
+    {
+        when = programmed.load(std::memory_order_relaxed);
+    }
+    auto now = monotonicUs();
+    return Duration(when > now ? when - now : 0);
+}
+
+void RtTimer::setRemaining(Duration remaining)
+{
+    // Never store 0, it stands for disabled
+    auto when = std::max<int64_t>(monotonicUs() + remaining.count(), 1);
+
+    // Only move a deadline that is still armed. Checking and publishing
+    // separately would let the expiry thread claim a one shot timer in
+    // between, and the publish would then re-arm it.
+    auto old = deadline.load(std::memory_order_acquire);
+    while (old != 0 && !deadline.compare_exchange_weak(
+                           old, when, std::memory_order_acq_rel))
+    {}
+    programmed.store(when, std::memory_order_relaxed);
+
+    // A later deadline is picked up when the thread wakes for the old one
+    if (old != 0 && when < old)
+    {
+        bump(wakeFd.get());
+    }
+}
+
+void RtTimer::restart(Duration interval)
+{
+    expired.store(false, std::memory_order_release);
+    this->interval.store(interval.count(), std::memory_order_relaxed);
+    auto when = std::max<int64_t>(monotonicUs() + interval.count(), 1);
+    programmed.store(when, std::memory_order_relaxed);
+    publish(when);
+}
+
+Timer::TimePoint RtTimer::expiredAt() const
+{
+    return TimePoint(Duration(lastExpiry.load(std::memory_order_acquire)));
+}
+
+void RtTimer::publish(int64_t value)
+{
+    auto old = deadline.exchange(value, std::memory_order_acq_rel);
+    // A later deadline is picked up when the thread wakes for the old one
+    if (value != 0 && (old == 0 || value < old))
+    {
+        bump(wakeFd.get());
+    }
+}
+
+bool RtTimer::claim(int64_t expected, int64_t now)
+{
+    auto period = interval.load(std::memory_order_relaxed);
+    auto next = period > 0 ? now + period : 0;
+    if (!deadline.compare_exchange_strong(expected, next,
+                                          std::memory_order_acq_rel))
+    {
+        return false;
+    }
+    if (next != 0)
+    {
+        programmed.store(next, std::memory_order_relaxed);
+    }
+    lastExpiry.store(now, std::memory_order_relaxed);
+    expired.store(true, std::memory_order_release);
+    pending.fetch_add(1, std::memory_order_release);
+    bump(notifyFd.get());
+    return true;
+}
+
+void RtTimer::run()
+{
+    pollfd fds[2] = {{wakeFd.get(), POLLIN, 0}, {timerFd.get(), POLLIN, 0}};
+    while (!stopping.load(std::memory_order_relaxed))
+    {
+        auto when = deadline.load(std::memory_order_acquire);
+        if (when != 0 && when <= monotonicUs())
+        {
+            claim(when, monotonicUs());
+            continue;
+        }
+
+        // Arming with a zero value disarms the timer while disabled
+        itimerspec spec{};
+        spec.it_value.tv_sec = when / 1000000;
+        spec.it_value.tv_nsec = (when % 1000000) * 1000;
+        timerfd_settime(timerFd.get(), TFD_TIMER_ABSTIME, &spec, nullptr);
+
+        if (poll(fds, 2, -1) < 0)
+        {
+            continue;
+        }
+        drain(wakeFd.get());
+        drain(timerFd.get());
+    }
+}
+
+void RtTimer::dispatch()
+{
+    drain(notifyFd.get());
+    if (pending.exchange(0, std::memory_order_acquire) > 0 && callback)
+    {
+        callback();
+    }
+}
+
+} // namespace watchdog
+} // namespace phosphor
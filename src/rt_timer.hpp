@@ -0,0 +1,123 @@
+#pragma once
+
+#include "timer.hpp"
+
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/source/io.hpp>
+#include <stdplus/fd/managed.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+/** @class RtTimer
+ *  @brief Timer whose expiry is detected on a dedicated real-time thread.
+ *  @details The deadline lives in an atomic that the owning thread
+ *  updates without any locking or system call, so kicks stay cheap. A
+ *  thread of its own, optionally running SCHED_FIFO, sleeps on a timerfd
+ *  until the deadline and claims the expiry with a compare and swap, so
+ *  a kick racing with the expiry either lands first or is too late. The
+ *  expiry is then handed to the event loop through an eventfd, where the
+ *  callback runs at TIMER_PRIORITY. A stalled event loop therefore
+ *  delays the action but neither the detection nor hasExpired().
+ *
+ *  Every member other than the constructor and destructor must be
+ *  called from the event loop thread.
+ */
+class RtTimer : public Timer
+{
+  public:
+    RtTimer() = delete;
+    RtTimer(const RtTimer&) = delete;
+    RtTimer& operator=(const RtTimer&) = delete;
+    RtTimer(RtTimer&&) = delete;
+    RtTimer& operator=(RtTimer&&) = delete;
+
+    /** @brief Starts the expiry thread with the timer disabled
+     *
+     *  @param[in] event    - event loop the callback is run from
+     *  @param[in] priority - SCHED_FIFO priority of the expiry thread,
+     *                        0 to leave it with the default policy
+     *
+     *  @throws std::system_error if the descriptors or the thread could
+     *          not be created
+     */
+    RtTimer(const sdeventplus::Event& event, int priority);
+
+    ~RtTimer() override;
+
+    TimePoint now() const override;
+    void setCallback(Callback&& callback) override;
+    bool hasExpired() const override;
+    bool isEnabled() const override;
+    void setEnabled(bool enabled) override;
+    Duration getRemaining() const override;
+    void setRemaining(Duration remaining) override;
+    void restart(Duration interval) override;
+
+    /** @brief Gets the time the expiry thread last detected an expiry */
+    TimePoint expiredAt() const;
+
+  private:
+    /** @brief Function called on expiration */
+    Callback callback;
+
+    /** @brief Wakes the expiry thread when the deadline moves closer */
+    stdplus::ManagedFd wakeFd;
+
+    /** @brief Fires at the deadline, armed by the expiry thread */
+    stdplus::ManagedFd timerFd;
+
+    /** @brief Signals the event loop that an expiry is pending */
+    stdplus::ManagedFd notifyFd;
+
+    /** @brief Watches notifyFd from the event loop */
+    sdeventplus::source::IO source;
+
+    /** @brief Monotonic microseconds of expiry, 0 while disabled */
+    std::atomic<int64_t> deadline{0};
+
+    /** @brief Deadline restored when the timer is enabled again */
+    std::atomic<int64_t> programmed{0};
+
+    /** @brief Period in microseconds to re-arm with, 0 if one shot */
+    std::atomic<int64_t> interval{0};
+
+    /** @brief Has the timer expired since it was last restarted */
+    std::atomic<bool> expired{false};
+
+    /** @brief Monotonic microseconds of the last detected expiry */
+    std::atomic<int64_t> lastExpiry{0};
+
+    /** @brief Expiries detected but not yet handed to the callback */
+    std::atomic<uint32_t> pending{0};
+
+    /** @brief Asks the expiry thread to exit */
+    std::atomic<bool> stopping{false};
+
+    /** @brief The expiry thread */
+    std::thread thread;
+
+    /** @brief Publishes a new deadline, waking the thread if needed */
+    void publish(int64_t value);
+
+    /** @brief Body of the expiry thread */
+    void run();
+
+    /** @brief Claims the expiry of a passed deadline on the thread
+     *
+     *  @return true if claimed, false if the deadline was moved first
+     */
+    bool claim(int64_t expected, int64_t now);
+
+    /** @brief Runs the callback for the expiries handed over */
+    void dispatch();
+};
+
+} // namespace watchdog
+} // namespace phosphor
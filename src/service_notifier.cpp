@@ -0,0 +1,75 @@
+#include "service_notifier.hpp"
+
+#include <systemd/sd-daemon.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+using namespace std::chrono;
+
+std::optional<ServiceNotifier::Duration> ServiceNotifier::pingPeriod()
+{
+    uint64_t usec = 0;
+    if (sd_watchdog_enabled(0, &usec) <= 0 || usec == 0)
+    {
+        return std::nullopt;
+    }
+    return Duration(usec / 2);
+}
+
+ServiceNotifier::ServiceNotifier(const sdeventplus::Event& event,
+                                 std::optional<Duration> period,
+                                 Check&& check) :
+    period(period), check(std::move(check)), clock(event)
+{
+    if (period)
+    {
+        source.emplace(event, clock.now() + *period, milliseconds(1),
+                       [this](auto&, TimePoint scheduled) { ping(scheduled); });
+        source->set_enabled(sdeventplus::source::Enabled::On);
+    }
+}
+
+void ServiceNotifier::ready()
+{
+    int r = sd_notify(0, "READY=1");
+    if (r < 0)
+    {
+        lg2::error("watchdog: failed to notify readiness: {ERROR}", "ERROR",
+                   strerror(-r));
+    }
+}
+
+void ServiceNotifier::ping(TimePoint scheduled)
+{
+    if (check())
+    {
+        sd_notify(0, "WATCHDOG=1");
+        sent++;
+        alive = true;
+    }
+    else
+    {
+        // Only report the first of a run of failures, systemd takes it
+        // from there once WatchdogSec runs out
+        if (alive)
+        {
+            lg2::error("watchdog: liveness check failed, withholding the "
+                       "service watchdog ping");
+        }
+        failed++;
+        alive = false;
+    }
+
+    source->set_time(std::max(scheduled + *period, clock.now()));
+}
+
+} // namespace watchdog
+} // namespace phosphor
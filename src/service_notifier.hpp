@@ -0,0 +1,96 @@
+#pragma once
+
+#include "timer.hpp"
+
+#include <sdeventplus/clock.hpp>
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/source/time.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+/** @class ServiceNotifier
+ *  @brief Reports readiness and liveness of the daemon to systemd.
+ *  @details Pings are sent from a timer on the event loop at the normal
+ *  priority, so they stop when the loop stops turning or is kept busy by
+ *  higher priority work. Every ping is also gated on a liveness check,
+ *  so a loop that turns but no longer services the watchdogs lets the
+ *  service manager's WatchdogSec run out as well.
+ */
+class ServiceNotifier
+{
+  public:
+    using Duration = Timer::Duration;
+    using TimePoint = Timer::TimePoint;
+    using Check = std::function<bool()>;
+
+    ServiceNotifier() = delete;
+    ServiceNotifier(const ServiceNotifier&) = delete;
+    ServiceNotifier& operator=(const ServiceNotifier&) = delete;
+    ServiceNotifier(ServiceNotifier&&) = delete;
+    ServiceNotifier& operator=(ServiceNotifier&&) = delete;
+
+    /** @brief Works out the ping period from WatchdogSec
+     *
+     *  @return half of WatchdogSec, std::nullopt if systemd does not
+     *          expect pings from this process
+     */
+    static std::optional<Duration> pingPeriod();
+
+    /** @brief Starts pinging if a period is given
+     *
+     *  @param[in] event  - event loop the pings are sent from
+     *  @param[in] period - time between pings, std::nullopt for none
+     *  @param[in] check  - liveness check gating every ping
+     */
+    ServiceNotifier(const sdeventplus::Event& event,
+                    std::optional<Duration> period, Check&& check);
+
+    /** @brief Tells systemd that the service is up */
+    void ready();
+
+    /** @brief Number of pings sent */
+    inline uint64_t pings() const
+    {
+        return sent;
+    }
+
+    /** @brief Number of pings withheld by the liveness check */
+    inline uint64_t withheld() const
+    {
+        return failed;
+    }
+
+  private:
+    /** @brief Time between pings */
+    std::optional<Duration> period;
+
+    /** @brief Liveness check gating every ping */
+    Check check;
+
+    /** @brief Clock of the event loop */
+    sdeventplus::Clock<sdeventplus::ClockId::Monotonic> clock;
+
+    /** @brief Ping timer, only when pinging */
+    std::optional<sdeventplus::source::Time<sdeventplus::ClockId::Monotonic>>
+        source;
+
+    /** @brief Ping counters */
+    uint64_t sent = 0;
+    uint64_t failed = 0;
+
+    /** @brief Did the last liveness check pass */
+    bool alive = true;
+
+    /** @brief Sends a ping if alive and schedules the next */
+    void ping(TimePoint scheduled);
+};
+
+} // namespace watchdog
+} // namespace phosphor
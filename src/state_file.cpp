@@ -0,0 +1,106 @@
+#include "state_file.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdio>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+namespace
+{
+
+/** @brief On disk layout of the checkpoint, in native byte order */
+struct StateRecord
+{
+    static constexpr uint32_t MAGIC = 0x54534457; // "WDST" on little endian
+    static constexpr uint32_t VERSION = 1;
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t enabled;
+    uint32_t expireAction;
+    uint32_t currentTimerUse;
+    uint32_t expiredTimerUse;
+    uint64_t interval;
+    uint64_t deadline;
+    uint64_t slack;
+};
+
+static_assert(sizeof(StateRecord) == 48);
+
+} // namespace
+
+StateFile::StateFile(const std::string& path) :
+    path(path), tmpPath(path + ".tmp")
+{}
+
+bool StateFile::save(const SavedState& state) const
+{
+    StateRecord record{};
+    record.magic = StateRecord::MAGIC;
+    record.version = StateRecord::VERSION;
+    record.enabled = state.status.enabled;
+    record.expireAction = static_cast<uint32_t>(state.status.expireAction);
+    record.currentTimerUse =
+        static_cast<uint32_t>(state.status.currentTimerUse);
+    record.expiredTimerUse =
+        static_cast<uint32_t>(state.status.expiredTimerUse);
+    record.interval = state.status.interval;
+    record.deadline = state.status.deadline;
+    record.slack = state.slack;
+
+    int fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                  0644);
+    if (fd < 0)
+    {
+        return false;
+    }
+    bool ok = write(fd, &record, sizeof(record)) == sizeof(record);
+    ok = close(fd) == 0 && ok;
+    if (!ok || rename(tmpPath.c_str(), path.c_str()) != 0)
+    {
+        unlink(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::optional<SavedState> StateFile::load() const
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return std::nullopt;
+    }
+    StateRecord record;
+    auto length = read(fd, &record, sizeof(record));
+    close(fd);
+
+    if (length != sizeof(record) || record.magic != StateRecord::MAGIC ||
+        record.version != StateRecord::VERSION ||
+        record.expireAction > static_cast<uint32_t>(StatusAction::PowerCycle) ||
+        record.currentTimerUse > static_cast<uint32_t>(StatusTimerUse::OEM) ||
+        record.expiredTimerUse > static_cast<uint32_t>(StatusTimerUse::OEM))
+    {
+        return std::nullopt;
+    }
+
+    SavedState state;
+    state.status.enabled = record.enabled != 0;
+    state.status.expireAction = static_cast<StatusAction>(record.expireAction);
+    state.status.currentTimerUse =
+        static_cast<StatusTimerUse>(record.currentTimerUse);
+    state.status.expiredTimerUse =
+        static_cast<StatusTimerUse>(record.expiredTimerUse);
+    state.status.interval = record.interval;
+    state.status.deadline = record.deadline;
+    state.slack = record.slack;
+    return state;
+}
+
+} // namespace watchdog
+} // namespace phosphor
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "status_page.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+/** @brief Watchdog state checkpointed to a StateFile */
+struct SavedState
+{
+    /** @brief Configuration and countdown, in the status page encoding */
+    StatusSnapshot status;
+    /** @brief Microseconds the saved deadline may trail the real one by */
+    uint64_t slack = 0;
+};
+
+/** @class StateFile
+ *  @brief Compact binary checkpoint of a watchdog, kept under /run so
+ *         that a restarted daemon can pick up the countdown.
+ *  @details Every save writes a fixed size record to a temporary file and
+ *  renames it over the previous one, so a crash at any point leaves
+ *  either the old or the new record in place. Deadlines are in
+ *  CLOCK_MONOTONIC, which only holds within a boot; /run does not
+ *  survive a reboot either.
+ */
+class StateFile
+{
+  public:
+    StateFile() = delete;
+
+    /** @brief Sets up the checkpoint at a path, without touching it
+     *
+     *  @param[in] path - file to checkpoint to
+     */
+    explicit StateFile(const std::string& path);
+
+    /** @brief Atomically replaces the checkpoint
+     *
+     *  @param[in] state - state to save
+     *
+     *  @return true if saved, false if the file could not be written
+     */
+    bool save(const SavedState& state) const;
+
+    /** @brief Reads the checkpoint back
+     *
+     *  @return the saved state, std::nullopt if missing or not valid
+     */
+    std::optional<SavedState> load() const;
+
+  private:
+    /** @brief File holding the checkpoint */
+    std::string path;
+
+    /** @brief Temporary file the checkpoint is written to first */
+    std::string tmpPath;
+};
+
+} // namespace watchdog
+} // namespace phosphor
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <optional>
+#include <system_error>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+/** @brief Stable codes of ExpireAction on the status page */
+enum class StatusAction : uint32_t
+{
+    None = 0,
+    HardReset = 1,
+    PowerOff = 2,
+    PowerCycle = 3,
+};
+
+/** @brief Stable codes of the timer uses on the status page */
+enum class StatusTimerUse : uint32_t
+{
+    Reserved = 0,
+    BIOSFRB2 = 1,
+    BIOSPOST = 2,
+    OSLoad = 3,
+    SMSOS = 4,
+    OEM = 5,
+};
+
+/** @brief A consistent copy of the watchdog state */
+struct StatusSnapshot
+{
+    bool enabled = false;
+    StatusAction expireAction = StatusAction::None;
+    StatusTimerUse currentTimerUse = StatusTimerUse::Reserved;
+    StatusTimerUse expiredTimerUse = StatusTimerUse::Reserved;
+    /** @brief Interval in milliseconds */
+    uint64_t interval = 0;
+    /** @brief CLOCK_MONOTONIC microseconds of expiry, 0 if stopped */
+    uint64_t deadline = 0;
+
+    /** @brief Works out the time remaining from the deadline
+     *
+     *  @return milliseconds until expiry, 0 if stopped or expired
+     */
+    uint64_t timeRemaining() const
+    {
+        if (deadline == 0)
+        {
+            return 0;
+        }
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        uint64_t now = ts.tv_sec * 1000000ull + ts.tv_nsec / 1000;
+        return deadline > now ? (deadline - now) / 1000 : 0;
+    }
+};
+
+/** @struct StatusLayout
+ *  @brief Layout of the status page file published by the daemon.
+ *  @details The state is guarded by a sequence counter that is odd while
+ *  the daemon is updating it. Readers copy the state and retry if the
+ *  counter was odd or moved while copying. Every field is a 32 bit
+ *  atomic so the page works the same on 32 bit BMCs.
+ */
+struct StatusLayout
+{
+    static constexpr uint32_t MAGIC = 0x474f4457; // "WDOG" on little endian
+    static constexpr uint32_t VERSION = 1;
+
+    uint32_t magic;
+    uint32_t version;
+    std::atomic<uint32_t> sequence;
+    std::atomic<uint32_t> enabled;
+    std::atomic<uint32_t> expireAction;
+    std::atomic<uint32_t> currentTimerUse;
+    std::atomic<uint32_t> expiredTimerUse;
+    std::atomic<uint32_t> intervalLow;
+    std::atomic<uint32_t> intervalHigh;
+    std::atomic<uint32_t> deadlineLow;
+    std::atomic<uint32_t> deadlineHigh;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+/** @brief Publishes a snapshot, only one writer may call this at a time */
+inline void writeStatus(StatusLayout& page, const StatusSnapshot& status)
+{
+    constexpr auto relaxed = std::memory_order_relaxed;
+    auto sequence = page.sequence.load(relaxed);
+    page.sequence.store(sequence + 1, relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    page.enabled.store(status.enabled, relaxed);
+    page.expireAction.store(static_cast<uint32_t>(status.expireAction),
+                            relaxed);
+    page.currentTimerUse.store(static_cast<uint32_t>(status.currentTimerUse),
+                               relaxed);
+    page.expiredTimerUse.store(static_cast<uint32_t>(status.expiredTimerUse),
+                               relaxed);
+    page.intervalLow.store(static_cast<uint32_t>(status.interval), relaxed);
+    page.intervalHigh.store(static_cast<uint32_t>(status.interval >> 32),
+                            relaxed);
+    page.deadlineLow.store(static_cast<uint32_t>(status.deadline), relaxed);
+    page.deadlineHigh.store(static_cast<uint32_t>(status.deadline >> 32),
+                            relaxed);
+
+    page.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+/** @brief Attempts to copy a consistent snapshot without blocking
+ *
+ *  @return the snapshot, std::nullopt if it was being updated
+ */
+inline std::optional<StatusSnapshot> tryReadStatus(const StatusLayout& page)
+{
+    constexpr auto relaxed = std::memory_order_relaxed;
+    auto sequence = page.sequence.load(std::memory_order_acquire);
+    if (sequence & 1)
+    {
+        return std::nullopt;
+    }
+
+    StatusSnapshot status;
+    status.enabled = page.enabled.load(relaxed) != 0;
+    status.expireAction =
+        static_cast<StatusAction>(page.expireAction.load(relaxed));
+    status.currentTimerUse =
+        static_cast<StatusTimerUse>(page.currentTimerUse.load(relaxed));
+    status.expiredTimerUse =
+        static_cast<StatusTimerUse>(page.expiredTimerUse.load(relaxed));
+    status.interval = page.intervalLow.load(relaxed) |
+                      uint64_t{page.intervalHigh.load(relaxed)} << 32;
+    status.deadline = page.deadlineLow.load(relaxed) |
+                      uint64_t{page.deadlineHigh.load(relaxed)} << 32;
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (page.sequence.load(relaxed) != sequence)
+    {
+        return std::nullopt;
+    }
+    return status;
+}
+
+/** @class StatusReader
+ *  @brief Maps a status page read only for lock and syscall free reads.
+ *  @details Only depends on libc so that health agents can include it
+ *  without pulling in the rest of the daemon.
+ */
+class StatusReader
+{
+  public:
+    StatusReader() = delete;
+    StatusReader(const StatusReader&) = delete;
+    StatusReader& operator=(const StatusReader&) = delete;
+    StatusReader(StatusReader&&) = delete;
+    StatusReader& operator=(StatusReader&&) = delete;
+
+    /** @brief Maps the page
+     *
+     *  @param[in] path - status page published by the daemon
+     *
+     *  @throws std::system_error if the page is missing or not valid
+     */
+    explicit StatusReader(const char* path)
+    {
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            throw std::system_error(errno, std::generic_category(), path);
+        }
+        struct stat st;
+        void* map = MAP_FAILED;
+        if (fstat(fd, &st) == 0 &&
+            static_cast<size_t>(st.st_size) >= sizeof(StatusLayout))
+        {
+            map = mmap(nullptr, sizeof(StatusLayout), PROT_READ, MAP_SHARED,
+                       fd, 0);
+        }
+        close(fd);
+        if (map == MAP_FAILED)
+        {
+            throw std::system_error(EINVAL, std::generic_category(), path);
+        }
+
+        page = static_cast<const StatusLayout*>(map);
+        if (page->magic != StatusLayout::MAGIC ||
+            page->version != StatusLayout::VERSION)
+        {
+            munmap(map, sizeof(StatusLayout));
+            throw std::system_error(EPROTO, std::generic_category(), path);
+        }
+    }
+
+    ~StatusReader()
+    {
+        munmap(const_cast<StatusLayout*>(page), sizeof(StatusLayout));
+    }
+
+    /** @brief Copies a consistent snapshot of the state
+     *
+     *  @param[in] attempts - times to retry while an update is under way
+     *
+     *  @return the snapshot, std::nullopt if no consistent copy was made
+     */
+    std::optional<StatusSnapshot> read(unsigned attempts = 1000) const
+    {
+        for (unsigned i = 0; i < attempts; ++i)
+        {
+            if (auto status = tryReadStatus(*page))
+            {
+                return status;
+            }
+        }
+        return std::nullopt;
+    }
+
+  private:
+    /** @brief The mapped page */
+    const StatusLayout* page = nullptr;
+};
+
+} // namespace watchdog
+} // namespace phosphor
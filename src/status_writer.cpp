@@ -0,0 +1,150 @@
+#include "status_writer.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <new>
+#include <system_error>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+namespace
+{
+
+StatusAction toStatus(Watchdog::Action action)
+{
+    switch (action)
+    {
+        case Watchdog::Action::None:
+            return StatusAction::None;
+        case Watchdog::Action::HardReset:
+            return StatusAction::HardReset;
+        case Watchdog::Action::PowerOff:
+            return StatusAction::PowerOff;
+        case Watchdog::Action::PowerCycle:
+            return StatusAction::PowerCycle;
+    }
+    return StatusAction::None;
+}
+
+StatusTimerUse toStatus(Watchdog::TimerUse timerUse)
+{
+    switch (timerUse)
+    {
+        case Watchdog::TimerUse::Reserved:
+            return StatusTimerUse::Reserved;
+        case Watchdog::TimerUse::BIOSFRB2:
+            return StatusTimerUse::BIOSFRB2;
+        case Watchdog::TimerUse::BIOSPOST:
+            return StatusTimerUse::BIOSPOST;
+        case Watchdog::TimerUse::OSLoad:
+            return StatusTimerUse::OSLoad;
+        case Watchdog::TimerUse::SMSOS:
+            return StatusTimerUse::SMSOS;
+        case Watchdog::TimerUse::OEM:
+            return StatusTimerUse::OEM;
+    }
+    return StatusTimerUse::Reserved;
+}
+
+} // namespace
+
+StatusSnapshot statusOf(const Watchdog& wdog)
+{
+    StatusSnapshot status;
+    status.enabled = wdog.enabled();
+    status.expireAction = toStatus(wdog.expireAction());
+    status.currentTimerUse = toStatus(wdog.currentTimerUse());
+    status.expiredTimerUse = toStatus(wdog.expiredTimerUse());
+    status.interval = wdog.interval();
+    status.deadline = wdog.deadline();
+    return status;
+}
+
+Watchdog::Action actionOf(StatusAction action)
+{
+    switch (action)
+    {
+        case StatusAction::None:
+            return Watchdog::Action::None;
+        case StatusAction::HardReset:
+            return Watchdog::Action::HardReset;
+        case StatusAction::PowerOff:
+            return Watchdog::Action::PowerOff;
+        case StatusAction::PowerCycle:
+            return Watchdog::Action::PowerCycle;
+    }
+    return Watchdog::Action::None;
+}
+
+Watchdog::TimerUse timerUseOf(StatusTimerUse timerUse)
+{
+    switch (timerUse)
+    {
+        case StatusTimerUse::Reserved:
+            return Watchdog::TimerUse::Reserved;
+        case StatusTimerUse::BIOSFRB2:
+            return Watchdog::TimerUse::BIOSFRB2;
+        case StatusTimerUse::BIOSPOST:
+            return Watchdog::TimerUse::BIOSPOST;
+        case StatusTimerUse::OSLoad:
+            return Watchdog::TimerUse::OSLoad;
+        case StatusTimerUse::SMSOS:
+            return Watchdog::TimerUse::SMSOS;
+        case StatusTimerUse::OEM:
+            return Watchdog::TimerUse::OEM;
+    }
+    return Watchdog::TimerUse::Reserved;
+}
+
+StatusWriter::StatusWriter(const std::string& path) : path(path)
+{
+    std::string tmpPath = path + ".tmp";
+    int fd = open(tmpPath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+                  0644);
+    if (fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), tmpPath);
+    }
+
+    void* map = MAP_FAILED;
+    if (ftruncate(fd, sizeof(StatusLayout)) == 0)
+    {
+        map = mmap(nullptr, sizeof(StatusLayout), PROT_READ | PROT_WRITE,
+                   MAP_SHARED, fd, 0);
+    }
+    int error = errno;
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        unlink(tmpPath.c_str());
+        throw std::system_error(error, std::generic_category(), tmpPath);
+    }
+
+    page = new (map) StatusLayout{};
+    page->magic = StatusLayout::MAGIC;
+    page->version = StatusLayout::VERSION;
+    writeStatus(*page, StatusSnapshot{});
+
+    if (rename(tmpPath.c_str(), path.c_str()) < 0)
+    {
+        error = errno;
+        munmap(page, sizeof(StatusLayout));
+        unlink(tmpPath.c_str());
+        throw std::system_error(error, std::generic_category(), path);
+    }
+}
+
+StatusWriter::~StatusWriter()
+{
+    munmap(page, sizeof(StatusLayout));
+    unlink(path.c_str());
+}
+
+} // namespace watchdog
+} // namespace phosphor
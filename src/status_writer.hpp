@@ -0,0 +1,62 @@
+#pragma once
+
+#include "status_page.hpp"
+#include "watchdog.hpp"
+
+#include <string>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+/** @brief Captures the state of a watchdog for the status page */
+StatusSnapshot statusOf(const Watchdog& wdog);
+
+/** @brief Decodes an ExpireAction from its status page code */
+Watchdog::Action actionOf(StatusAction action);
+
+/** @brief Decodes a timer use from its status page code */
+Watchdog::TimerUse timerUseOf(StatusTimerUse timerUse);
+
+/** @class StatusWriter
+ *  @brief Publishes watchdog state to a memory mapped status page.
+ *  @details The page is fully set up under a temporary name and renamed
+ *  into place so that readers never map a partially initialized page.
+ */
+class StatusWriter
+{
+  public:
+    StatusWriter() = delete;
+    StatusWriter(const StatusWriter&) = delete;
+    StatusWriter& operator=(const StatusWriter&) = delete;
+    StatusWriter(StatusWriter&&) = delete;
+    StatusWriter& operator=(StatusWriter&&) = delete;
+
+    /** @brief Creates the page
+     *
+     *  @param[in] path - where to publish the page, typically under /run
+     *
+     *  @throws std::system_error if the page could not be created
+     */
+    explicit StatusWriter(const std::string& path);
+
+    /** @brief Unmaps and removes the page */
+    ~StatusWriter();
+
+    /** @brief Publishes a new snapshot */
+    inline void update(const StatusSnapshot& status)
+    {
+        writeStatus(*page, status);
+    }
+
+  private:
+    /** @brief Path of the page */
+    std::string path;
+
+    /** @brief The mapped page */
+    StatusLayout* page = nullptr;
+};
+
+} // namespace watchdog
+} // namespace phosphor
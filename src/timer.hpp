@@ -0,0 +1,174 @@
+#pragma once
+
+#include <systemd/sd-event.h>
+
+#include <sdeventplus/clock.hpp>
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/source/time.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <utility>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+/** @brief sd-event priority of the sources driving watchdog timers
+ *  @details sd-event dispatches a single source per loop iteration,
+ *  picking the pending one with the best priority. Running the timers
+ *  ahead of bus processing, which is attached at the normal priority,
+ *  keeps an expiry from queueing behind a burst of D-Bus messages.
+ */
+constexpr int64_t TIMER_PRIORITY = SD_EVENT_PRIORITY_IMPORTANT;
+
+/** @class Timer
+ *  @brief Countdown driving a Watchdog.
+ *  @details Mirrors the subset of sdeventplus::utility::Timer used by the
+ *  watchdog so that the backing scheduler can be swapped out. Once
+ *  restarted the timer is periodic, it re-arms itself with the interval
+ *  before the callback is invoked on every expiration.
+ */
+class Timer
+{
+  public:
+    using Duration = std::chrono::microseconds;
+    using TimePoint =
+        sdeventplus::Clock<sdeventplus::ClockId::Monotonic>::time_point;
+    using Callback = std::function<void()>;
+
+    virtual ~Timer() = default;
+
+    /** @brief Gets the current time on the clock driving the timer */
+    virtual TimePoint now() const = 0;
+
+    /** @brief Sets the function called every time the timer expires */
+    virtual void setCallback(Callback&& callback) = 0;
+
+    /** @brief Has the timer expired since it was last restarted */
+    virtual bool hasExpired() const = 0;
+
+    /** @brief Is the timer currently counting down */
+    virtual bool isEnabled() const = 0;
+
+    /** @brief Enables or disables the countdown without changing it */
+    virtual void setEnabled(bool enabled) = 0;
+
+    /** @brief Gets the time left before the timer expires */
+    virtual Duration getRemaining() const = 0;
+
+    /** @brief Sets the time left before the timer expires */
+    virtual void setRemaining(Duration remaining) = 0;
+
+    /** @brief Clears the expired state and starts counting down from
+     *         a new interval.
+     */
+    virtual void restart(Duration interval) = 0;
+};
+
+/** @class EventTimer
+ *  @brief Timer backed by its own sd-event monotonic time source.
+ *  @details Follows the sdeventplus::utility::Timer semantics, but owns
+ *  the time source so that it can be given TIMER_PRIORITY.
+ */
+class EventTimer : public Timer
+{
+  public:
+    explicit EventTimer(const sdeventplus::Event& event) :
+        clock(event), source(event, TimePoint(), std::chrono::milliseconds(1),
+                             [this](auto&, TimePoint) { expire(); })
+    {
+        source.set_enabled(sdeventplus::source::Enabled::Off);
+        source.set_priority(TIMER_PRIORITY);
+    }
+
+    TimePoint now() const override
+    {
+        return clock.now();
+    }
+
+    void setCallback(Callback&& callback) override
+    {
+        this->callback = std::move(callback);
+    }
+
+    bool hasExpired() const override
+    {
+        return expired;
+    }
+
+    bool isEnabled() const override
+    {
+        return source.get_enabled() != sdeventplus::source::Enabled::Off;
+    }
+
+    void setEnabled(bool enabled) override
+    {
+        source.set_enabled(enabled ? sdeventplus::source::Enabled::On
+                                   : sdeventplus::source::Enabled::Off);
+    }
+
+    Duration getRemaining() const override
+    {
+        auto now = clock.now();
+        auto deadline = source.get_time();
+        if (deadline <= now)
+        {
+            return Duration(0);
+        }
+        return std::chrono::duration_cast<Duration>(deadline - now);
+    }
+
+    void setRemaining(Duration remaining) override
+    {
+        source.set_time(clock.now() + remaining);
+    }
+
+    void restart(Duration interval) override
+    {
+        expired = false;
+        this->interval = interval;
+        setRemaining(interval);
+        setEnabled(true);
+    }
+
+  private:
+    /** @brief Function called on expiration */
+    Callback callback;
+
+    /** @brief Clock of the event loop */
+    sdeventplus::Clock<sdeventplus::ClockId::Monotonic> clock;
+
+    /** @brief Underlying sd-event time source */
+    sdeventplus::source::Time<sdeventplus::ClockId::Monotonic> source;
+
+    /** @brief Period used to re-arm after an expiration */
+    std::optional<Duration> interval;
+
+    /** @brief Has the timer expired since it was last restarted */
+    bool expired = false;
+
+    /** @brief Re-arms or stops the timer and runs the callback */
+    void expire()
+    {
+        expired = true;
+        if (interval)
+        {
+            setRemaining(*interval);
+        }
+        else
+        {
+            setEnabled(false);
+        }
+        if (callback)
+        {
+            callback();
+        }
+    }
+};
+
+} // namespace watchdog
+} // namespace phosphor
@@ -0,0 +1,183 @@
+#include "timer_mux.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+TimerMux::TimerMux(std::unique_ptr<Timer>&& timer) : timer(std::move(timer))
+{
+    this->timer->setCallback(std::bind(&TimerMux::dispatch, this));
+}
+
+std::unique_ptr<Timer> TimerMux::makeTimer()
+{
+    return std::make_unique<MuxedTimer>(*this);
+}
+
+MuxedTimer* TimerMux::earliest() const
+{
+    MuxedTimer* next = nullptr;
+    for (auto* t : timers)
+    {
+        if (t->enabled && (next == nullptr || t->deadline < next->deadline))
+        {
+            next = t;
+        }
+    }
+    return next;
+}
+
+void TimerMux::rearm()
+{
+    // Whatever expires the due countdowns rearms once they are done
+    if (dispatching)
+    {
+        return;
+    }
+
+    auto* next = earliest();
+    if (next == nullptr)
+    {
+        // The underlying timer is periodic, so it also runs on after a
+        // dispatch left nothing to wait for
+        if (armed || timer->isEnabled())
+        {
+            timer->setEnabled(false);
+            armed.reset();
+            armedFor = nullptr;
+        }
+        return;
+    }
+    if (armed == next->deadline)
+    {
+        // Due at the same time, so whatever fired covers it as well
+        armedFor = next;
+        return;
+    }
+
+    // Restarting clears the expired state, see firedFor()
+    auto now = timer->now();
+    timer->restart(next->deadline > now
+                       ? std::chrono::duration_cast<Timer::Duration>(
+                             next->deadline - now)
+                       : Timer::Duration(0));
+    armed = next->deadline;
+    armedFor = next;
+}
+
+bool TimerMux::firedFor(const MuxedTimer* t) const
+{
+    return armedFor == t && timer->hasExpired();
+}
+
+void TimerMux::dispatch()
+{
+    armed.reset();
+    armedFor = nullptr;
+    dispatching = true;
+
+    // Bounded so that a countdown re-arming with no interval cannot spin
+    auto now = timer->now();
+    for (size_t i = 0; i < timers.size(); ++i)
+    {
+        auto* next = earliest();
+        if (next == nullptr || next->deadline > now)
+        {
+            break;
+        }
+        next->expire(now);
+    }
+
+    dispatching = false;
+    rearm();
+}
+
+MuxedTimer::MuxedTimer(TimerMux& mux) : mux(mux)
+{
+    mux.timers.push_back(this);
+}
+
+MuxedTimer::~MuxedTimer()
+{
+    std::erase(mux.timers, this);
+    mux.rearm();
+}
+
+Timer::TimePoint MuxedTimer::now() const
+{
+    return mux.now();
+}
+
+void MuxedTimer::setCallback(Callback&& callback)
+{
+    this->callback = std::move(callback);
+}
+
+bool MuxedTimer::hasExpired() const
+{
+    return expired || mux.firedFor(this);
+}
+
+bool MuxedTimer::isEnabled() const
+{
+    // A one shot countdown stops as soon as it goes off
+    return enabled && (interval || !mux.firedFor(this));
+}
+
+void MuxedTimer::setEnabled(bool enabled)
+{
+    this->enabled = enabled;
+    mux.rearm();
+}
+
+Timer::Duration MuxedTimer::getRemaining() const
+{
+    auto now = mux.now();
+    if (deadline <= now)
+    {
+        return Duration(0);
+    }
+    return std::chrono::duration_cast<Duration>(deadline - now);
+}
+
+void MuxedTimer::setRemaining(Duration remaining)
+{
+    deadline = mux.now() + remaining;
+    if (enabled)
+    {
+        mux.rearm();
+    }
+}
+
+void MuxedTimer::restart(Duration interval)
+{
+    expired = false;
+    this->interval = interval;
+    deadline = mux.now() + interval;
+    setEnabled(true);
+}
+
+void MuxedTimer::expire(TimePoint now)
+{
+    expired = true;
+    if (interval)
+    {
+        deadline = now + *interval;
+    }
+    else
+    {
+        enabled = false;
+    }
+    if (callback)
+    {
+        callback();
+    }
+}
+
+} // namespace watchdog
+} // namespace phosphor
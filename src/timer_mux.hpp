@@ -0,0 +1,152 @@
+#pragma once
+
+#include "timer.hpp"
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+class MuxedTimer;
+
+/** @class TimerMux
+ *  @brief Runs several countdowns off of a single Timer.
+ *  @details The underlying timer is only ever programmed for the
+ *  earliest deadline of the enabled countdowns, so however many of them
+ *  are running the event loop sees a single time source. A watchdog
+ *  carries at most one countdown per timer use, so the earliest is
+ *  found with a scan of a handful of entries rather than a heap.
+ *
+ *  The countdown the underlying timer is programmed for reports its
+ *  expiry as soon as the underlying timer does, so a timer detecting
+ *  expiries off of the event loop keeps doing so through the mux.
+ */
+class TimerMux
+{
+  public:
+    using TimePoint = Timer::TimePoint;
+
+    TimerMux() = delete;
+    ~TimerMux() = default;
+    TimerMux(const TimerMux&) = delete;
+    TimerMux& operator=(const TimerMux&) = delete;
+    TimerMux(TimerMux&&) = delete;
+    TimerMux& operator=(TimerMux&&) = delete;
+
+    /** @brief Takes over the timer
+     *
+     *  @param[in] timer - timer driving every countdown
+     */
+    explicit TimerMux(std::unique_ptr<Timer>&& timer);
+
+    /** @brief Creates a disabled countdown driven by the mux, which must
+     *         outlive it.
+     */
+    std::unique_ptr<Timer> makeTimer();
+
+    /** @brief Gets the current time on the underlying timer clock */
+    inline TimePoint now() const
+    {
+        return timer->now();
+    }
+
+    /** @brief Time the underlying timer is programmed for, if any */
+    inline std::optional<TimePoint> armedAt() const
+    {
+        return armed;
+    }
+
+  private:
+    friend class MuxedTimer;
+
+    /** @brief Underlying timer */
+    std::unique_ptr<Timer> timer;
+
+    /** @brief Every live countdown */
+    std::vector<MuxedTimer*> timers;
+
+    /** @brief Time the underlying timer is programmed for, if any */
+    std::optional<TimePoint> armed;
+
+    /** @brief Countdown the underlying timer is programmed for, if any */
+    const MuxedTimer* armedFor = nullptr;
+
+    /** @brief Are due countdowns being expired */
+    bool dispatching = false;
+
+    /** @brief Finds the enabled countdown due first, if any */
+    MuxedTimer* earliest() const;
+
+    /** @brief Points the underlying timer at the earliest deadline */
+    void rearm();
+
+    /** @brief Has the underlying timer gone off for the countdown but
+     *         not been dispatched yet.
+     */
+    bool firedFor(const MuxedTimer* t) const;
+
+    /** @brief Expires every countdown that has come due */
+    void dispatch();
+};
+
+/** @class MuxedTimer
+ *  @brief Countdown scheduled by a TimerMux.
+ *  @details Follows the sdeventplus::utility::Timer semantics like every
+ *  other Timer.
+ */
+class MuxedTimer : public Timer
+{
+  public:
+    MuxedTimer() = delete;
+    MuxedTimer(const MuxedTimer&) = delete;
+    MuxedTimer& operator=(const MuxedTimer&) = delete;
+    MuxedTimer(MuxedTimer&&) = delete;
+    MuxedTimer& operator=(MuxedTimer&&) = delete;
+
+    /** @brief Constructs a disabled countdown
+     *
+     *  @param[in] mux - mux scheduling this countdown, must outlive it
+     */
+    explicit MuxedTimer(TimerMux& mux);
+    ~MuxedTimer() override;
+
+    TimePoint now() const override;
+    void setCallback(Callback&& callback) override;
+    bool hasExpired() const override;
+    bool isEnabled() const override;
+    void setEnabled(bool enabled) override;
+    Duration getRemaining() const override;
+    void setRemaining(Duration remaining) override;
+    void restart(Duration interval) override;
+
+  private:
+    friend class TimerMux;
+
+    /** @brief Mux scheduling this countdown */
+    TimerMux& mux;
+
+    /** @brief Function called on expiration */
+    Callback callback;
+
+    /** @brief Period used to re-arm after an expiration */
+    std::optional<Duration> interval;
+
+    /** @brief Time at which the countdown expires */
+    TimePoint deadline;
+
+    /** @brief Is the countdown running */
+    bool enabled = false;
+
+    /** @brief Has the countdown expired since the last restart */
+    bool expired = false;
+
+    /** @brief Re-arms or stops the countdown and runs the callback */
+    void expire(TimePoint now);
+};
+
+} // namespace watchdog
+} // namespace phosphor
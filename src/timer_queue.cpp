@@ -0,0 +1,245 @@
+#include "timer_queue.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+namespace
+{
+
+/** @brief Orders the heap so the earliest entry is on top */
+constexpr auto laterEntry = [](const auto& a, const auto& b) {
+    return a.when > b.when;
+};
+
+} // namespace
+
+TimerQueue::TimerQueue(const sdeventplus::Event& event) :
+    clock(event),
+    source(event, TimePoint(), std::chrono::milliseconds(1),
+           [this](auto&, TimePoint) { dispatch(); })
+{
+    source.set_enabled(sdeventplus::source::Enabled::Off);
+    source.set_priority(TIMER_PRIORITY);
+}
+
+void TimerQueue::push(QueuedTimer& timer, TimePoint when)
+{
+    heap.push_back({when, &timer, timer.generation});
+    std::push_heap(heap.begin(), heap.end(), laterEntry);
+
+    // Only an entry earlier than what we are armed for needs a reprogram
+    if (!armedAt || when < *armedAt)
+    {
+        rearm();
+    }
+}
+
+void TimerQueue::remove(const QueuedTimer& timer)
+{
+    std::erase_if(heap, [&](const Entry& e) {
+        if (e.timer != &timer)
+        {
+            return false;
+        }
+        if (e.generation != timer.generation)
+        {
+            stale--;
+        }
+        return true;
+    });
+    std::make_heap(heap.begin(), heap.end(), laterEntry);
+    rearm();
+}
+
+void TimerQueue::discard()
+{
+    // Toggling a timer queues a new entry every time, so without this the
+    // heap would only shrink as the stale entries come due
+    if (++stale * 2 <= heap.size())
+    {
+        return;
+    }
+    std::erase_if(heap, [](const Entry& e) {
+        return e.generation != e.timer->generation;
+    });
+    std::make_heap(heap.begin(), heap.end(), laterEntry);
+    stale = 0;
+    rearm();
+}
+
+void TimerQueue::dispatch()
+{
+    armedAt.reset();
+    dispatching = true;
+
+    auto now = clock.now();
+    while (!heap.empty() && heap.front().when <= now)
+    {
+        std::pop_heap(heap.begin(), heap.end(), laterEntry);
+        Entry entry = heap.back();
+        heap.pop_back();
+
+        // The timer has been kicked, disabled or re-queued since this
+        // entry was pushed
+        if (entry.generation != entry.timer->generation)
+        {
+            stale--;
+            continue;
+        }
+
+        entry.timer->service(now);
+    }
+
+    dispatching = false;
+    rearm();
+}
+
+void TimerQueue::rearm()
+{
+    // Periodic timers re-queue as they are serviced, the source is only
+    // programmed once for all of them when the dispatch is done
+    if (dispatching)
+    {
+        return;
+    }
+
+    if (heap.empty())
+    {
+        source.set_enabled(sdeventplus::source::Enabled::Off);
+        armedAt.reset();
+        return;
+    }
+
+    auto when = heap.front().when;
+    if (armedAt != when)
+    {
+        source.set_time(when);
+        source.set_enabled(sdeventplus::source::Enabled::OneShot);
+        armedAt = when;
+    }
+}
+
+QueuedTimer::~QueuedTimer()
+{
+    // Stale entries also point back at us so they all need to go
+    queue.remove(*this);
+}
+
+Timer::TimePoint QueuedTimer::now() const
+{
+    return queue.now();
+}
+
+void QueuedTimer::setCallback(Callback&& callback)
+{
+    this->callback = std::move(callback);
+}
+
+bool QueuedTimer::hasExpired() const
+{
+    return expired;
+}
+
+bool QueuedTimer::isEnabled() const
+{
+    return enabled;
+}
+
+void QueuedTimer::setEnabled(bool enabled)
+{
+    this->enabled = enabled;
+    if (enabled)
+    {
+        schedule();
+    }
+    else
+    {
+        unschedule();
+    }
+}
+
+Timer::Duration QueuedTimer::getRemaining() const
+{
+    auto now = queue.now();
+    if (deadline <= now)
+    {
+        return Duration(0);
+    }
+    return std::chrono::duration_cast<Duration>(deadline - now);
+}
+
+void QueuedTimer::setRemaining(Duration remaining)
+{
+    deadline = queue.now() + remaining;
+    if (enabled)
+    {
+        schedule();
+    }
+}
+
+void QueuedTimer::restart(Duration interval)
+{
+    expired = false;
+    this->interval = interval;
+    setRemaining(interval);
+    setEnabled(true);
+}
+
+void QueuedTimer::schedule()
+{
+    // An entry due before the deadline will re-queue itself once serviced
+    if (queuedAt && *queuedAt <= deadline)
+    {
+        return;
+    }
+
+    unschedule();
+    queuedAt = deadline;
+    queue.push(*this, deadline);
+}
+
+void QueuedTimer::unschedule()
+{
+    if (queuedAt)
+    {
+        generation++;
+        queuedAt.reset();
+        queue.discard();
+    }
+}
+
+void QueuedTimer::service(TimePoint now)
+{
+    queuedAt.reset();
+
+    // We were kicked after being queued, wait for the new deadline
+    if (deadline > now)
+    {
+        schedule();
+        return;
+    }
+
+    expired = true;
+    if (interval)
+    {
+        deadline = now + *interval;
+        schedule();
+    }
+    else
+    {
+        enabled = false;
+    }
+
+    if (callback)
+    {
+        callback();
+    }
+}
+
+} // namespace watchdog
+} // namespace phosphor
@@ -0,0 +1,179 @@
+#pragma once
+
+#include "timer.hpp"
+
+#include <sdeventplus/clock.hpp>
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/source/time.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+class QueuedTimer;
+
+/** @class TimerQueue
+ *  @brief Drives any number of QueuedTimers from a single sd-event
+ *         time source.
+ *  @details Timers are kept in a min-heap keyed by the time they were
+ *  queued to fire. Pushing a deadline further out, which is what every
+ *  watchdog kick does, only updates the timer and leaves its queue entry
+ *  in place. The entry is re-queued at the new deadline when it comes
+ *  due, so kicks never touch the heap or reprogram the time source.
+ *  Disabling a timer or pulling its deadline in leaves its entry stale
+ *  instead, and the heap is compacted once stale entries outnumber the
+ *  live ones.
+ */
+class TimerQueue
+{
+  public:
+    using Clock = sdeventplus::Clock<sdeventplus::ClockId::Monotonic>;
+    using TimePoint = Clock::time_point;
+
+    TimerQueue() = delete;
+    ~TimerQueue() = default;
+    TimerQueue(const TimerQueue&) = delete;
+    TimerQueue& operator=(const TimerQueue&) = delete;
+    TimerQueue(TimerQueue&&) = delete;
+    TimerQueue& operator=(TimerQueue&&) = delete;
+
+    /** @brief Constructs the queue
+     *
+     *  @param[in] event - event loop the time source is attached to
+     */
+    explicit TimerQueue(const sdeventplus::Event& event);
+
+    /** @brief Gets the current time on the queue clock */
+    TimePoint now() const
+    {
+        return clock.now();
+    }
+
+    /** @brief Number of entries in the queue, including stale ones */
+    size_t size() const
+    {
+        return heap.size();
+    }
+
+  private:
+    friend class QueuedTimer;
+
+    /** @brief A point in time at which a timer needs attention */
+    struct Entry
+    {
+        TimePoint when;
+        QueuedTimer* timer;
+        uint64_t generation;
+    };
+
+    /** @brief Clock of the event loop */
+    Clock clock;
+
+    /** @brief The single time source shared by every timer */
+    sdeventplus::source::Time<sdeventplus::ClockId::Monotonic> source;
+
+    /** @brief Min-heap of entries ordered by when */
+    std::vector<Entry> heap;
+
+    /** @brief Time the source is currently armed for, if any */
+    std::optional<TimePoint> armedAt;
+
+    /** @brief Number of entries in the heap no timer is waiting on */
+    size_t stale = 0;
+
+    /** @brief Are due entries being serviced */
+    bool dispatching = false;
+
+    /** @brief Queues an entry for the timer */
+    void push(QueuedTimer& timer, TimePoint when);
+
+    /** @brief Drops all of the entries belonging to the timer */
+    void remove(const QueuedTimer& timer);
+
+    /** @brief Accounts for an entry a timer stopped waiting on,
+     *         compacting the heap if too many have piled up
+     */
+    void discard();
+
+    /** @brief Services every entry that has come due */
+    void dispatch();
+
+    /** @brief Points the time source at the earliest entry */
+    void rearm();
+};
+
+/** @class QueuedTimer
+ *  @brief Timer scheduled by a shared TimerQueue.
+ */
+class QueuedTimer : public Timer
+{
+  public:
+    using TimePoint = TimerQueue::TimePoint;
+
+    QueuedTimer() = delete;
+    QueuedTimer(const QueuedTimer&) = delete;
+    QueuedTimer& operator=(const QueuedTimer&) = delete;
+    QueuedTimer(QueuedTimer&&) = delete;
+    QueuedTimer& operator=(QueuedTimer&&) = delete;
+
+    /** @brief Constructs a disabled timer
+     *
+     *  @param[in] queue - queue scheduling this timer, must outlive it
+     */
+    explicit QueuedTimer(TimerQueue& queue) : queue(queue) {}
+    ~QueuedTimer() override;
+
+    TimePoint now() const override;
+    void setCallback(Callback&& callback) override;
+    bool hasExpired() const override;
+    bool isEnabled() const override;
+    void setEnabled(bool enabled) override;
+    Duration getRemaining() const override;
+    void setRemaining(Duration remaining) override;
+    void restart(Duration interval) override;
+
+  private:
+    friend class TimerQueue;
+
+    /** @brief Queue scheduling this timer */
+    TimerQueue& queue;
+
+    /** @brief Function called on expiration */
+    Callback callback;
+
+    /** @brief Period used to re-arm after an expiration */
+    std::optional<Duration> interval;
+
+    /** @brief Time at which the timer expires */
+    TimePoint deadline;
+
+    /** @brief Is the countdown running */
+    bool enabled = false;
+
+    /** @brief Has the timer expired since the last restart */
+    bool expired = false;
+
+    /** @brief Incremented to invalidate any entry already queued */
+    uint64_t generation = 0;
+
+    /** @brief When our live queue entry comes due, if there is one */
+    std::optional<TimePoint> queuedAt;
+
+    /** @brief Makes sure an entry is queued no later than the deadline */
+    void schedule();
+
+    /** @brief Stops waiting on the queued entry, if there is one */
+    void unschedule();
+
+    /** @brief Called by the queue when our live entry comes due */
+    void service(TimePoint now);
+};
+
+} // namespace watchdog
+} // namespace phosphor
@@ -0,0 +1,102 @@
+#include "timer_uses.hpp"
+
+#include <chrono>
+#include <functional>
+#include <utility>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+TimerUses::TimerUses(std::unique_ptr<Timer>&& timer, Expired&& expired) :
+    timerMux(std::move(timer)), expired(std::move(expired))
+{
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        entries[i].timer = timerMux.makeTimer();
+        entries[i].timer->setCallback(
+            std::bind(&TimerUses::expire, this, static_cast<TimerUse>(i)));
+    }
+}
+
+void TimerUses::start(TimerUse timerUse, uint64_t interval, Action action,
+                      Timer::Duration remaining)
+{
+    auto& countdown = entry(timerUse);
+    countdown.interval = interval;
+    countdown.action = action;
+    countdown.timer->restart(remaining);
+}
+
+bool TimerUses::reset(TimerUse timerUse)
+{
+    auto& countdown = entry(timerUse);
+    if (!countdown.timer->isEnabled())
+    {
+        return false;
+    }
+    countdown.timer->setRemaining(milliseconds(countdown.interval));
+    return true;
+}
+
+void TimerUses::stop(TimerUse timerUse)
+{
+    entry(timerUse).timer->setEnabled(false);
+}
+
+TimerUses::Countdown TimerUses::take(TimerUse timerUse)
+{
+    auto& countdown = entry(timerUse);
+    Countdown taken{countdown.interval, countdown.action,
+                    countdown.timer->getRemaining()};
+    countdown.timer->setEnabled(false);
+    return taken;
+}
+
+bool TimerUses::running(TimerUse timerUse) const
+{
+    return entry(timerUse).timer->isEnabled();
+}
+
+uint64_t TimerUses::deadline(TimerUse timerUse) const
+{
+    const auto& countdown = entry(timerUse);
+    if (!countdown.timer->isEnabled())
+    {
+        return 0;
+    }
+    auto deadline = countdown.timer->now() + countdown.timer->getRemaining();
+    return duration_cast<microseconds>(deadline.time_since_epoch()).count();
+}
+
+uint64_t TimerUses::earliest() const
+{
+    uint64_t first = 0;
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        auto when = deadline(static_cast<TimerUse>(i));
+        if (when != 0 && (first == 0 || when < first))
+        {
+            first = when;
+        }
+    }
+    return first;
+}
+
+void TimerUses::expire(TimerUse timerUse)
+{
+    auto& countdown = entry(timerUse);
+    countdown.timer->setEnabled(false);
+    if (expired)
+    {
+        expired(timerUse, countdown.interval, countdown.action);
+    }
+}
+
+} // namespace watchdog
+} // namespace phosphor
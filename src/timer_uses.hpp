@@ -0,0 +1,167 @@
+#pragma once
+
+#include "timer.hpp"
+#include "timer_mux.hpp"
+
+#include <xyz/openbmc_project/State/Watchdog/server.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+/** @class TimerUses
+ *  @brief Countdowns of the timer uses besides the current one.
+ *  @details Owns the TimerMux every countdown of a watchdog runs off of,
+ *  so the countdown of the current timer use, kept by the watchdog in
+ *  the standard properties, and the countdowns kept here share a single
+ *  time source. Each timer use counts down with its own interval and
+ *  action, at most one countdown per timer use.
+ */
+class TimerUses
+{
+  public:
+    using TimerUse =
+        sdbusplus::xyz::openbmc_project::State::server::Watchdog::TimerUse;
+    using Action =
+        sdbusplus::xyz::openbmc_project::State::server::Watchdog::Action;
+
+    /** @brief Called with the timer use, interval and action of a
+     *         countdown that ran out.
+     */
+    using Expired = std::function<void(TimerUse, uint64_t, Action)>;
+
+    /** @brief Number of timer uses */
+    static constexpr size_t COUNT = static_cast<size_t>(TimerUse::OEM) + 1;
+
+    /** @brief What a countdown was started with and how far it got */
+    struct Countdown
+    {
+        /** @brief Milliseconds counted down from */
+        uint64_t interval = 0;
+        /** @brief Action taken when it runs out */
+        Action action = Action::None;
+        /** @brief Time left */
+        Timer::Duration remaining{0};
+    };
+
+    TimerUses() = delete;
+    ~TimerUses() = default;
+    TimerUses(const TimerUses&) = delete;
+    TimerUses& operator=(const TimerUses&) = delete;
+    TimerUses(TimerUses&&) = delete;
+    TimerUses& operator=(TimerUses&&) = delete;
+
+    /** @brief Takes over the timer driving every countdown
+     *
+     *  @param[in] timer   - timer handed to the mux
+     *  @param[in] expired - function called when a countdown runs out,
+     *                       after it is stopped
+     */
+    TimerUses(std::unique_ptr<Timer>&& timer, Expired&& expired);
+
+    /** @brief Creates a disabled countdown outside of the timer uses,
+     *         driven by the same mux, which must outlive it.
+     */
+    inline std::unique_ptr<Timer> makeTimer()
+    {
+        return timerMux.makeTimer();
+    }
+
+    /** @brief Gets the mux driving every countdown */
+    inline const TimerMux& mux() const
+    {
+        return timerMux;
+    }
+
+    /** @brief (Re)starts the countdown of a timer use
+     *
+     *  @param[in] timerUse  - timer use to count down for
+     *  @param[in] interval  - milliseconds a kick counts down from
+     *  @param[in] action    - action taken when it runs out
+     *  @param[in] remaining - time left until it runs out
+     */
+    void start(TimerUse timerUse, uint64_t interval, Action action,
+               Timer::Duration remaining);
+
+    /** @brief Restarts the countdown of a timer use from its interval
+     *
+     *  @param[in] timerUse - timer use to kick
+     *
+     *  @return true if it was counting down
+     */
+    bool reset(TimerUse timerUse);
+
+    /** @brief Stops the countdown of a timer use
+     *
+     *  @param[in] timerUse - timer use to stop
+     */
+    void stop(TimerUse timerUse);
+
+    /** @brief Stops the countdown of a timer use, handing back where it
+     *         was so it can be carried on elsewhere.
+     *
+     *  @param[in] timerUse - timer use to take, must be counting down
+     */
+    Countdown take(TimerUse timerUse);
+
+    /** @brief Tells if a timer use is counting down */
+    bool running(TimerUse timerUse) const;
+
+    /** @brief Gets the time the countdown of a timer use runs out
+     *
+     *  @param[in] timerUse - timer use to look up
+     *
+     *  @return CLOCK_MONOTONIC microseconds, 0 if it is not counting down
+     */
+    uint64_t deadline(TimerUse timerUse) const;
+
+    /** @brief Gets the time the first of the countdowns runs out
+     *
+     *  @return CLOCK_MONOTONIC microseconds, 0 if none is counting down
+     */
+    uint64_t earliest() const;
+
+  private:
+    /** @brief Countdown of a timer use */
+    struct Entry
+    {
+        /** @brief Counts down while the timer use is running */
+        std::unique_ptr<Timer> timer;
+        /** @brief Milliseconds counted down from */
+        uint64_t interval = 0;
+        /** @brief Action taken when it runs out */
+        Action action = Action::None;
+    };
+
+    /** @brief Drives every countdown from the contained timer */
+    TimerMux timerMux;
+
+    /** @brief Countdowns indexed by the TimerUse */
+    std::array<Entry, COUNT> entries;
+
+    /** @brief Function called when a countdown runs out */
+    Expired expired;
+
+    /** @brief Handles the countdown of a timer use running out */
+    void expire(TimerUse timerUse);
+
+    /** @brief Gets the countdown of a timer use */
+    inline Entry& entry(TimerUse timerUse)
+    {
+        return entries[static_cast<size_t>(timerUse)];
+    }
+    inline const Entry& entry(TimerUse timerUse) const
+    {
+        return entries[static_cast<size_t>(timerUse)];
+    }
+};
+
+} // namespace watchdog
+} // namespace phosphor
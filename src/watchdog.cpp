@@ -1,13 +1,26 @@
 #include "watchdog.hpp"
 
+#include "journal.hpp"
+#include "probes.hpp"
+#include "status_writer.hpp"
+
+#include <syslog.h>
+
 #include <phosphor-logging/elog.hpp>
-#include <phosphor-logging/log.hpp>
+#include <phosphor-logging/lg2.hpp>
 #include <sdbusplus/exception.hpp>
 #include <xyz/openbmc_project/Common/error.hpp>
 
 #include <algorithm>
+#include <array>
 #include <chrono>
+#include <cinttypes>
+#include <cstring>
+#include <string>
 #include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
 
 namespace phosphor
 {
@@ -24,6 +37,29 @@ constexpr auto SYSTEMD_SERVICE = "org.freedesktop.systemd1";
 constexpr auto SYSTEMD_ROOT = "/org/freedesktop/systemd1";
 constexpr auto SYSTEMD_INTERFACE = "org.freedesktop.systemd1.Manager";
 
+// Bounds on starting the timeout action so the event loop never waits
+// on systemd.
+constexpr auto START_UNIT_TIMEOUT = 2s;
+constexpr auto START_UNIT_RETRIES = 3u;
+constexpr auto START_UNIT_BACKOFF = 100ms;
+
+// Shortest time between two Deadline signals, so kicks or a client
+// toggling the timer cannot turn it into a signal storm.
+constexpr auto DEADLINE_SIGNAL_GAP = 100ms;
+
+namespace
+{
+
+/** @brief Logs the timer being armed at an interval */
+void logTimerState(const char* message, uint64_t interval)
+{
+    JournalEntry(LOG_INFO, "%s, interval %" PRIu64, message, interval)
+        .add("INTERVAL", interval)
+        .send();
+}
+
+} // namespace
+
 void Watchdog::resetTimeRemaining(bool enableWatchdog)
 {
     timeRemaining(interval());
@@ -33,6 +69,242 @@ void Watchdog::resetTimeRemaining(bool enableWatchdog)
     }
 }
 
+void Watchdog::kick()
+{
+    if (kickCoalesceWindow == Timer::Duration(0) || !timerEnabled())
+    {
+        resetTimeRemaining(false);
+        return;
+    }
+
+    auto now = timer->now();
+    if (lastKick && now - *lastKick < kickCoalesceWindow)
+    {
+        // Remember the kick and apply it if the timer goes off, its margin
+        // is only known then. The deadline is published right away so
+        // readers never see a countdown the kick is going to extend.
+        counters.kicks.add();
+        pendingKick = now;
+        auto value = this->enabled() ? interval() : fallback->interval;
+        updateDeadline(now + milliseconds(value));
+        return;
+    }
+
+    lastKick = now;
+    resetTimeRemaining(false);
+}
+
+void Watchdog::setKickCoalesceWindow(milliseconds window)
+{
+    kickCoalesceWindow = window;
+}
+
+void Watchdog::setLogWindow(Timer::Duration window)
+{
+    logs.setLimit(window);
+    scheduleLogFlush();
+}
+
+bool Watchdog::admitLog(LogEvent event, uint64_t detail)
+{
+    if (logs.admit(event, timer->now(), detail))
+    {
+        return true;
+    }
+    scheduleLogFlush();
+    return false;
+}
+
+void Watchdog::scheduleLogFlush()
+{
+    auto next = logs.nextFlush();
+    if (!next)
+    {
+        logFlush->setEnabled(false);
+        return;
+    }
+    auto now = timer->now();
+    logFlush->restart(*next > now ? duration_cast<Timer::Duration>(*next - now)
+                                  : Timer::Duration(0));
+}
+
+void Watchdog::flushLogs()
+{
+    logs.flush(timer->now());
+    scheduleLogFlush();
+}
+
+void Watchdog::setHistorySize(size_t size)
+{
+    eventHistory.resize(size);
+}
+
+void Watchdog::setHistoryFile(const std::string& path)
+{
+    eventHistory.setDumpFile(path);
+}
+
+void Watchdog::setExecutor(Action action, std::unique_ptr<Executor>&& executor)
+{
+    if (executor)
+    {
+        executor->setCallback(std::bind(&Watchdog::executed, this, action,
+                                        std::placeholders::_1));
+    }
+    actionPlans[static_cast<size_t>(action)].executor = std::move(executor);
+}
+
+void Watchdog::setStateFile(const std::string& path, Timer::Duration slack)
+{
+    stateFile.reset();
+    stateRefresh.reset();
+    if (path.empty())
+    {
+        return;
+    }
+
+    // Restore before the first save replaces the checkpoint
+    StateFile file(path);
+    if (auto state = file.load())
+    {
+        restoreState(*state);
+    }
+
+    stateSlack = slack;
+    stateRefresh.emplace(event, std::bind(&Watchdog::saveState, this));
+    stateFile.emplace(std::move(file));
+    saveState();
+}
+
+void Watchdog::saveState()
+{
+    stateRefresh->setEnabled(false);
+    SavedState state{statusOf(*this),
+                     static_cast<uint64_t>(stateSlack.count())};
+    if (!stateFile->save(state))
+    {
+        lg2::error("watchdog: failed to checkpoint the state");
+    }
+}
+
+void Watchdog::stateChanged(bool config)
+{
+    if (!stateFile)
+    {
+        return;
+    }
+    if (config && !holdSignals)
+    {
+        saveState();
+    }
+    else if (!stateRefresh->isEnabled())
+    {
+        stateRefresh->restartOnce(stateSlack);
+    }
+}
+
+void Watchdog::restoreState(const SavedState& state)
+{
+    const auto& status = state.status;
+    auto action = actionOf(status.expireAction);
+    auto timerUse = timerUseOf(status.currentTimerUse);
+    setProperty(&Base::Watchdog::expiredTimerUse, expiredTimerUse(),
+                timerUseOf(status.expiredTimerUse));
+
+    // Kicks that were not saved may have moved the deadline out by up to
+    // the slack, so only a countdown overdue past that has really expired
+    uint64_t remaining = 0;
+    if (status.deadline != 0)
+    {
+        auto now = duration_cast<microseconds>(
+                       timer->now().time_since_epoch())
+                       .count();
+        auto deadline = status.deadline + state.slack;
+        if (deadline > static_cast<uint64_t>(now))
+        {
+            remaining = (deadline - now) / 1000;
+        }
+    }
+
+    if (status.enabled && status.deadline != 0)
+    {
+        // An overdue countdown is cut down to the minimum interval
+        configure(status.interval, action, timerUse, true,
+                  std::max<uint64_t>(remaining, 1));
+    }
+    else
+    {
+        configure(status.interval, action, timerUse, false, 0);
+        if (fallback && status.deadline != 0)
+        {
+            timer->restart(milliseconds(fallback->interval));
+            timer->setRemaining(milliseconds(remaining));
+            updateDeadline(timer->now() + milliseconds(remaining));
+        }
+    }
+
+    lg2::info("watchdog: resumed from checkpoint, enabled {ENABLED}, "
+              "remaining {REMAINING}",
+              "ENABLED", status.enabled, "REMAINING", remaining);
+}
+
+void Watchdog::setDeferSignals(bool defer)
+{
+    if (defer == deferSignals)
+    {
+        return;
+    }
+
+    if (defer)
+    {
+        published = snapshot();
+        flushSource.emplace(event, [this](auto&) { flushSignals(); });
+        flushSource->set_enabled(sdeventplus::source::Enabled::Off);
+    }
+    else
+    {
+        flushSignals();
+        flushSource.reset();
+    }
+    deferSignals = defer;
+}
+
+template <typename T>
+T Watchdog::setProperty(T (Base::Watchdog::*set)(T, bool), T current, T value)
+{
+    if (current == value)
+    {
+        return (this->*set)(value, true);
+    }
+
+    stats.mutations++;
+    if (deferSignals)
+    {
+        flushSource->set_enabled(sdeventplus::source::Enabled::OneShot);
+    }
+    else if (!holdSignals)
+    {
+        stats.signals++;
+    }
+    emitting = !holdSignals && !deferSignals;
+    auto result = (this->*set)(value, holdSignals || deferSignals);
+    emitting = false;
+    if (stateCallback)
+    {
+        stateCallback();
+    }
+
+    // Setting TimeRemaining is a kick, anything else is configuration
+    bool config = true;
+    if constexpr (std::is_same_v<T, uint64_t>)
+    {
+        config = set != static_cast<decltype(set)>(
+                            &Base::Watchdog::timeRemaining);
+    }
+    stateChanged(config);
+    return result;
+}
+
 // Enable or disable watchdog
 bool Watchdog::enabled(bool value)
 {
@@ -40,7 +312,7 @@ bool Watchdog::enabled(bool value)
     {
         // Make sure we accurately reflect our enabled state to the
         // tryFallbackOrDisable() call
-        WatchdogInherits::enabled(value);
+        setProperty(&Base::Watchdog::enabled, this->enabled(), value);
 
         // Attempt to fallback or disable our timer if needed
         tryFallbackOrDisable();
@@ -50,25 +322,75 @@ bool Watchdog::enabled(bool value)
     else if (!this->enabled())
     {
         auto interval_ms = this->interval();
-        timer.restart(milliseconds(interval_ms));
-        log<level::INFO>("watchdog: enabled and started",
-                         entry("INTERVAL=%llu", interval_ms));
+        pendingKick.reset();
+        timer->restart(milliseconds(interval_ms));
+        updateDeadline(timer->now() + milliseconds(interval_ms));
+        // arg3: deadline in CLOCK_MONOTONIC microseconds
+        WATCHDOG_PROBE(arm, interval_ms, interval_ms, expireAction(),
+                       deadlineUs);
+        eventHistory.record(timer->now(), HistoryEvent::Enabled,
+                            interval_ms);
+        if (admitLog(LogEvent::Enabled, interval_ms))
+        {
+            logTimerState("watchdog: enabled and started", interval_ms);
+        }
     }
 
-    return WatchdogInherits::enabled(value);
+    return setProperty(&Base::Watchdog::enabled, this->enabled(), value);
+}
+
+bool Watchdog::healthy(Timer::Duration grace) const
+{
+    auto now = static_cast<uint64_t>(
+        duration_cast<microseconds>(timer->now().time_since_epoch()).count());
+    auto overdue = [&](uint64_t deadline) {
+        return deadline != 0 &&
+               now > deadline + static_cast<uint64_t>(grace.count());
+    };
+
+    // The other timer uses are dispatched by the same mux
+    if (overdue(timerUses.earliest()))
+    {
+        return false;
+    }
+    if (!timer->isEnabled())
+    {
+        return !this->enabled() || actionPending();
+    }
+    return !overdue(deadlineUs);
 }
 
 // Get the remaining time before timer expires.
 // If the timer is disabled, returns 0
 uint64_t Watchdog::timeRemaining() const
+{
+    // Only count clients, not the value read back to fill in a signal
+    if (!emitting)
+    {
+        poll.timeRemainingReads++;
+    }
+    return remainingMs();
+}
+
+uint64_t Watchdog::remainingMs() const
 {
     // timer may have already expired and disabled
     if (!timerEnabled())
     {
         return 0;
     }
+    return duration_cast<milliseconds>(timer->getRemaining()).count();
+}
 
-    return duration_cast<milliseconds>(timer.getRemaining()).count();
+void Watchdog::recordKick(Timer::TimePoint when, uint64_t remaining)
+{
+    eventHistory.record(when, HistoryEvent::Kick, remaining);
+    auto countdown = this->enabled() ? interval() : fallback->interval;
+    if (countdown != 0)
+    {
+        counters.kickMargin.record(
+            std::min<uint64_t>(remaining * 100 / countdown, 100));
+    }
 }
 
 // Reset the timer to a new expiration value
@@ -93,105 +415,963 @@ uint64_t Watchdog::timeRemaining(uint64_t value)
     }
 
     // Update new expiration
-    timer.setRemaining(milliseconds(value));
+    auto remaining = remainingMs();
+    counters.kicks.add();
+    recordKick(timer->now(), remaining);
+    pendingKick.reset();
+    timer->setRemaining(milliseconds(value));
+    updateDeadline(timer->now() + milliseconds(value));
+    // arg1: time that was left when kicked
+    // arg3: deadline in CLOCK_MONOTONIC microseconds
+    WATCHDOG_PROBE(kick, this->enabled() ? interval() : fallback->interval,
+                   remaining,
+                   this->enabled() ? expireAction() : fallback->action,
+                   deadlineUs);
 
     // Update Base class data.
-    return WatchdogInherits::timeRemaining(value);
+    return setProperty(&Base::Watchdog::timeRemaining,
+                       WatchdogInherits::timeRemaining(), value);
 }
 
 // Set value of Interval
 uint64_t Watchdog::interval(uint64_t value)
 {
-    return WatchdogInherits::interval(std::max(value, minInterval));
+    value = std::max(value, minInterval);
+    if (value != interval())
+    {
+        eventHistory.record(timer->now(), HistoryEvent::Interval, value);
+    }
+    return setProperty(&Base::Watchdog::interval, interval(), value);
+}
+
+// Set value of ExpireAction
+Watchdog::Action Watchdog::expireAction(Action value)
+{
+    return setProperty(&Base::Watchdog::expireAction, expireAction(), value);
+}
+
+// Set value of CurrentTimerUse
+Watchdog::TimerUse Watchdog::currentTimerUse(TimerUse value)
+{
+    if (value != currentTimerUse() && timerUses.running(value))
+    {
+        switchTimerUse(value);
+        return currentTimerUse();
+    }
+    return setProperty(&Base::Watchdog::currentTimerUse, currentTimerUse(),
+                       value);
 }
 
 // Optional callback function on timer expiration
 void Watchdog::timeOutHandler()
 {
+    // Apply a kick absorbed by the coalescing window before timing out
+    if (pendingKick)
+    {
+        auto value = this->enabled() ? interval() : fallback->interval;
+        auto kickedAt = *pendingKick;
+        auto deadline = kickedAt + milliseconds(value);
+        auto now = timer->now();
+        pendingKick.reset();
+        if (deadline > now)
+        {
+            // The kick came in with the rest of the old countdown left
+            recordKick(kickedAt,
+                       duration_cast<milliseconds>(now - kickedAt).count());
+            // Restarting clears the expiry the kick came in time to prevent
+            timer->restart(milliseconds(value));
+            timer->setRemaining(deadline - now);
+            updateDeadline(deadline);
+            return;
+        }
+    }
+
+    // arg3: deadline that was due in CLOCK_MONOTONIC microseconds
+    WATCHDOG_PROBE(expire, interval(), remainingMs(),
+                   this->enabled() ? expireAction() : fallback->action,
+                   deadlineUs);
+
     Action action = expireAction();
     if (!this->enabled())
     {
         action = fallback->action;
     }
+    takeAction(action, currentTimerUse());
 
-    expiredTimerUse(currentTimerUse());
+    tryFallbackOrDisable();
 
-    auto target = actionTargetMap.find(action);
-    if (target == actionTargetMap.end())
+    // Leave a record of what led up to the timeout
+    if (!eventHistory.dump())
     {
-        log<level::INFO>("watchdog: Timed out with no target",
-                         entry("ACTION=%s", convertForMessage(action).c_str()),
-                         entry("TIMER_USE=%s",
-                               convertForMessage(expiredTimerUse()).c_str()));
+        lg2::error("watchdog: failed to dump the history");
     }
-    else
+}
+
+void Watchdog::timerUseExpired(TimerUse timerUse, uint64_t interval,
+                               Action action)
+{
+    // arg3: CLOCK_MONOTONIC microseconds the countdown ran out at
+    WATCHDOG_PROBE(expire, interval, 0, action,
+                   duration_cast<microseconds>(
+                       timer->now().time_since_epoch())
+                       .count());
+    timerUsesChanged();
+
+    takeAction(action, timerUse);
+
+    if (!eventHistory.dump())
     {
-        log<level::INFO>(
-            "watchdog: Timed out",
-            entry("ACTION=%s", convertForMessage(action).c_str()),
-            entry("TIMER_USE=%s", convertForMessage(expiredTimerUse()).c_str()),
-            entry("TARGET=%s", target->second.c_str()));
+        lg2::error("watchdog: failed to dump the history");
+    }
+}
 
-        try
+void Watchdog::takeAction(Action action, TimerUse expiredUse)
+{
+    lastTimeout = timer->now();
+    counters.expirations.add();
+    eventHistory.record(timer->now(), HistoryEvent::Timeout,
+                        static_cast<uint64_t>(action));
+
+    setProperty(&Base::Watchdog::expiredTimerUse, expiredTimerUse(),
+                expiredUse);
+
+    const auto& plan = actionPlans[static_cast<size_t>(action)];
+    const auto& timerUse =
+        timerUseNames[static_cast<size_t>(expiredTimerUse())];
+
+    // Only a different action or timer use is worth logging every time
+    auto detail = static_cast<uint64_t>(action) << 8 |
+                  static_cast<uint64_t>(expiredTimerUse());
+    if (admitLog(LogEvent::TimedOut, detail))
+    {
+        if (plan.executor)
+        {
+            JournalEntry(LOG_INFO,
+                         "watchdog: Timed out, action %s, timer use %s, "
+                         "executor %s",
+                         plan.name.c_str(), timerUse.c_str(),
+                         plan.executor->description().c_str())
+                .add("ACTION", plan.name)
+                .add("TIMER_USE", timerUse)
+                .add("EXECUTOR", plan.executor->description())
+                .send();
+        }
+        else if (!plan.target)
         {
-            auto method = bus.new_method_call(SYSTEMD_SERVICE, SYSTEMD_ROOT,
-                                              SYSTEMD_INTERFACE, "StartUnit");
-            method.append(target->second);
-            method.append("replace");
+            JournalEntry(LOG_INFO,
+                         "watchdog: Timed out with no target, action %s, "
+                         "timer use %s",
+                         plan.name.c_str(), timerUse.c_str())
+                .add("ACTION", plan.name)
+                .add("TIMER_USE", timerUse)
+                .send();
+        }
+        else
+        {
+            JournalEntry(LOG_INFO,
+                         "watchdog: Timed out, action %s, timer use %s, "
+                         "target %s",
+                         plan.name.c_str(), timerUse.c_str(),
+                         plan.target->c_str())
+                .add("ACTION", plan.name)
+                .add("TIMER_USE", timerUse)
+                .add("TARGET", *plan.target)
+                .send();
+        }
+    }
 
-            bus.call_noreply(method);
+    // The executor skips the systemd job queue, the target only backs it
+    // up when it fails, which may only be known once it has replied
+    bool executing = false;
+    if (plan.executor)
+    {
+        int r = plan.executor->execute();
+        if (r < 0)
+        {
+            lg2::error("watchdog: failed to {EXECUTOR}: {ERROR}", "EXECUTOR",
+                       plan.executor->description(), "ERROR", strerror(-r));
         }
-        catch (const sdbusplus::exception_t& e)
+        if (r < 0 || !plan.executor->pending())
         {
-            log<level::ERR>("watchdog: Failed to start unit",
-                            entry("TARGET=%s", target->second.c_str()),
-                            entry("ERROR=%s", e.what()));
-            commit<InternalFailure>();
+            // arg3: 0 or the negative errno the executor failed with
+            WATCHDOG_PROBE(execute, interval(), remainingMs(), action, r);
         }
+        executing = r >= 0;
     }
-    try
+
+    if (plan.target && !executing)
     {
-        auto signal = bus.new_signal(objPath.data(),
-                                     "xyz.openbmc_project.Watchdog", "Timeout");
-        signal.append(convertForMessage(action).c_str());
-        signal.signal_send();
+        startTarget(action);
     }
-    catch (const sdbusplus::exception_t& e)
+
+    int r = sd_bus_emit_signal(bus.get(), objPath.data(), CONTROL_INTERFACE,
+                               "Timeout", "s", plan.name.c_str());
+    // arg3: 0 or the negative errno of sending the signal
+    WATCHDOG_PROBE(timeout_signal, interval(), remainingMs(), action, r);
+    if (r < 0)
     {
-        log<level::ERR>("watchdog: failed to send timeout signal",
-                        entry("ERROR=%s", e.what()));
+        lg2::error("watchdog: failed to send timeout signal: {ERROR}",
+                   "ERROR", strerror(-r));
     }
 
-    if (exitAfterTimeout)
+    // Otherwise we exit once the unit start has completed
+    if (exitAfterTimeout && !actionPending())
     {
-        timer.get_event().exit(0);
+        event.exit(0);
     }
+}
 
-    tryFallbackOrDisable();
+void Watchdog::executed(Action action, int result)
+{
+    // arg3: 0 or the negative errno the executor failed with
+    WATCHDOG_PROBE(execute, interval(), remainingMs(), action, result);
+    const auto& plan = actionPlans[static_cast<size_t>(action)];
+    if (result < 0 && plan.target)
+    {
+        startTarget(action);
+        return;
+    }
+
+    if (exitAfterTimeout && !actionPending())
+    {
+        event.exit(0);
+    }
+}
+
+void Watchdog::startTarget(Action action)
+{
+    // Supersede any start still in flight from an earlier timeout
+    startUnitRetry.setEnabled(false);
+    startUnitTarget = &*actionPlans[static_cast<size_t>(action)].target;
+    startUnitAction = action;
+    startUnitExpiry = lastTimeout;
+    startUnitAttempt = 0;
+    dispatchStartUnit();
+}
+
+bool Watchdog::actionPending() const
+{
+    if (startUnitTarget != nullptr)
+    {
+        return true;
+    }
+    return std::ranges::any_of(actionPlans, [](const auto& plan) {
+        return plan.executor && plan.executor->pending();
+    });
+}
+
+void Watchdog::startTimerUse(TimerUse timerUse, uint64_t interval,
+                             Action action)
+{
+    interval = std::max(interval, minInterval);
+    if (timerUse == currentTimerUse())
+    {
+        configure(interval, action, timerUse, true, interval);
+        return;
+    }
+
+    timerUses.start(timerUse, interval, action, milliseconds(interval));
+    // arg3: deadline in CLOCK_MONOTONIC microseconds
+    WATCHDOG_PROBE(arm, interval, interval, action,
+                   timerUseDeadline(timerUse));
+    eventHistory.record(timer->now(), HistoryEvent::Enabled, interval);
+    timerUsesChanged();
+}
+
+void Watchdog::resetTimerUse(TimerUse timerUse)
+{
+    if (timerUse == currentTimerUse())
+    {
+        resetTimeRemaining(false);
+        return;
+    }
+
+    if (timerUses.reset(timerUse))
+    {
+        counters.kicks.add();
+        timerUsesChanged();
+    }
+}
+
+void Watchdog::stopTimerUse(TimerUse timerUse)
+{
+    if (timerUse == currentTimerUse())
+    {
+        enabled(false);
+        return;
+    }
+
+    if (timerUses.running(timerUse))
+    {
+        timerUses.stop(timerUse);
+        timerUsesChanged();
+    }
+}
+
+uint64_t Watchdog::timerUseDeadline(TimerUse timerUse) const
+{
+    if (timerUse == currentTimerUse())
+    {
+        return deadlineUs;
+    }
+
+    return timerUses.deadline(timerUse);
+}
+
+uint64_t Watchdog::earliestDeadline() const
+{
+    auto other = timerUses.earliest();
+    if (deadlineUs == 0 || (other != 0 && other < deadlineUs))
+    {
+        return other;
+    }
+    return deadlineUs;
+}
+
+void Watchdog::timerUsesChanged()
+{
+    if (stateCallback)
+    {
+        stateCallback();
+    }
+}
+
+void Watchdog::switchTimerUse(TimerUse timerUse)
+{
+    auto next = timerUses.take(timerUse);
+    auto remaining = duration_cast<milliseconds>(next.remaining).count();
+
+    // The countdown being replaced carries on where it was
+    if (this->enabled() && timerEnabled())
+    {
+        timerUses.start(currentTimerUse(), interval(), expireAction(),
+                        timer->getRemaining());
+    }
+
+    configure(next.interval, next.action, timerUse, true,
+              std::max<uint64_t>(remaining, 1));
+}
+
+void Watchdog::dispatchStartUnit()
+{
+    sd_bus_message* method = nullptr;
+    sd_bus_slot* slot = nullptr;
+    int r = sd_bus_message_new_method_call(bus.get(), &method,
+                                           SYSTEMD_SERVICE, SYSTEMD_ROOT,
+                                           SYSTEMD_INTERFACE, "StartUnit");
+    if (r >= 0)
+    {
+        r = sd_bus_message_append(method, "ss", startUnitTarget->c_str(),
+                                  "replace");
+    }
+    if (r >= 0)
+    {
+        r = sd_bus_call_async(
+            bus.get(), &slot, method, &Watchdog::startUnitDone, this,
+            duration_cast<microseconds>(START_UNIT_TIMEOUT).count());
+    }
+    sd_bus_message_unref(method);
+
+    if (r < 0)
+    {
+        startUnitCall.reset();
+        startUnitFailed(strerror(-r));
+        return;
+    }
+    startUnitCall.reset(slot);
+}
+
+int Watchdog::startUnitDone(sd_bus_message* reply, void* context,
+                            sd_bus_error*)
+{
+    auto wdog = static_cast<Watchdog*>(context);
+    // arg3: 0 or the negative errno StartUnit failed with
+    WATCHDOG_PROBE(start_unit, wdog->interval(), wdog->remainingMs(),
+                   wdog->startUnitAction,
+                   -sd_bus_message_get_errno(reply));
+    if (const auto* error = sd_bus_message_get_error(reply))
+    {
+        wdog->startUnitFailed(error->message);
+        return 0;
+    }
+
+    wdog->recordStartUnit(true);
+    wdog->startUnitFinished();
+    return 0;
+}
+
+void Watchdog::startUnitFailed(const char* error)
+{
+    if (startUnitAttempt < START_UNIT_RETRIES)
+    {
+        auto backoff = START_UNIT_BACKOFF * (1 << startUnitAttempt++);
+        if (admitLog(LogEvent::StartUnitRetry, startUnitAttempt))
+        {
+            JournalEntry(LOG_WARNING, "watchdog: Retrying start unit %s: %s",
+                         startUnitTarget->c_str(), error)
+                .add("TARGET", *startUnitTarget)
+                .add("ERROR", error)
+                .add("ATTEMPT", startUnitAttempt)
+                .send();
+        }
+        startUnitRetry.restartOnce(backoff);
+        return;
+    }
+
+    lg2::error("watchdog: Failed to start unit {TARGET}: {ERROR}", "TARGET",
+               *startUnitTarget, "ERROR", error);
+    commit<InternalFailure>();
+    recordStartUnit(false);
+    startUnitFinished();
+}
+
+void Watchdog::recordStartUnit(bool success)
+{
+    (success ? counters.startUnitSuccesses : counters.startUnitFailures).add();
+    counters.startUnitLatency.record(
+        duration_cast<milliseconds>(timer->now() - startUnitExpiry).count());
+}
+
+void Watchdog::startUnitFinished()
+{
+    startUnitTarget = nullptr;
+
+    // An executor of another timeout may still be carrying out its action
+    if (exitAfterTimeout && !actionPending())
+    {
+        event.exit(0);
+    }
+}
+
+Watchdog::ActionPlans Watchdog::makeActionPlans(const ActionTargetMap& targets)
+{
+    ActionPlans plans;
+    for (size_t i = 0; i < plans.size(); ++i)
+    {
+        auto action = static_cast<Action>(i);
+        plans[i].name = convertForMessage(action);
+        auto target = targets.find(action);
+        if (target != targets.end())
+        {
+            plans[i].target = target->second;
+        }
+    }
+    return plans;
+}
+
+Watchdog::TimerUseNames Watchdog::makeTimerUseNames()
+{
+    TimerUseNames names;
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        names[i] = convertForMessage(static_cast<TimerUse>(i));
+    }
+    return names;
 }
 
 void Watchdog::tryFallbackOrDisable()
 {
+    pendingKick.reset();
+
     // We only re-arm the watchdog if we were already enabled and have
     // a possible fallback
     if (fallback && (fallback->always || this->enabled()))
     {
         auto interval_ms = fallback->interval;
-        timer.restart(milliseconds(interval_ms));
-        log<level::INFO>("watchdog: falling back",
-                         entry("INTERVAL=%llu", interval_ms));
+        counters.fallbackEntries.add();
+        timer->restart(milliseconds(interval_ms));
+        updateDeadline(timer->now() + milliseconds(interval_ms));
+        // arg3: deadline in CLOCK_MONOTONIC microseconds
+        WATCHDOG_PROBE(arm, interval_ms, interval_ms, fallback->action,
+                       deadlineUs);
+        eventHistory.record(timer->now(), HistoryEvent::Fallback,
+                            interval_ms);
+        if (admitLog(LogEvent::FallingBack, interval_ms))
+        {
+            logTimerState("watchdog: falling back", interval_ms);
+        }
     }
     else if (timerEnabled())
     {
-        timer.setEnabled(false);
+        timer->setEnabled(false);
+        updateDeadline(std::nullopt);
+        eventHistory.record(timer->now(), HistoryEvent::Disabled);
 
-        log<level::INFO>("watchdog: disabled");
+        if (admitLog(LogEvent::Disabled))
+        {
+            JournalEntry(LOG_INFO, "watchdog: disabled").send();
+        }
     }
 
     // Make sure we accurately reflect our enabled state to the
     // dbus interface.
-    WatchdogInherits::enabled(false);
+    setProperty(&Base::Watchdog::enabled, this->enabled(), false);
+}
+
+void Watchdog::configure(uint64_t interval, Action action, TimerUse timerUse,
+                         bool enable, uint64_t remaining)
+{
+    auto before = snapshot();
+    holdSignals = true;
+
+    this->interval(interval);
+    expireAction(action);
+    // Everything is given, so a countdown of the timer use is superseded
+    timerUses.stop(timerUse);
+    currentTimerUse(timerUse);
+
+    if (!enable)
+    {
+        enabled(false);
+    }
+    else if (!this->enabled())
+    {
+        // Arm straight at the requested countdown rather than arming at
+        // the interval and then adjusting it
+        auto value = remaining ? std::max(remaining, minInterval)
+                               : this->interval();
+        pendingKick.reset();
+        timer->restart(milliseconds(value));
+        updateDeadline(timer->now() + milliseconds(value));
+        // arg3: deadline in CLOCK_MONOTONIC microseconds
+        WATCHDOG_PROBE(arm, this->interval(), value, action, deadlineUs);
+        eventHistory.record(timer->now(), HistoryEvent::Enabled, value);
+        setProperty(&Base::Watchdog::enabled, false, true);
+        setProperty(&Base::Watchdog::timeRemaining,
+                    WatchdogInherits::timeRemaining(), value);
+        if (admitLog(LogEvent::Enabled, value))
+        {
+            logTimerState("watchdog: enabled and started", value);
+        }
+    }
+    else if (remaining)
+    {
+        timeRemaining(remaining);
+    }
+
+    holdSignals = false;
+    stateChanged(true);
+    if (!deferSignals)
+    {
+        emitChanged(before);
+        emitDeadline();
+    }
+}
+
+Watchdog::PropertySnapshot Watchdog::snapshot() const
+{
+    return {WatchdogInherits::enabled(), expireAction(), currentTimerUse(),
+            expiredTimerUse(), interval(), WatchdogInherits::timeRemaining()};
+}
+
+void Watchdog::emitChanged(const PropertySnapshot& before)
+{
+    auto after = snapshot();
+    std::array<const char*, 7> names{};
+    size_t count = 0;
+    if (before.enabled != after.enabled)
+    {
+        names[count++] = "Enabled";
+    }
+    if (before.expireAction != after.expireAction)
+    {
+        names[count++] = "ExpireAction";
+    }
+    if (before.currentTimerUse != after.currentTimerUse)
+    {
+        names[count++] = "CurrentTimerUse";
+    }
+    if (before.expiredTimerUse != after.expiredTimerUse)
+    {
+        names[count++] = "ExpiredTimerUse";
+    }
+    if (before.interval != after.interval)
+    {
+        names[count++] = "Interval";
+    }
+    if (before.timeRemaining != after.timeRemaining)
+    {
+        names[count++] = "TimeRemaining";
+    }
+    if (count == 0)
+    {
+        return;
+    }
+
+    stats.signals++;
+    emitting = true;
+    sd_bus_emit_properties_changed_strv(bus.get(), objPath.data(),
+                                        Base::Watchdog::interface,
+                                        const_cast<char**>(names.data()));
+    emitting = false;
 }
 
+void Watchdog::flushSignals()
+{
+    emitChanged(published);
+    published = snapshot();
+    emitDeadline();
+}
+
+void Watchdog::updateDeadline(std::optional<Timer::TimePoint> when)
+{
+    uint64_t value = 0;
+    if (when)
+    {
+        value = duration_cast<microseconds>(when->time_since_epoch()).count();
+    }
+    if (value == deadlineUs)
+    {
+        return;
+    }
+
+    deadlineUs = value;
+    if (stateCallback)
+    {
+        stateCallback();
+    }
+    stateChanged(false);
+
+    // Every move is signaled, kicks in a burst share one signal carrying
+    // the latest deadline
+    deadlineStale = true;
+    if (deferSignals)
+    {
+        flushSource->set_enabled(sdeventplus::source::Enabled::OneShot);
+    }
+    else if (!holdSignals)
+    {
+        emitDeadline();
+    }
+}
+
+void Watchdog::emitDeadline()
+{
+    if (!deadlineStale || deadlineSignal.isEnabled())
+    {
+        return;
+    }
+    if (deadlineUs == signaledDeadlineUs)
+    {
+        deadlineStale = false;
+        return;
+    }
+
+    auto now = sdeventplus::Clock<sdeventplus::ClockId::Monotonic>(event).now();
+    if (deadlineSignaledAt && now - *deadlineSignaledAt < DEADLINE_SIGNAL_GAP)
+    {
+        deadlineSignal.restartOnce(duration_cast<microseconds>(
+            *deadlineSignaledAt + DEADLINE_SIGNAL_GAP - now));
+        return;
+    }
+
+    deadlineStale = false;
+    deadlineSignaledAt = now;
+    signaledDeadlineUs = deadlineUs;
+    poll.deadlineSignals++;
+    emitting = true;
+    sd_bus_emit_properties_changed(bus.get(), objPath.data(),
+                                   CONTROL_INTERFACE, "Deadline", nullptr);
+    emitting = false;
+}
+
+int Watchdog::getDeadline(sd_bus*, const char*, const char*, const char*,
+                          sd_bus_message* reply, void* context, sd_bus_error*)
+{
+    auto wdog = static_cast<Watchdog*>(context);
+    if (!wdog->emitting)
+    {
+        wdog->poll.deadlineReads++;
+    }
+    return sd_bus_message_append(reply, "t", wdog->deadlineUs);
+}
+
+namespace
+{
+
+int configureCallback(sd_bus_message* msg, void* context, sd_bus_error* error)
+{
+    auto wdog = static_cast<Watchdog*>(context);
+    try
+    {
+        auto m = sdbusplus::message_t(msg);
+        uint64_t interval;
+        std::string action;
+        std::string timerUse;
+        bool enable;
+        uint64_t remaining;
+        m.read(interval, action, timerUse, enable, remaining);
+
+        wdog->configure(interval, Watchdog::convertActionFromString(action),
+                        Watchdog::convertTimerUseFromString(timerUse), enable,
+                        remaining);
+
+        auto reply = m.new_method_return();
+        reply.method_return();
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        return sd_bus_error_set(error, e.name(), e.description());
+    }
+    return 1;
+}
+
+int startTimerUseCallback(sd_bus_message* msg, void* context,
+                          sd_bus_error* error)
+{
+    auto wdog = static_cast<Watchdog*>(context);
+    try
+    {
+        auto m = sdbusplus::message_t(msg);
+        std::string timerUse;
+        uint64_t interval;
+        std::string action;
+        m.read(timerUse, interval, action);
+
+        wdog->startTimerUse(Watchdog::convertTimerUseFromString(timerUse),
+                            interval,
+                            Watchdog::convertActionFromString(action));
+
+        auto reply = m.new_method_return();
+        reply.method_return();
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        return sd_bus_error_set(error, e.name(), e.description());
+    }
+    return 1;
+}
+
+/** @brief Handles a method taking nothing but a timer use */
+template <void (Watchdog::*apply)(Watchdog::TimerUse)>
+int timerUseCallback(sd_bus_message* msg, void* context, sd_bus_error* error)
+{
+    auto wdog = static_cast<Watchdog*>(context);
+    try
+    {
+        auto m = sdbusplus::message_t(msg);
+        std::string timerUse;
+        m.read(timerUse);
+
+        (wdog->*apply)(Watchdog::convertTimerUseFromString(timerUse));
+
+        auto reply = m.new_method_return();
+        reply.method_return();
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        return sd_bus_error_set(error, e.name(), e.description());
+    }
+    return 1;
+}
+
+int getTimerUseDeadlines(sd_bus*, const char*, const char*, const char*,
+                         sd_bus_message* reply, void* context, sd_bus_error*)
+{
+    auto wdog = static_cast<Watchdog*>(context);
+    int r = sd_bus_message_open_container(reply, 'a', "{st}");
+    for (auto i = 0; r >= 0 && i <= static_cast<int>(Watchdog::TimerUse::OEM);
+         ++i)
+    {
+        auto timerUse = static_cast<Watchdog::TimerUse>(i);
+        auto deadline = wdog->timerUseDeadline(timerUse);
+        if (deadline != 0)
+        {
+            r = sd_bus_message_append(
+                reply, "{st}", Base::convertForMessage(timerUse).c_str(),
+                deadline);
+        }
+    }
+    return r < 0 ? r : sd_bus_message_close_container(reply);
+}
+
+int dumpHistoryCallback(sd_bus_message* msg, void* context,
+                        sd_bus_error* error)
+{
+    auto wdog = static_cast<Watchdog*>(context);
+    try
+    {
+        auto m = sdbusplus::message_t(msg);
+        std::vector<std::tuple<uint64_t, std::string, uint64_t>> entries;
+        for (const auto& entry : wdog->history().entries())
+        {
+            entries.emplace_back(entry.time, historyEventName(entry.event),
+                                 entry.value);
+        }
+
+        auto reply = m.new_method_return();
+        reply.append(entries);
+        reply.method_return();
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        return sd_bus_error_set(error, e.name(), e.description());
+    }
+    return 1;
+}
+
+int getPropertyMutations(sd_bus*, const char*, const char*, const char*,
+                         sd_bus_message* reply, void* context, sd_bus_error*)
+{
+    auto wdog = static_cast<Watchdog*>(context);
+    return sd_bus_message_append(reply, "t", wdog->signalStats().mutations);
+}
+
+int getPropertySignals(sd_bus*, const char*, const char*, const char*,
+                       sd_bus_message* reply, void* context, sd_bus_error*)
+{
+    auto wdog = static_cast<Watchdog*>(context);
+    return sd_bus_message_append(reply, "t", wdog->signalStats().signals);
+}
+
+int getTimeRemainingReads(sd_bus*, const char*, const char*, const char*,
+                          sd_bus_message* reply, void* context, sd_bus_error*)
+{
+    auto wdog = static_cast<Watchdog*>(context);
+    return sd_bus_message_append(reply, "t",
+                                 wdog->pollStats().timeRemainingReads);
+}
+
+int getDeadlineReads(sd_bus*, const char*, const char*, const char*,
+                     sd_bus_message* reply, void* context, sd_bus_error*)
+{
+    auto wdog = static_cast<Watchdog*>(context);
+    return sd_bus_message_append(reply, "t", wdog->pollStats().deadlineReads);
+}
+
+int getDeadlineSignals(sd_bus*, const char*, const char*, const char*,
+                       sd_bus_message* reply, void* context, sd_bus_error*)
+{
+    auto wdog = static_cast<Watchdog*>(context);
+    return sd_bus_message_append(reply, "t",
+                                 wdog->pollStats().deadlineSignals);
+}
+
+int getKicks(sd_bus*, const char*, const char*, const char*,
+             sd_bus_message* reply, void* context, sd_bus_error*)
+{
+    auto wdog = static_cast<Watchdog*>(context);
+    return sd_bus_message_append(reply, "t", wdog->metrics().kicks.get());
+}
+
+int getExpirations(sd_bus*, const char*, const char*, const char*,
+                   sd_bus_message* reply, void* context, sd_bus_error*)
+{
+    auto wdog = static_cast<Watchdog*>(context);
+    return sd_bus_message_append(reply, "t",
+                                 wdog->metrics().expirations.get());
+}
+
+int getFallbackEntries(sd_bus*, const char*, const char*, const char*,
+                       sd_bus_message* reply, void* context, sd_bus_error*)
+{
+    auto wdog = static_cast<Watchdog*>(context);
+    return sd_bus_message_append(reply, "t",
+                                 wdog->metrics().fallbackEntries.get());
+}
+
+int getStartUnitSuccesses(sd_bus*, const char*, const char*, const char*,
+                          sd_bus_message* reply, void* context, sd_bus_error*)
+{
+    auto wdog = static_cast<Watchdog*>(context);
+    return sd_bus_message_append(reply, "t",
+                                 wdog->metrics().startUnitSuccesses.get());
+}
+
+int getStartUnitFailures(sd_bus*, const char*, const char*, const char*,
+                         sd_bus_message* reply, void* context, sd_bus_error*)
+{
+    auto wdog = static_cast<Watchdog*>(context);
+    return sd_bus_message_append(reply, "t",
+                                 wdog->metrics().startUnitFailures.get());
+}
+
+/** @brief Appends an array of uint64 as an "at" */
+template <size_t N>
+int appendArray(sd_bus_message* reply, const std::array<uint64_t, N>& values)
+{
+    return sd_bus_message_append_array(reply, 't', values.data(),
+                                       sizeof(values));
+}
+
+int getKickMarginBounds(sd_bus*, const char*, const char*, const char*,
+                        sd_bus_message* reply, void* context, sd_bus_error*)
+{
+    auto wdog = static_cast<Watchdog*>(context);
+    return appendArray(reply, wdog->metrics().kickMargin.upperBounds());
+}
+
+int getKickMarginBuckets(sd_bus*, const char*, const char*, const char*,
+                         sd_bus_message* reply, void* context, sd_bus_error*)
+{
+    auto wdog = static_cast<Watchdog*>(context);
+    return appendArray(reply, wdog->metrics().kickMargin.buckets());
+}
+
+int getStartUnitLatencyBounds(sd_bus*, const char*, const char*, const char*,
+                              sd_bus_message* reply, void* context,
+                              sd_bus_error*)
+{
+    auto wdog = static_cast<Watchdog*>(context);
+    return appendArray(reply, wdog->metrics().startUnitLatency.upperBounds());
+}
+
+int getStartUnitLatencyBuckets(sd_bus*, const char*, const char*,
+                               const char*, sd_bus_message* reply,
+                               void* context, sd_bus_error*)
+{
+    auto wdog = static_cast<Watchdog*>(context);
+    return appendArray(reply, wdog->metrics().startUnitLatency.buckets());
+}
+
+} // namespace
+
+const sdbusplus::vtable_t Watchdog::controlVtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::method("Configure", "tssbt", "", configureCallback),
+    sdbusplus::vtable::method("DumpHistory", "", "a(tst)",
+                              dumpHistoryCallback),
+    sdbusplus::vtable::method("StartTimerUse", "sts", "",
+                              startTimerUseCallback),
+    sdbusplus::vtable::method("ResetTimerUse", "s", "",
+                              timerUseCallback<&Watchdog::resetTimerUse>),
+    sdbusplus::vtable::method("StopTimerUse", "s", "",
+                              timerUseCallback<&Watchdog::stopTimerUse>),
+    sdbusplus::vtable::property("PropertyMutations", "t",
+                                getPropertyMutations),
+    sdbusplus::vtable::property("PropertySignals", "t", getPropertySignals),
+    sdbusplus::vtable::property("Deadline", "t", Watchdog::getDeadline,
+                                sdbusplus::vtable::property_::emits_change),
+    sdbusplus::vtable::property("TimeRemainingReads", "t",
+                                getTimeRemainingReads),
+    sdbusplus::vtable::property("DeadlineReads", "t", getDeadlineReads),
+    sdbusplus::vtable::property("DeadlineSignals", "t", getDeadlineSignals),
+    sdbusplus::vtable::property("TimerUseDeadlines", "a{st}",
+                                getTimerUseDeadlines),
+    sdbusplus::vtable::signal("Timeout", "s"),
+    sdbusplus::vtable::end(),
+};
+
+// The metrics change far too often to signal, clients poll them
+const sdbusplus::vtable_t Watchdog::statsVtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::property("Kicks", "t", getKicks),
+    sdbusplus::vtable::property("Expirations", "t", getExpirations),
+    sdbusplus::vtable::property("FallbackEntries", "t", getFallbackEntries),
+    sdbusplus::vtable::property("StartUnitSuccesses", "t",
+                                getStartUnitSuccesses),
+    sdbusplus::vtable::property("StartUnitFailures", "t",
+                                getStartUnitFailures),
+    sdbusplus::vtable::property("KickMarginBounds", "at",
+                                getKickMarginBounds),
+    sdbusplus::vtable::property("KickMarginBuckets", "at",
+                                getKickMarginBuckets),
+    sdbusplus::vtable::property("StartUnitLatencyBounds", "at",
+                                getStartUnitLatencyBounds),
+    sdbusplus::vtable::property("StartUnitLatencyBuckets", "at",
+                                getStartUnitLatencyBuckets),
+    sdbusplus::vtable::end(),
+};
+
 } // namespace watchdog
 } // namespace phosphor
@@ -1,13 +1,30 @@
 #pragma once
 
+#include "executor.hpp"
+#include "history.hpp"
+#include "log_limiter.hpp"
+#include "metrics.hpp"
+#include "state_file.hpp"
+#include "timer.hpp"
+#include "timer_mux.hpp"
+#include "timer_uses.hpp"
+
 #include <sdbusplus/bus.hpp>
+#include <sdbusplus/message.hpp>
+#include <sdbusplus/server/interface.hpp>
 #include <sdbusplus/server/object.hpp>
+#include <sdbusplus/vtable.hpp>
 #include <sdeventplus/event.hpp>
+#include <sdeventplus/source/event.hpp>
 #include <sdeventplus/utility/timer.hpp>
 #include <xyz/openbmc_project/State/Watchdog/server.hpp>
 
+#include <array>
+#include <chrono>
 #include <functional>
+#include <memory>
 #include <optional>
+#include <string>
 #include <string_view>
 #include <unordered_map>
 #include <utility>
@@ -18,6 +35,14 @@ namespace watchdog
 {
 
 constexpr auto DEFAULT_MIN_INTERVAL_MS = 0;
+
+// Interface carrying the Timeout signal and our additions to the
+// xyz.openbmc_project.State.Watchdog API.
+constexpr auto CONTROL_INTERFACE = "xyz.openbmc_project.Watchdog";
+
+// Interface publishing the runtime metrics of a watchdog.
+constexpr auto STATS_INTERFACE = "xyz.openbmc_project.Watchdog.Stats";
+
 namespace Base = sdbusplus::xyz::openbmc_project::State::server;
 using WatchdogInherits = sdbusplus::server::object_t<Base::Watchdog>;
 
@@ -71,12 +96,48 @@ class Watchdog : public WatchdogInherits
              std::optional<Fallback>&& fallback = std::nullopt,
              uint64_t minInterval = DEFAULT_MIN_INTERVAL_MS,
              uint64_t defaultInterval = 0, bool exitAfterTimeout = false) :
+        Watchdog(bus, objPath, event, std::make_unique<EventTimer>(event),
+                 std::move(actionTargetMap), std::move(fallback), minInterval,
+                 defaultInterval, exitAfterTimeout)
+    {}
+
+    /** @brief Constructs the Watchdog object driven by the given timer
+     *
+     *  @param[in] bus              - DBus bus to attach to.
+     *  @param[in] objPath          - Object path to attach to.
+     *  @param[in] event            - reference to sdeventplus::Event loop
+     *  @param[in] timer            - timer driving every countdown
+     *  @param[in] actionTargets    - map of systemd targets called on timeout
+     *  @param[in] fallback         - fallback watchdog
+     *  @param[in] minInterval      - minimum intervale value allowed
+     *  @param[in] defaultInterval  - default interval to start with
+     *  @param[in] exitAfterTimeout - should the event loop be terminated
+     */
+    Watchdog(sdbusplus::bus_t& bus, const char* objPath,
+             const sdeventplus::Event& event, std::unique_ptr<Timer>&& timer,
+             ActionTargetMap&& actionTargetMap = {},
+             std::optional<Fallback>&& fallback = std::nullopt,
+             uint64_t minInterval = DEFAULT_MIN_INTERVAL_MS,
+             uint64_t defaultInterval = 0, bool exitAfterTimeout = false) :
         WatchdogInherits(bus, objPath), bus(bus),
-        actionTargetMap(std::move(actionTargetMap)), fallback(fallback),
-        minInterval(minInterval),
-        timer(event, std::bind(&Watchdog::timeOutHandler, this)),
+        controlInterface(bus, objPath, CONTROL_INTERFACE, controlVtable, this),
+        statsInterface(bus, objPath, STATS_INTERFACE, statsVtable, this),
+        actionPlans(makeActionPlans(actionTargetMap)),
+        timerUseNames(makeTimerUseNames()), fallback(fallback),
+        minInterval(minInterval), event(event),
+        timerUses(std::move(timer),
+                  std::bind(&Watchdog::timerUseExpired, this,
+                            std::placeholders::_1, std::placeholders::_2,
+                            std::placeholders::_3)),
+        timer(timerUses.makeTimer()),
+        startUnitRetry(event, std::bind(&Watchdog::dispatchStartUnit, this)),
+        deadlineSignal(event, std::bind(&Watchdog::emitDeadline, this)),
         objPath(objPath), exitAfterTimeout(exitAfterTimeout)
     {
+        this->timer->setCallback(std::bind(&Watchdog::timeOutHandler, this));
+        logFlush = timerUses.makeTimer();
+        logFlush->setCallback(std::bind(&Watchdog::flushLogs, this));
+
         // Use default if passed in otherwise just use default that comes
         // with object
         if (defaultInterval)
@@ -99,6 +160,152 @@ class Watchdog : public WatchdogInherits
      */
     void resetTimeRemaining(bool enableWatchdog) override;
 
+    /** @brief Resets the TimeRemaining like resetTimeRemaining(false) but
+     *         absorbs repeated kicks inside of the coalescing window.
+     *  @details Absorbed kicks neither reprogram the timer nor signal a
+     *  TimeRemaining change. Instead the deadline is extended once the
+     *  timer fires.
+     */
+    void kick();
+
+    /** @brief Sets the window used to coalesce kicks
+     *
+     *  @param[in] window - time after a kick is applied during which
+     *                      further kicks are absorbed, 0 to disable
+     */
+    void setKickCoalesceWindow(std::chrono::milliseconds window);
+
+    /** @brief Sets how often repeating messages are logged
+     *
+     *  @param[in] window - only the first occurrence of a message in
+     *                      every window is logged, 0 to log them all
+     */
+    void setLogWindow(Timer::Duration window);
+
+    /** @brief Rate limiting applied to repeating messages */
+    inline const LogLimiter& logLimiter() const
+    {
+        return logs;
+    }
+
+    /** @brief Sets how many of the latest events are kept
+     *  @details Drops whatever was recorded so far.
+     *
+     *  @param[in] size - number of events kept, 0 to keep none
+     */
+    void setHistorySize(size_t size);
+
+    /** @brief Sets the file the history is written to on every timeout
+     *
+     *  @param[in] path - file to write, empty to not write one
+     */
+    void setHistoryFile(const std::string& path);
+
+    /** @brief Checkpoints the state to a file and resumes from it
+     *  @details Restores the configuration and countdown saved by a
+     *  previous instance at the path, if any, then saves again on every
+     *  configuration change. Kicks are only saved once the slack has
+     *  passed so the kick path never does file I/O. A resumed countdown
+     *  gets the slack on top, so it never expires ahead of a kick that
+     *  did not make it to the file.
+     *
+     *  @param[in] path  - file to checkpoint to, empty to stop
+     *  @param[in] slack - longest a kick may go without being saved
+     */
+    void setStateFile(const std::string& path, Timer::Duration slack);
+
+    /** @brief Carries out an action directly instead of through systemd
+     *  @details The executor runs first on timeout. The systemd target of
+     *  the action, if any, is only started if the executor fails, either
+     *  right away or once it replies.
+     *
+     *  @param[in] action   - action to carry out
+     *  @param[in] executor - executor to use, nullptr for systemd only
+     */
+    void setExecutor(Action action, std::unique_ptr<Executor>&& executor);
+
+    /** @brief Latest kicks, interval changes, arms and timeouts */
+    inline const History& history() const
+    {
+        return eventHistory;
+    }
+
+    /** @brief Collects property changes and signals them once per event
+     *         loop iteration instead of on every change.
+     *
+     *  @param[in] defer - true to defer signals, false to signal changes
+     *                     as they happen
+     */
+    void setDeferSignals(bool defer);
+
+    /** @brief Called after every change of the watchdog state */
+    using StateCallback = std::function<void()>;
+
+    /** @brief Sets the function called after every state change
+     *  @details Covers every property of the State.Watchdog interface
+     *  as well as the deadline and the countdowns of the other timer uses.
+     *
+     *  @param[in] callback - function to call, empty to stop calling
+     */
+    inline void setStateCallback(StateCallback&& callback)
+    {
+        stateCallback = std::move(callback);
+    }
+
+    /** @brief Counts of property changes against the signals sent for them */
+    struct SignalStats
+    {
+        /** @brief Changes to the value of a signaled property */
+        uint64_t mutations = 0;
+        /** @brief PropertiesChanged signals emitted */
+        uint64_t signals = 0;
+    };
+
+    /** @brief Gets the property signal counters */
+    inline const SignalStats& signalStats() const
+    {
+        return stats;
+    }
+
+    /** @brief Gets the time the timer is due to expire
+     *  @details Published as the Deadline property so clients can work
+     *  out the time remaining locally instead of polling TimeRemaining.
+     *  Kicks absorbed by the coalescing window move it right away even
+     *  though the timer itself is only pushed out once it fires, so it
+     *  can be later than TimeRemaining implies. Every change is
+     *  signaled, at most once per DEADLINE_SIGNAL_GAP with the latest
+     *  value, so a signaled deadline is never more than the gap behind.
+     *
+     *  @return CLOCK_MONOTONIC microseconds, 0 if the timer is stopped
+     */
+    inline uint64_t deadline() const
+    {
+        return deadlineUs;
+    }
+
+    /** @brief Counts of the ways clients learn about the countdown */
+    struct PollStats
+    {
+        /** @brief Reads of TimeRemaining */
+        uint64_t timeRemainingReads = 0;
+        /** @brief Reads of Deadline */
+        uint64_t deadlineReads = 0;
+        /** @brief Signals sent for a change of Deadline */
+        uint64_t deadlineSignals = 0;
+    };
+
+    /** @brief Gets the countdown polling counters */
+    inline const PollStats& pollStats() const
+    {
+        return poll;
+    }
+
+    /** @brief Gets the runtime metrics published on STATS_INTERFACE */
+    inline const WatchdogMetrics& metrics() const
+    {
+        return counters;
+    }
+
     /** @brief Since we are overriding the setter-enabled but not the
      *         getter-enabled, we need to have this using in order to
      *         allow passthrough usage of the getter-enabled.
@@ -152,24 +359,270 @@ class Watchdog : public WatchdogInherits
      */
     uint64_t interval(uint64_t value) override;
 
+    /** @brief Passthrough of the ExpireAction getter */
+    using Base::Watchdog::expireAction;
+
+    /** @brief Set value of ExpireAction
+     *
+     *  @param[in] value - action taken on expiration
+     *
+     *  @return: action that was set
+     */
+    Action expireAction(Action value) override;
+
+    /** @brief Passthrough of the CurrentTimerUse getter */
+    using Base::Watchdog::currentTimerUse;
+
+    /** @brief Set value of CurrentTimerUse
+     *
+     *  @param[in] value - current use of the timer
+     *
+     *  @return: timer use that was set
+     */
+    TimerUse currentTimerUse(TimerUse value) override;
+
+    /** @brief Applies a complete timer configuration in one step
+     *  @details Used to service IPMI Set Watchdog Timer without exposing
+     *  intermediate states. The timer is armed at most once and a single
+     *  PropertiesChanged covering everything that changed is emitted.
+     *
+     *  @param[in] interval  - new Interval
+     *  @param[in] action    - new ExpireAction
+     *  @param[in] timerUse  - new CurrentTimerUse
+     *  @param[in] enable    - new Enabled
+     *  @param[in] remaining - TimeRemaining to count down from if enabled,
+     *                         0 to start from the interval when enabling
+     *                         or to keep the running countdown otherwise
+     */
+    void configure(uint64_t interval, Action action, TimerUse timerUse,
+                   bool enable, uint64_t remaining);
+
+    /** @brief Runs a countdown for a timer use besides the current one
+     *  @details The standard properties describe the countdown of the
+     *  CurrentTimerUse. Every other timer use can count down on its own
+     *  at the same time, with its own interval and action. Switching the
+     *  CurrentTimerUse to a timer use that is counting down brings its
+     *  countdown into the properties and keeps the one it replaces
+     *  running. Starting the current timer use restarts the countdown of
+     *  the properties.
+     *
+     *  @param[in] timerUse - timer use to count down for
+     *  @param[in] interval - milliseconds to count down from
+     *  @param[in] action   - action taken when it runs out
+     */
+    void startTimerUse(TimerUse timerUse, uint64_t interval, Action action);
+
+    /** @brief Restarts the countdown of a timer use from its interval
+     *
+     *  @param[in] timerUse - timer use to kick, ignored if not counting
+     */
+    void resetTimerUse(TimerUse timerUse);
+
+    /** @brief Stops the countdown of a timer use
+     *
+     *  @param[in] timerUse - timer use to stop
+     */
+    void stopTimerUse(TimerUse timerUse);
+
+    /** @brief Gets the time the countdown of a timer use runs out
+     *
+     *  @param[in] timerUse - timer use to look up
+     *
+     *  @return CLOCK_MONOTONIC microseconds, 0 if it is not counting down
+     */
+    uint64_t timerUseDeadline(TimerUse timerUse) const;
+
+    /** @brief Gets the time the first countdown runs out, of the current
+     *         timer use or any other.
+     *  @details What has to hold off a watchdog backing this one, such
+     *  as the kernel watchdog, since every countdown running here stops
+     *  being serviced along with it.
+     *
+     *  @return CLOCK_MONOTONIC microseconds, 0 if nothing is counting down
+     */
+    uint64_t earliestDeadline() const;
+
+    /** @brief Gets the mux driving every countdown from one timer */
+    inline const TimerMux& timers() const
+    {
+        return timerUses.mux();
+    }
+
     /** @brief Tells if the referenced timer is expired or not */
     inline auto timerExpired() const
     {
-        return timer.hasExpired();
+        return timer->hasExpired();
     }
 
     /** @brief Tells if the timer is running or not */
     inline bool timerEnabled() const
     {
-        return timer.isEnabled();
+        return timer->isEnabled();
     }
 
+    /** @brief Tells if the timeout action is still being carried out,
+     *         by its target or an executor.
+     */
+    bool actionPending() const;
+
+    /** @brief Checks that the countdown is being serviced
+     *  @details The state is consistent as long as an enabled watchdog
+     *  has its timer running or its action being started, and a running
+     *  timer is not overdue by more than the grace period. The countdowns
+     *  of the other timer uses must not be overdue either. An overdue
+     *  timer means the expiry is not getting dispatched.
+     *
+     *  @param[in] grace - time a deadline may pass before it is overdue
+     *
+     *  @return true if the countdown is in a consistent state
+     */
+    bool healthy(Timer::Duration grace) const;
+
   private:
     /** @brief sdbusplus handle */
     sdbusplus::bus_t& bus;
 
-    /** @brief Map of systemd units to be started when the timer expires */
-    ActionTargetMap actionTargetMap;
+    /** @brief Methods and signals of CONTROL_INTERFACE */
+    static const sdbusplus::vtable_t controlVtable[];
+
+    /** @brief Registration of CONTROL_INTERFACE */
+    sdbusplus::server::interface_t controlInterface;
+
+    /** @brief Properties of STATS_INTERFACE */
+    static const sdbusplus::vtable_t statsVtable[];
+
+    /** @brief Registration of STATS_INTERFACE */
+    sdbusplus::server::interface_t statsInterface;
+
+    /** @brief Runtime metrics */
+    WatchdogMetrics counters;
+
+    /** @brief Are property signals held back for a batch update */
+    bool holdSignals = false;
+
+    /** @brief Are property signals left to the next flush */
+    bool deferSignals = false;
+
+    /** @brief Values of the signaled properties at a point in time */
+    struct PropertySnapshot
+    {
+        bool enabled;
+        Action expireAction;
+        TimerUse currentTimerUse;
+        TimerUse expiredTimerUse;
+        uint64_t interval;
+        uint64_t timeRemaining;
+    };
+
+    /** @brief Property values last signaled when deferring signals */
+    PropertySnapshot published{};
+
+    /** @brief Flushes deferred signals on the next loop iteration */
+    std::optional<sdeventplus::source::Defer> flushSource;
+
+    /** @brief Property signal counters */
+    SignalStats stats;
+
+    /** @brief Called after every state change */
+    StateCallback stateCallback;
+
+    /** @brief Time the timer is due, see deadline() */
+    uint64_t deadlineUs = 0;
+
+    /** @brief Deadline last signaled */
+    uint64_t signaledDeadlineUs = 0;
+
+    /** @brief Has the deadline moved since it was last signaled */
+    bool deadlineStale = false;
+
+    /** @brief Time of the last Deadline signal on the event loop clock */
+    std::optional<sdeventplus::Clock<sdeventplus::ClockId::Monotonic>::
+                      time_point>
+        deadlineSignaledAt;
+
+    /** @brief Are properties being read to fill in a signal */
+    bool emitting = false;
+
+    /** @brief Countdown polling counters */
+    mutable PollStats poll;
+
+    /** @brief Records the time the timer was just armed to expire at
+     *
+     *  @param[in] when - expiration time, std::nullopt if stopped
+     */
+    void updateDeadline(std::optional<Timer::TimePoint> when);
+
+    /** @brief Signals Deadline if it moved and the last signal is at
+     *         least DEADLINE_SIGNAL_GAP old, otherwise schedules it.
+     */
+    void emitDeadline();
+
+    /** @brief D-Bus getter of the Deadline property */
+    static int getDeadline(sd_bus* bus, const char* path,
+                           const char* interface, const char* property,
+                           sd_bus_message* reply, void* context,
+                           sd_bus_error* error);
+
+    /** @brief Updates a property of the generated interface, signaling
+     *         the change now or leaving it to the batch or flush.
+     *
+     *  @param[in] set     - generated setter of the property
+     *  @param[in] current - current value of the property
+     *  @param[in] value   - value to set
+     *
+     *  @return: value that was set
+     */
+    template <typename T>
+    T setProperty(T (Base::Watchdog::*set)(T, bool), T current, T value);
+
+    /** @brief Captures the signaled properties */
+    PropertySnapshot snapshot() const;
+
+    /** @brief Emits one PropertiesChanged for everything that differs
+     *         from the snapshot.
+     */
+    void emitChanged(const PropertySnapshot& before);
+
+    /** @brief Signals everything changed since the last flush */
+    void flushSignals();
+
+    /** @brief Everything needed to carry out an action on timeout */
+    struct ActionPlan
+    {
+        /** @brief Action as rendered for D-Bus and the journal */
+        std::string name;
+        /** @brief Systemd unit to start, if any */
+        std::optional<TargetName> target;
+        /** @brief Carries out the action in place of the target, if any */
+        std::unique_ptr<Executor> executor;
+    };
+
+    /** @brief Number of values of the generated enums */
+    static constexpr size_t ACTION_COUNT =
+        static_cast<size_t>(Action::PowerCycle) + 1;
+    static constexpr size_t TIMER_USE_COUNT =
+        static_cast<size_t>(TimerUse::OEM) + 1;
+
+    /** @brief Action plans indexed by the Action */
+    using ActionPlans = std::array<ActionPlan, ACTION_COUNT>;
+
+    /** @brief Rendered timer uses indexed by the TimerUse */
+    using TimerUseNames = std::array<std::string, TIMER_USE_COUNT>;
+
+    /** @brief Resolves the plan of every action up front so that timing
+     *         out allocates nothing beyond the bus messages libsystemd
+     *         builds for it.
+     */
+    static ActionPlans makeActionPlans(const ActionTargetMap& targets);
+
+    /** @brief Renders every timer use up front */
+    static TimerUseNames makeTimerUseNames();
+
+    /** @brief Plans of the actions carried out when the timer expires */
+    ActionPlans actionPlans;
+
+    /** @brief Rendered timer uses */
+    TimerUseNames timerUseNames;
 
     /** @brief Fallback timer options */
     std::optional<Fallback> fallback;
@@ -177,12 +630,172 @@ class Watchdog : public WatchdogInherits
     /** @brief Minimum watchdog interval value */
     uint64_t minInterval;
 
-    /** @brief Contained timer object */
-    sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic> timer;
+    /** @brief Event loop the watchdog runs in */
+    sdeventplus::Event event;
+
+    /** @brief Countdowns of the timer uses besides the current one, and
+     *         the mux every countdown runs off of.
+     */
+    TimerUses timerUses;
+
+    /** @brief Countdown of the current timer use */
+    std::unique_ptr<Timer> timer;
+
+    /** @brief Window in which repeated kicks are absorbed */
+    Timer::Duration kickCoalesceWindow{0};
+
+    /** @brief Rate limits the messages repeated while a host flaps */
+    LogLimiter logs;
+
+    /** @brief Logs the summaries of suppressed messages once their window
+     *         runs out.
+     */
+    std::unique_ptr<Timer> logFlush;
+
+    /** @brief Asks the rate limit if a message is to be logged now, and
+     *         makes sure the summary follows if it is not.
+     *
+     *  @param[in] event  - the message that occurred
+     *  @param[in] detail - the state the message reports
+     *
+     *  @return true if the message should be logged
+     */
+    bool admitLog(LogEvent event, uint64_t detail = 0);
+
+    /** @brief Arms logFlush for the next summary due, if any */
+    void scheduleLogFlush();
+
+    /** @brief Logs the summaries that are due */
+    void flushLogs();
+
+    /** @brief Ring buffer of the latest events */
+    History eventHistory;
+
+    /** @brief Checkpoint for a restarted daemon, if any */
+    std::optional<StateFile> stateFile;
+
+    /** @brief Longest a kick may go without being checkpointed */
+    Timer::Duration stateSlack{0};
+
+    /** @brief Checkpoints kicks once the slack has passed */
+    std::optional<sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic>>
+        stateRefresh;
+
+    /** @brief Time the last kick was applied to the timer */
+    std::optional<Timer::TimePoint> lastKick;
+
+    /** @brief Time of the latest kick absorbed since then, if any */
+    std::optional<Timer::TimePoint> pendingKick;
+
+    /** @brief Time the last countdown ran out */
+    Timer::TimePoint lastTimeout;
+
+    /** @brief Target being started for the last timeout, if any */
+    const TargetName* startUnitTarget = nullptr;
+
+    /** @brief Number of times starting the target has been retried */
+    unsigned startUnitAttempt = 0;
+
+    /** @brief Action the target is being started for */
+    Action startUnitAction = Action::None;
+
+    /** @brief Time the timer expired into the target being started */
+    Timer::TimePoint startUnitExpiry;
+
+    /** @brief Outstanding asynchronous StartUnit call
+     *  @details Held as a raw sd-bus slot because the sdbusplus async
+     *  call wrapper allocates its callback.
+     */
+    std::unique_ptr<sd_bus_slot, decltype(&sd_bus_slot_unref)> startUnitCall{
+        nullptr, sd_bus_slot_unref};
+
+    /** @brief Delays the next StartUnit attempt after a failure */
+    sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic>
+        startUnitRetry;
+
+    /** @brief Sends a Deadline signal held back by DEADLINE_SIGNAL_GAP */
+    sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic>
+        deadlineSignal;
 
     /** @brief Optional Callback handler on timer expirartion */
     void timeOutHandler();
 
+    /** @brief Handles the countdown of a timer use running out
+     *
+     *  @param[in] timerUse - timer use that ran out
+     *  @param[in] interval - milliseconds it counted down from
+     *  @param[in] action   - action to take
+     */
+    void timerUseExpired(TimerUse timerUse, uint64_t interval, Action action);
+
+    /** @brief Lets the followers know a countdown of a timer use besides
+     *         the current one changed.
+     */
+    void timerUsesChanged();
+
+    /** @brief Makes a timer use that is counting down the current one,
+     *         keeping the countdown it replaces running.
+     */
+    void switchTimerUse(TimerUse timerUse);
+
+    /** @brief Carries out the action of a countdown that ran out
+     *
+     *  @param[in] action     - action to take
+     *  @param[in] expiredUse - timer use that ran out
+     */
+    void takeAction(Action action, TimerUse expiredUse);
+
+    /** @brief Time left on the timer in milliseconds, 0 if stopped */
+    uint64_t remainingMs() const;
+
+    /** @brief Writes the checkpoint now */
+    void saveState();
+
+    /** @brief Saves a configuration change now and a kick later
+     *
+     *  @param[in] config - the configuration changed, not just the
+     *                      countdown
+     */
+    void stateChanged(bool config);
+
+    /** @brief Resumes the configuration and countdown of a checkpoint */
+    void restoreState(const SavedState& state);
+
+    /** @brief Records a kick that reset the countdown and how much of the
+     *         countdown was left, absorbed kicks only once applied
+     *
+     *  @param[in] when      - time the kick came in
+     *  @param[in] remaining - milliseconds of the countdown left then
+     */
+    void recordKick(Timer::TimePoint when, uint64_t remaining);
+
+    /** @brief Handles an executor reporting how an action went, falling
+     *         back to the target of the action if it failed.
+     *
+     *  @param[in] action - action the executor carried out
+     *  @param[in] result - 0 or the negative errno it failed with
+     */
+    void executed(Action action, int result);
+
+    /** @brief Starts the target of an action, superseding any earlier one */
+    void startTarget(Action action);
+
+    /** @brief Counts a finished attempt to start the timeout target */
+    void recordStartUnit(bool success);
+
+    /** @brief Asynchronously asks systemd to start the pending target */
+    void dispatchStartUnit();
+
+    /** @brief Handles the reply to StartUnit */
+    static int startUnitDone(sd_bus_message* reply, void* context,
+                             sd_bus_error* error);
+
+    /** @brief Retries StartUnit with backoff or gives up on it */
+    void startUnitFailed(const char* error);
+
+    /** @brief Called once the pending target has been dealt with */
+    void startUnitFinished();
+
     /** @brief Attempt to enter the fallback watchdog or disables it */
     void tryFallbackOrDisable();
 
@@ -0,0 +1,164 @@
+#include "allocation_tracker.hpp"
+
+#include <dlfcn.h>
+
+#include <cstdlib>
+#include <new>
+
+// glibc entry points behind malloc(), calloc() and realloc()
+extern "C"
+{
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* p, size_t size);
+}
+
+namespace
+{
+
+#define TRACKER_TLS thread_local __attribute__((tls_model("initial-exec")))
+
+TRACKER_TLS size_t allocationCount = 0;
+TRACKER_TLS size_t allocationBytes = 0;
+TRACKER_TLS size_t busAllocationCount = 0;
+
+// Trackers in scope on this thread, nothing is counted without one
+TRACKER_TLS size_t trackers = 0;
+
+// Set while an allocation is being attributed
+TRACKER_TLS bool recording = false;
+
+// Load address of libsystemd, to tell its allocations apart
+const void* systemdBase = nullptr;
+
+void record(const void* caller, size_t size)
+{
+    if (trackers == 0 || recording)
+    {
+        return;
+    }
+    recording = true;
+    Dl_info info;
+    if (systemdBase != nullptr && dladdr(caller, &info) != 0 &&
+        info.dli_fbase == systemdBase)
+    {
+        busAllocationCount++;
+    }
+    else
+    {
+        allocationCount++;
+        allocationBytes += size;
+    }
+    recording = false;
+}
+
+void* allocate(size_t size)
+{
+    if (void* p = std::malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+extern "C" void* malloc(size_t size)
+{
+    record(__builtin_return_address(0), size);
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size)
+{
+    record(__builtin_return_address(0), count * size);
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* p, size_t size)
+{
+    if (size != 0)
+    {
+        record(__builtin_return_address(0), size);
+    }
+    return __libc_realloc(p, size);
+}
+
+void* operator new(size_t size)
+{
+    return allocate(size);
+}
+
+void* operator new[](size_t size)
+{
+    return allocate(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+AllocationTracker::AllocationTracker() :
+    startCount(allocationCount), startBytes(allocationBytes),
+    startBusCount(busAllocationCount)
+{
+    if (systemdBase == nullptr)
+    {
+        void* systemd = dlopen("libsystemd.so.0", RTLD_LAZY | RTLD_NOLOAD);
+        Dl_info info;
+        if (systemd != nullptr &&
+            dladdr(dlsym(systemd, "sd_bus_message_new_signal"), &info) != 0)
+        {
+            systemdBase = info.dli_fbase;
+        }
+        if (systemd != nullptr)
+        {
+            dlclose(systemd);
+        }
+    }
+    trackers++;
+}
+
+AllocationTracker::~AllocationTracker()
+{
+    trackers--;
+}
+
+size_t AllocationTracker::count() const
+{
+    return allocationCount - startCount;
+}
+
+size_t AllocationTracker::bytes() const
+{
+    return allocationBytes - startBytes;
+}
+
+size_t AllocationTracker::busCount() const
+{
+    return busAllocationCount - startBusCount;
+}
+
+} // namespace watchdog
+} // namespace phosphor
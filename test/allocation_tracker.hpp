@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+/** @class AllocationTracker
+ *  @brief Counts the heap allocations made while it is in scope.
+ *  @details Linking allocation_tracker.cpp replaces malloc(), calloc(),
+ *  realloc() and the global operator new for the whole test binary, so
+ *  that C and C++ allocations alike are seen. Allocations made from
+ *  within libsystemd, such as the bus messages it builds, are counted
+ *  apart from those of the watchdog library, sdbusplus and sdeventplus.
+ *  Only the calling thread is tracked.
+ */
+class AllocationTracker
+{
+  public:
+    AllocationTracker();
+    ~AllocationTracker();
+
+    AllocationTracker(const AllocationTracker&) = delete;
+    AllocationTracker& operator=(const AllocationTracker&) = delete;
+    AllocationTracker(AllocationTracker&&) = delete;
+    AllocationTracker& operator=(AllocationTracker&&) = delete;
+
+    /** @brief Number of allocations made so far */
+    size_t count() const;
+
+    /** @brief Number of bytes allocated so far */
+    size_t bytes() const;
+
+    /** @brief Number of allocations made by libsystemd so far, not
+     *         included in count()
+     */
+    size_t busCount() const;
+
+  private:
+    size_t startCount;
+    size_t startBytes;
+    size_t startBusCount;
+};
+
+} // namespace watchdog
+} // namespace phosphor
@@ -0,0 +1,256 @@
+#include "allocation_tracker.hpp"
+#include "executor.hpp"
+#include "private_bus.hpp"
+#include "tmp_dir.hpp"
+#include "virtual_timer.hpp"
+#include "watchdog.hpp"
+
+#include <unistd.h>
+
+#include <sdbusplus/bus.hpp>
+#include <sdeventplus/event.hpp>
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+class AllocationTest : public ::testing::Test
+{
+  public:
+    void SetUp() override
+    {
+        if (!privateBus.running())
+        {
+            GTEST_SKIP() << "dbus-daemon is not available";
+        }
+
+        wdogBus.emplace(privateBus.connect());
+        systemdBus.emplace(privateBus.connect());
+        for (auto* bus : {&*wdogBus, &*systemdBus})
+        {
+            bus->attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+        }
+        systemd = std::make_unique<MockSystemd>(*systemdBus);
+    }
+
+    void TearDown() override
+    {
+        wdog.reset();
+        systemd.reset();
+    }
+
+    // Creates the watchdog under test
+    void make(Watchdog::Action action,
+              std::optional<Watchdog::Fallback>&& fallback = std::nullopt)
+    {
+        Watchdog::ActionTargetMap targets;
+        targets[Watchdog::Action::HardReset] = TEST_TARGET;
+        wdog = std::make_unique<Watchdog>(*wdogBus, TEST_PATH, event,
+                                          clock.makeTimer(), std::move(targets),
+                                          std::move(fallback));
+        wdog->interval(milliseconds(INTERVAL).count());
+        wdog->expireAction(action);
+    }
+
+    // Counts the allocations made by expiring the watchdog once it has
+    // been through a timeout already. The Timeout signal and the call
+    // carrying out the action are messages libsystemd has to allocate,
+    // so only the allocations made outside of it are counted.
+    size_t allocationsToExpire()
+    {
+        wdog->enabled(true);
+        clock.advance(INTERVAL);
+        EXPECT_TRUE(runUntil(event, [&] { return !wdog->actionPending(); }));
+        wdog->enabled(true);
+
+        AllocationTracker tracker;
+        clock.advance(INTERVAL);
+        return tracker.count();
+    }
+
+    // Counts the allocations made by petting a running watchdog, bus
+    // messages built by libsystemd included
+    template <typename Pet>
+    size_t allocationsToPet(Pet&& pet)
+    {
+        wdog->enabled(true);
+        pet();
+
+        AllocationTracker tracker;
+        for (int i = 0; i < 100; ++i)
+        {
+            clock.advance(INTERVAL / 2);
+            pet();
+        }
+        return tracker.count() + tracker.busCount();
+    }
+
+    // Daemon shared by every connection
+    PrivateBus privateBus;
+
+    // sdevent Event handle
+    sdeventplus::Event event = sdeventplus::Event::get_new();
+
+    // Connections of the watchdog and mock systemd
+    std::optional<sdbusplus::bus_t> wdogBus;
+    std::optional<sdbusplus::bus_t> systemdBus;
+
+    std::unique_ptr<MockSystemd> systemd;
+    VirtualClock clock;
+    TmpDir dir{"allocations"};
+    std::unique_ptr<Watchdog> wdog;
+
+  protected:
+    static constexpr auto TEST_PATH = "/test/path";
+    static constexpr auto TEST_TARGET = "test-reset.target";
+    static constexpr auto INTERVAL = 1s;
+};
+
+/** @brief Make sure timing out into a target does not allocate */
+TEST_F(AllocationTest, timeoutWithTarget)
+{
+    make(Watchdog::Action::HardReset);
+    EXPECT_EQ(0, allocationsToExpire());
+    EXPECT_FALSE(wdog->enabled());
+
+    // Both timeouts reached systemd
+    EXPECT_TRUE(runUntil(event, [&] { return systemd->units.size() == 2; }));
+    EXPECT_EQ(TEST_TARGET, systemd->units.back());
+}
+
+/** @brief Make sure timing out without a target does not allocate */
+TEST_F(AllocationTest, timeoutWithoutTarget)
+{
+    make(Watchdog::Action::PowerOff);
+    EXPECT_EQ(0, allocationsToExpire());
+    EXPECT_FALSE(wdog->enabled());
+}
+
+/** @brief Make sure timing out into the fallback does not allocate */
+TEST_F(AllocationTest, timeoutIntoFallback)
+{
+    Watchdog::Fallback fallback;
+    fallback.action = Watchdog::Action::HardReset;
+    fallback.interval = milliseconds(INTERVAL * 2).count();
+    make(Watchdog::Action::PowerOff, std::move(fallback));
+    EXPECT_EQ(0, allocationsToExpire());
+    EXPECT_TRUE(wdog->timerEnabled());
+}
+
+/** @brief Make sure dumping the history on timeout does not allocate */
+TEST_F(AllocationTest, timeoutWithHistoryDump)
+{
+    auto path = dir.file("history");
+    make(Watchdog::Action::PowerOff);
+    wdog->setHistoryFile(path);
+    EXPECT_EQ(0, allocationsToExpire());
+    EXPECT_EQ(0, access(path.c_str(), F_OK));
+}
+
+/** @brief Make sure timing out into an executor does not allocate */
+TEST_F(AllocationTest, timeoutWithExecutor)
+{
+    make(Watchdog::Action::HardReset);
+    wdog->setExecutor(
+        Watchdog::Action::HardReset,
+        std::make_unique<FileExecutor>(dir.file("value", true), "1"));
+    EXPECT_EQ(0, allocationsToExpire());
+    EXPECT_FALSE(wdog->actionPending());
+}
+
+/** @brief Make sure resetting the countdown does not allocate. The
+ *         Deadline signal of the kicks is held back by the signal gap
+ *         and only goes out from the event loop.
+ */
+TEST_F(AllocationTest, resetTimeRemaining)
+{
+    make(Watchdog::Action::HardReset);
+    EXPECT_EQ(0, allocationsToPet([&] { wdog->resetTimeRemaining(false); }));
+    EXPECT_EQ(0, allocationsToPet([&] { wdog->resetTimeRemaining(true); }));
+    EXPECT_TRUE(wdog->timerEnabled());
+}
+
+/** @brief Make sure kicks checkpointed to a state file do not allocate */
+TEST_F(AllocationTest, resetTimeRemainingWithStateFile)
+{
+    make(Watchdog::Action::HardReset);
+    wdog->setStateFile(dir.file("state"), 1s);
+    EXPECT_EQ(0, allocationsToPet([&] { wdog->resetTimeRemaining(false); }));
+    EXPECT_TRUE(wdog->timerEnabled());
+}
+
+/** @brief Make sure setting the same countdown over and over does not
+ *         allocate. A new value is signaled, which takes a bus message.
+ */
+TEST_F(AllocationTest, setTimeRemaining)
+{
+    make(Watchdog::Action::HardReset);
+    uint64_t remaining = milliseconds(INTERVAL).count();
+    EXPECT_EQ(0, allocationsToPet([&] { wdog->timeRemaining(remaining); }));
+    EXPECT_TRUE(wdog->timerEnabled());
+}
+
+/** @brief Make sure enabling a running watchdog does not allocate */
+TEST_F(AllocationTest, enableWhileEnabled)
+{
+    make(Watchdog::Action::HardReset);
+    EXPECT_EQ(0, allocationsToPet([&] {
+                  wdog->enabled(true);
+                  wdog->kick();
+              }));
+    EXPECT_TRUE(wdog->timerEnabled());
+}
+
+/** @brief Make sure stopping and restarting the timer does not allocate
+ *         until the change is signaled from the event loop.
+ */
+TEST_F(AllocationTest, disableAndEnable)
+{
+    make(Watchdog::Action::HardReset);
+    wdog->setDeferSignals(true);
+    EXPECT_EQ(0, allocationsToPet([&] {
+                  wdog->enabled(false);
+                  wdog->enabled(true);
+              }));
+    EXPECT_TRUE(wdog->timerEnabled());
+}
+
+/** @brief Make sure logging every occurrence does not allocate */
+TEST_F(AllocationTest, unlimitedLogs)
+{
+    make(Watchdog::Action::HardReset);
+    wdog->setDeferSignals(true);
+    wdog->setLogWindow(0s);
+    EXPECT_EQ(0, allocationsToExpire());
+    EXPECT_EQ(0, allocationsToPet([&] {
+                  wdog->enabled(false);
+                  wdog->enabled(true);
+              }));
+}
+
+/** @brief Make sure summarizing suppressed logs does not allocate */
+TEST_F(AllocationTest, logSummaries)
+{
+    make(Watchdog::Action::HardReset);
+    wdog->setDeferSignals(true);
+    wdog->setLogWindow(INTERVAL * 2);
+    EXPECT_EQ(0, allocationsToPet([&] {
+                  wdog->enabled(false);
+                  wdog->enabled(true);
+              }));
+    EXPECT_LT(0, wdog->logLimiter().suppressed(LogEvent::Enabled));
+}
+
+} // namespace watchdog
+} // namespace phosphor
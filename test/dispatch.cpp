@@ -0,0 +1,127 @@
+#include "private_bus.hpp"
+#include "watchdog.hpp"
+
+#include <sdbusplus/bus.hpp>
+#include <sdeventplus/event.hpp>
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <variant>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+// Test that timeout actions are started without blocking the event loop
+class DispatchTest : public ::testing::Test
+{
+  public:
+    void SetUp() override
+    {
+        if (!privateBus.running())
+        {
+            GTEST_SKIP() << "dbus-daemon is not available";
+        }
+
+        wdogBus.emplace(privateBus.connect());
+        systemdBus.emplace(privateBus.connect());
+        clientBus.emplace(privateBus.connect());
+        for (auto* bus : {&*wdogBus, &*systemdBus, &*clientBus})
+        {
+            bus->attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+        }
+
+        systemd = std::make_unique<MockSystemd>(*systemdBus);
+
+        Watchdog::ActionTargetMap targets;
+        targets[Watchdog::Action::HardReset] = TEST_TARGET;
+        wdog = std::make_unique<Watchdog>(*wdogBus, TEST_PATH, event,
+                                          std::move(targets));
+        wdog->expireAction(Watchdog::Action::HardReset);
+        wdog->interval(milliseconds(TEST_INTERVAL).count());
+    }
+
+    void TearDown() override
+    {
+        wdog.reset();
+        systemd.reset();
+    }
+
+    // Daemon shared by every connection
+    PrivateBus privateBus;
+
+    // sdevent Event handle
+    sdeventplus::Event event = sdeventplus::Event::get_new();
+
+    // Connections of the watchdog, mock systemd and a client
+    std::optional<sdbusplus::bus_t> wdogBus;
+    std::optional<sdbusplus::bus_t> systemdBus;
+    std::optional<sdbusplus::bus_t> clientBus;
+
+    std::unique_ptr<MockSystemd> systemd;
+    std::unique_ptr<Watchdog> wdog;
+
+  protected:
+    static constexpr auto TEST_PATH = "/test/path";
+    static constexpr auto TEST_TARGET = "test-reset.target";
+    static constexpr auto TEST_INTERVAL = 50ms;
+};
+
+/** @brief Make sure the watchdog keeps serving property reads while
+ *         systemd sits on the StartUnit call.
+ */
+TEST_F(DispatchTest, propertiesServedWhileActionPending)
+{
+    systemd->hold = true;
+    EXPECT_TRUE(wdog->enabled(true));
+
+    // The watchdog expires and asks systemd to start the target
+    ASSERT_TRUE(runUntil(event, [&] { return !systemd->pending.empty(); }));
+    EXPECT_FALSE(wdog->enabled());
+    EXPECT_TRUE(wdog->actionPending());
+    ASSERT_EQ(1, systemd->units.size());
+    EXPECT_EQ(TEST_TARGET, systemd->units[0]);
+
+    // Reading a property is answered while the action is still pending
+    auto method = clientBus->new_method_call(
+        wdogBus->get_unique_name().c_str(), TEST_PATH,
+        "org.freedesktop.DBus.Properties", "Get");
+    method.append(Watchdog::interface, "Interval");
+    std::optional<uint64_t> interval;
+    auto slot = method.call_async([&](auto&& reply) {
+        std::variant<uint64_t> value;
+        reply.read(value);
+        interval = std::get<uint64_t>(value);
+    });
+    ASSERT_TRUE(runUntil(event, [&] { return interval.has_value(); }));
+    EXPECT_EQ(milliseconds(TEST_INTERVAL).count(), *interval);
+    EXPECT_EQ(1, systemd->pending.size());
+    EXPECT_TRUE(wdog->actionPending());
+
+    // The action completes once systemd gets around to replying
+    systemd->replyAll();
+    EXPECT_TRUE(runUntil(event, [&] { return !wdog->actionPending(); }));
+    EXPECT_EQ(1, systemd->units.size());
+}
+
+/** @brief Make sure failed starts are retried */
+TEST_F(DispatchTest, retryFailedStart)
+{
+    systemd->failures = 2;
+    EXPECT_TRUE(wdog->enabled(true));
+
+    ASSERT_TRUE(runUntil(event, [&] { return systemd->units.size() == 3; }));
+    EXPECT_TRUE(runUntil(event, [&] { return !wdog->actionPending(); }));
+    EXPECT_EQ(3, systemd->units.size());
+    EXPECT_TRUE(systemd->pending.empty());
+}
+
+} // namespace watchdog
+} // namespace phosphor
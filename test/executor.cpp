@@ -0,0 +1,303 @@
+#include "executor.hpp"
+#include "private_bus.hpp"
+#include "tmp_dir.hpp"
+#include "watchdog.hpp"
+
+#include <systemd/sd-bus.h>
+
+#include <sdbusplus/bus.hpp>
+#include <sdeventplus/event.hpp>
+
+#include <cerrno>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+/** @brief Make sure the value is written on every execution */
+TEST(FileExecutorTest, writesValue)
+{
+    TmpDir dir{"executor"};
+    auto line = dir.file("value", true);
+    FileExecutor executor(line, "1");
+    EXPECT_EQ("write 1 to " + line, executor.description());
+    EXPECT_EQ("", TmpDir::read(line));
+
+    EXPECT_EQ(0, executor.execute());
+    EXPECT_EQ("1", TmpDir::read(line));
+    EXPECT_EQ(0, executor.execute());
+    EXPECT_EQ("11", TmpDir::read(line));
+}
+
+/** @brief Make sure a file missing at startup is opened once it shows up */
+TEST(FileExecutorTest, retriesOpen)
+{
+    TmpDir dir{"executor"};
+    auto line = dir.file("value");
+    FileExecutor executor(line, "0");
+    EXPECT_EQ(-ENOENT, executor.execute());
+
+    std::ofstream(line).flush();
+    EXPECT_EQ(0, executor.execute());
+    EXPECT_EQ("0", TmpDir::read(line));
+}
+
+/** @brief Make sure executors are created from their descriptions */
+TEST(MakeExecutorTest, parses)
+{
+    auto bus = sdbusplus::bus::new_default();
+
+    auto file = makeExecutor(bus, "file:/sys/class/gpio/gpio42/value:1");
+    EXPECT_EQ("write 1 to /sys/class/gpio/gpio42/value", file->description());
+
+    auto property = makeExecutor(
+        bus, "property:xyz.openbmc_project.State.Chassis:"
+             "/xyz/openbmc_project/state/chassis0:"
+             "xyz.openbmc_project.State.Chassis:RequestedPowerTransition:"
+             "xyz.openbmc_project.State.Chassis.Transition.Off");
+    EXPECT_EQ("set xyz.openbmc_project.State.Chassis.RequestedPowerTransition"
+              " of /xyz/openbmc_project/state/chassis0 on "
+              "xyz.openbmc_project.State.Chassis to "
+              "xyz.openbmc_project.State.Chassis.Transition.Off",
+              property->description());
+
+    EXPECT_THROW(makeExecutor(bus, "file"), std::invalid_argument);
+    EXPECT_THROW(makeExecutor(bus, "file:/dev/null"), std::invalid_argument);
+    EXPECT_THROW(makeExecutor(bus, "property:a:/b:c:d"),
+                 std::invalid_argument);
+    EXPECT_THROW(makeExecutor(bus, "gpio:42:1"), std::invalid_argument);
+}
+
+/** @class MockStateManager
+ *  @brief Stands in for a state manager and records property sets.
+ */
+class MockStateManager
+{
+  public:
+    explicit MockStateManager(sdbusplus::bus_t& bus)
+    {
+        sd_bus_add_object(bus.get(), &slot, PATH, &MockStateManager::handle,
+                          this);
+        bus.request_name(SERVICE);
+    }
+
+    ~MockStateManager()
+    {
+        sd_bus_slot_unref(slot);
+    }
+
+    MockStateManager(const MockStateManager&) = delete;
+    MockStateManager& operator=(const MockStateManager&) = delete;
+
+    static constexpr auto SERVICE = "xyz.openbmc_project.State.Test";
+    static constexpr auto PATH = "/xyz/openbmc_project/state/test0";
+
+    /** @brief Interface.Property=Value of every set received, in order */
+    std::vector<std::string> sets;
+
+    /** @brief Reject every set with an error */
+    bool reject = false;
+
+  private:
+    sd_bus_slot* slot = nullptr;
+
+    static int handle(sd_bus_message* m, void* userdata, sd_bus_error*)
+    {
+        auto self = static_cast<MockStateManager*>(userdata);
+        if (!sd_bus_message_is_method_call(
+                m, "org.freedesktop.DBus.Properties", "Set"))
+        {
+            return 0;
+        }
+
+        const char* interface = nullptr;
+        const char* property = nullptr;
+        const char* value = nullptr;
+        sd_bus_message_read(m, "ssv", &interface, &property, "s", &value);
+        self->sets.push_back(std::string(interface) + "." + property + "=" +
+                             value);
+        if (self->reject)
+        {
+            sd_bus_reply_method_errorf(
+                m, "xyz.openbmc_project.Common.Error.NotAllowed",
+                "Transition rejected");
+            return 1;
+        }
+        sd_bus_reply_method_return(m, "");
+        return 1;
+    }
+};
+
+// Test that executors carry out timeouts in place of systemd
+class ExecutorTest : public ::testing::Test
+{
+  public:
+    void SetUp() override
+    {
+        if (!privateBus.running())
+        {
+            GTEST_SKIP() << "dbus-daemon is not available";
+        }
+
+        wdogBus.emplace(privateBus.connect());
+        serviceBus.emplace(privateBus.connect());
+        for (auto* bus : {&*wdogBus, &*serviceBus})
+        {
+            bus->attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+        }
+
+        systemd = std::make_unique<MockSystemd>(*serviceBus);
+        stateManager = std::make_unique<MockStateManager>(*serviceBus);
+
+        Watchdog::ActionTargetMap targets;
+        targets[Watchdog::Action::HardReset] = TEST_TARGET;
+        wdog = std::make_unique<Watchdog>(*wdogBus, TEST_PATH, event,
+                                          std::move(targets));
+        wdog->expireAction(Watchdog::Action::HardReset);
+        wdog->interval(milliseconds(TEST_INTERVAL).count());
+    }
+
+    void TearDown() override
+    {
+        wdog.reset();
+        stateManager.reset();
+        systemd.reset();
+    }
+
+    // Runs the loop for a while so that anything sent gets delivered
+    void settle()
+    {
+        runFor(event, TEST_INTERVAL);
+    }
+
+    // Daemon shared by every connection
+    PrivateBus privateBus;
+
+    // sdevent Event handle
+    sdeventplus::Event event = sdeventplus::Event::get_new();
+
+    // Connections of the watchdog and the services it calls
+    std::optional<sdbusplus::bus_t> wdogBus;
+    std::optional<sdbusplus::bus_t> serviceBus;
+
+    std::unique_ptr<MockSystemd> systemd;
+    std::unique_ptr<MockStateManager> stateManager;
+    std::unique_ptr<Watchdog> wdog;
+    TmpDir dir{"executor"};
+
+  protected:
+    static constexpr auto TEST_PATH = "/test/path";
+    static constexpr auto TEST_TARGET = "test-reset.target";
+    static constexpr auto TEST_INTERVAL = 50ms;
+};
+
+/** @brief Make sure an executor replaces the systemd target */
+TEST_F(ExecutorTest, executorReplacesTarget)
+{
+    auto line = dir.file("value", true);
+    wdog->setExecutor(Watchdog::Action::HardReset,
+                      std::make_unique<FileExecutor>(line, "1"));
+
+    EXPECT_TRUE(wdog->enabled(true));
+    ASSERT_TRUE(runUntil(event, [&] { return wdog->timerExpired(); }));
+    EXPECT_EQ("1", TmpDir::read(line));
+    EXPECT_FALSE(wdog->actionPending());
+
+    settle();
+    EXPECT_TRUE(systemd->units.empty());
+}
+
+/** @brief Make sure the target backs up an executor that fails */
+TEST_F(ExecutorTest, failedExecutorFallsBackToTarget)
+{
+    wdog->setExecutor(
+        Watchdog::Action::HardReset,
+        std::make_unique<FileExecutor>(dir.file("missing"), "1"));
+
+    EXPECT_TRUE(wdog->enabled(true));
+    ASSERT_TRUE(runUntil(event, [&] { return !systemd->units.empty(); }));
+    EXPECT_EQ(TEST_TARGET, systemd->units[0]);
+}
+
+/** @brief Make sure a property executor sets the property */
+TEST_F(ExecutorTest, setsProperty)
+{
+    wdog->setExecutor(Watchdog::Action::HardReset,
+                      std::make_unique<PropertyExecutor>(
+                          *wdogBus, MockStateManager::SERVICE,
+                          MockStateManager::PATH, "xyz.openbmc_project.Test",
+                          "RequestedTransition", "Reset"));
+
+    EXPECT_TRUE(wdog->enabled(true));
+    ASSERT_TRUE(
+        runUntil(event, [&] { return !stateManager->sets.empty(); }));
+    EXPECT_EQ("xyz.openbmc_project.Test.RequestedTransition=Reset",
+              stateManager->sets[0]);
+
+    settle();
+    EXPECT_TRUE(systemd->units.empty());
+}
+
+/** @brief Make sure the target backs up a property set that is rejected */
+TEST_F(ExecutorTest, rejectedPropertyFallsBackToTarget)
+{
+    stateManager->reject = true;
+    wdog->setExecutor(Watchdog::Action::HardReset,
+                      std::make_unique<PropertyExecutor>(
+                          *wdogBus, MockStateManager::SERVICE,
+                          MockStateManager::PATH, "xyz.openbmc_project.Test",
+                          "RequestedTransition", "Reset"));
+
+    EXPECT_TRUE(wdog->enabled(true));
+    ASSERT_TRUE(runUntil(event, [&] { return !systemd->units.empty(); }));
+    EXPECT_EQ(TEST_TARGET, systemd->units[0]);
+    EXPECT_EQ(1, stateManager->sets.size());
+}
+
+/** @brief Make sure the target backs up a state manager missing from the
+ *         bus.
+ */
+TEST_F(ExecutorTest, missingServiceFallsBackToTarget)
+{
+    wdog->setExecutor(Watchdog::Action::HardReset,
+                      std::make_unique<PropertyExecutor>(
+                          *wdogBus, "xyz.openbmc_project.State.Missing",
+                          MockStateManager::PATH, "xyz.openbmc_project.Test",
+                          "RequestedTransition", "Reset"));
+
+    EXPECT_TRUE(wdog->enabled(true));
+    EXPECT_TRUE(runUntil(event, [&] { return wdog->timerExpired(); }));
+    EXPECT_TRUE(wdog->actionPending());
+    ASSERT_TRUE(runUntil(event, [&] { return !systemd->units.empty(); }));
+    EXPECT_EQ(TEST_TARGET, systemd->units[0]);
+    EXPECT_TRUE(stateManager->sets.empty());
+}
+
+/** @brief Make sure actions without an executor still go to systemd */
+TEST_F(ExecutorTest, otherActionsUseTarget)
+{
+    auto line = dir.file("value", true);
+    wdog->setExecutor(Watchdog::Action::PowerOff,
+                      std::make_unique<FileExecutor>(line, "1"));
+
+    EXPECT_TRUE(wdog->enabled(true));
+    ASSERT_TRUE(runUntil(event, [&] { return !systemd->units.empty(); }));
+    EXPECT_EQ(TEST_TARGET, systemd->units[0]);
+    EXPECT_EQ("", TmpDir::read(line));
+}
+
+} // namespace watchdog
+} // namespace phosphor
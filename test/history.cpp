@@ -0,0 +1,75 @@
+#include "history.hpp"
+#include "tmp_dir.hpp"
+
+#include <unistd.h>
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+using namespace std::chrono_literals;
+
+class HistoryTest : public ::testing::Test
+{
+  public:
+    TmpDir dir{"history"};
+    std::string path = dir.file("history");
+    History::TimePoint now = History::TimePoint(1h);
+};
+
+/** @brief Make sure only the latest events are kept, oldest first */
+TEST_F(HistoryTest, keepsLatest)
+{
+    History history(3);
+    EXPECT_EQ(0, history.size());
+    for (uint64_t i = 0; i < 5; ++i)
+    {
+        history.record(now + std::chrono::seconds(i), HistoryEvent::Kick, i);
+    }
+
+    auto entries = history.entries();
+    ASSERT_EQ(3, entries.size());
+    for (uint64_t i = 0; i < 3; ++i)
+    {
+        EXPECT_EQ(i + 2, entries[i].value);
+        EXPECT_EQ(HistoryEvent::Kick, entries[i].event);
+        EXPECT_EQ((3600 + i + 2) * 1000000, entries[i].time);
+    }
+
+    history.resize(0);
+    history.record(now, HistoryEvent::Timeout);
+    EXPECT_EQ(0, history.size());
+}
+
+/** @brief Make sure the dump has a line per event */
+TEST_F(HistoryTest, dumpsToFile)
+{
+    History history(4);
+    EXPECT_TRUE(history.dump());
+
+    history.setDumpFile(path);
+    history.record(now, HistoryEvent::Enabled, 3000);
+    history.record(now + 1s, HistoryEvent::Kick, 2000);
+    history.record(now + 4s, HistoryEvent::Timeout, 1);
+    ASSERT_TRUE(history.dump());
+
+    std::ifstream file(path);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    EXPECT_EQ("3600000000 enabled 3000\n"
+              "3601000000 kick 2000\n"
+              "3604000000 timeout 1\n",
+              contents.str());
+    EXPECT_NE(0, access((path + ".tmp").c_str(), F_OK));
+}
+
+} // namespace watchdog
+} // namespace phosphor
@@ -0,0 +1,196 @@
+#include "kernel_watchdog.hpp"
+#include "tmp_dir.hpp"
+
+#include <linux/watchdog.h>
+
+#include <sdeventplus/clock.hpp>
+#include <sdeventplus/event.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+class KernelWatchdogTest : public ::testing::Test
+{
+  public:
+    // Creates the mirror with an ioctl recording every call
+    void open(seconds margin = 1s)
+    {
+        device = std::make_unique<KernelWatchdog>(
+            event, path, margin, [this](int, unsigned long request, int* arg) {
+                calls.emplace_back(request, *arg);
+                if (request == WDIOC_SETTIMEOUT)
+                {
+                    *arg = std::min(*arg, maxTimeout);
+                }
+                return 0;
+            });
+    }
+
+    // Deadline the given time from now on the event loop clock
+    uint64_t in(microseconds time)
+    {
+        auto now = sdeventplus::Clock<sdeventplus::ClockId::Monotonic>(event)
+                       .now()
+                       .time_since_epoch();
+        return duration_cast<microseconds>(now + time).count();
+    }
+
+    // Contents written to the stand-in device
+    std::string written()
+    {
+        return TmpDir::read(path);
+    }
+
+    sdeventplus::Event event = sdeventplus::Event::get_new();
+    TmpDir dir{"kernel"};
+    // A plain file stands in for the character device
+    std::string path = dir.file("watchdog", true);
+    int maxTimeout = 3600;
+    std::vector<std::pair<unsigned long, int>> calls;
+    std::unique_ptr<KernelWatchdog> device;
+};
+
+using Call = std::pair<unsigned long, int>;
+
+/** @brief Make sure the device runs while there is a deadline and is
+ *         stopped with a magic close.
+ */
+TEST_F(KernelWatchdogTest, armsAndMagicCloses)
+{
+    open(2s);
+    EXPECT_FALSE(device->armed());
+    EXPECT_TRUE(calls.empty());
+
+    device->update(in(10s));
+    EXPECT_TRUE(device->armed());
+    EXPECT_EQ(12, device->timeout());
+    std::vector<Call> expected = {{WDIOC_SETTIMEOUT, 12},
+                                  {WDIOC_KEEPALIVE, 0}};
+    EXPECT_EQ(expected, calls);
+    EXPECT_EQ("", written());
+
+    device->update(0);
+    EXPECT_FALSE(device->armed());
+    EXPECT_EQ(0, device->timeout());
+    EXPECT_EQ("V", written());
+}
+
+/** @brief Make sure a clean shutdown stops the device */
+TEST_F(KernelWatchdogTest, magicCloseOnDestruction)
+{
+    open();
+    device->update(in(10s));
+    device.reset();
+    EXPECT_EQ("V", written());
+}
+
+/** @brief Make sure kicks leave the device alone unless they pull the
+ *         deadline in or push it past the device expiry.
+ */
+TEST_F(KernelWatchdogTest, onlyEarlierDeadlinesReprogram)
+{
+    open();
+    device->update(in(10s));
+    auto before = calls.size();
+
+    device->update(in(10500ms));
+    EXPECT_EQ(before, calls.size());
+
+    // A crash now would reset ahead of the deadline
+    device->update(in(20s));
+    ASSERT_EQ(before + 2, calls.size());
+    EXPECT_EQ(Call(WDIOC_SETTIMEOUT, 21), calls[before]);
+    EXPECT_EQ(21, device->timeout());
+    before = calls.size();
+
+    device->update(in(2s));
+    ASSERT_EQ(before + 2, calls.size());
+    EXPECT_EQ(Call(WDIOC_SETTIMEOUT, 3), calls[before]);
+    EXPECT_EQ(3, device->timeout());
+}
+
+/** @brief Make sure the device is refreshed ahead of its expiry with the
+ *         deadline current at that time.
+ */
+TEST_F(KernelWatchdogTest, refreshedAheadOfExpiry)
+{
+    open(2s);
+    device->update(in(1s));
+    EXPECT_EQ(3, device->timeout());
+
+    // Kicked within the device expiry, which it only learns about on the
+    // refresh
+    auto before = calls.size();
+    device->update(in(2500ms));
+    EXPECT_EQ(before, calls.size());
+    runFor(event, 1500ms);
+    ASSERT_LT(before, calls.size());
+    EXPECT_EQ(Call(WDIOC_SETTIMEOUT, 4), calls[before]);
+    EXPECT_EQ(4, device->timeout());
+}
+
+/** @brief Make sure deadlines past what the device can count are kept
+ *         alive with refreshes.
+ */
+TEST_F(KernelWatchdogTest, clampedTimeoutRefreshes)
+{
+    maxTimeout = 2;
+    open();
+    device->update(in(60s));
+    EXPECT_EQ(2, device->timeout());
+
+    auto before = calls.size();
+    runFor(event, 1500ms);
+    EXPECT_NE(calls.end(), std::find(calls.begin() + before, calls.end(),
+                                     Call(WDIOC_KEEPALIVE, 0)));
+    EXPECT_TRUE(device->armed());
+}
+
+/** @brief Make sure a missing device is not fatal */
+TEST_F(KernelWatchdogTest, missingDevice)
+{
+    path = dir.file("missing");
+    open();
+    device->update(in(10s));
+    EXPECT_FALSE(device->armed());
+    EXPECT_TRUE(calls.empty());
+    device->update(0);
+}
+
+/** @brief Make sure a device showing up late is opened by a retry rather
+ *         than by kicks.
+ */
+TEST_F(KernelWatchdogTest, missingDeviceRetried)
+{
+    path = dir.file("late");
+    open();
+    device->update(in(10s));
+    EXPECT_FALSE(device->armed());
+
+    // Kicks leave it to the retry
+    std::ofstream(path).flush();
+    device->update(in(10s));
+    EXPECT_FALSE(device->armed());
+
+    runFor(event, 1500ms);
+    EXPECT_TRUE(device->armed());
+    EXPECT_EQ(Call(WDIOC_KEEPALIVE, 0), calls.back());
+}
+
+} // namespace watchdog
+} // namespace phosphor
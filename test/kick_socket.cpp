@@ -0,0 +1,113 @@
+#include "kick_socket.hpp"
+#include "tmp_dir.hpp"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <sdeventplus/event.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+using namespace std::chrono_literals;
+
+class KickSocketTest : public ::testing::Test
+{
+  public:
+    KickSocketTest()
+    {
+        client = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    }
+
+    ~KickSocketTest() override
+    {
+        kickSocket.reset();
+        close(client);
+    }
+
+    // Binds the socket under test allowing the given users
+    void listen(std::vector<uid_t>&& uids)
+    {
+        kickSocket = std::make_unique<KickSocket>(
+            event, path, std::move(uids), [this] { kicks++; });
+    }
+
+    // Sends a kick datagram as the current user
+    void send()
+    {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        ASSERT_EQ(1, sendto(client, "k", 1, 0,
+                            reinterpret_cast<sockaddr*>(&addr), sizeof(addr)));
+    }
+
+    // Services whatever is queued on the socket
+    void drain()
+    {
+        for (int i = 0; i < 5; ++i)
+        {
+            event.run(1ms);
+        }
+    }
+
+    sdeventplus::Event event = sdeventplus::Event::get_new();
+    TmpDir dir{"kick"};
+    std::string path = dir.file("kick");
+    int client;
+    size_t kicks = 0;
+    std::unique_ptr<KickSocket> kickSocket;
+};
+
+/** @brief Make sure allowed users kick and a backlog only kicks once */
+TEST_F(KickSocketTest, allowedUserKicks)
+{
+    listen({getuid()});
+    send();
+    drain();
+    EXPECT_EQ(1, kicks);
+    EXPECT_EQ(1, kickSocket->accepted());
+
+    for (int i = 0; i < 3; ++i)
+    {
+        send();
+    }
+    drain();
+    EXPECT_EQ(2, kicks);
+    EXPECT_EQ(4, kickSocket->accepted());
+    EXPECT_EQ(0, kickSocket->rejected());
+}
+
+/** @brief Make sure anyone else is ignored */
+TEST_F(KickSocketTest, otherUserRejected)
+{
+    listen({getuid() + 1});
+    send();
+    drain();
+    EXPECT_EQ(0, kicks);
+    EXPECT_EQ(0, kickSocket->accepted());
+    EXPECT_EQ(1, kickSocket->rejected());
+}
+
+/** @brief Make sure the socket goes away with the endpoint */
+TEST_F(KickSocketTest, unlinkedOnDestruction)
+{
+    listen({});
+    EXPECT_EQ(0, access(path.c_str(), F_OK));
+    kickSocket.reset();
+    EXPECT_NE(0, access(path.c_str(), F_OK));
+}
+
+} // namespace watchdog
+} // namespace phosphor
@@ -0,0 +1,112 @@
+#include "log_limiter.hpp"
+
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+using namespace std::chrono_literals;
+
+class LogLimiterTest : public ::testing::Test
+{
+  public:
+    LogLimiter limiter{10s};
+    LogLimiter::TimePoint now = LogLimiter::TimePoint(1h);
+};
+
+/** @brief Make sure only the first repeat in a window gets through */
+TEST_F(LogLimiterTest, repeatsSuppressedInWindow)
+{
+    EXPECT_TRUE(limiter.admit(LogEvent::FallingBack, now, 1000));
+    for (int i = 0; i < 5; ++i)
+    {
+        now += 1s;
+        EXPECT_FALSE(limiter.admit(LogEvent::FallingBack, now, 1000));
+    }
+    EXPECT_EQ(5, limiter.suppressed(LogEvent::FallingBack));
+
+    // A new window starts over, after summarizing
+    now += 5s;
+    EXPECT_TRUE(limiter.admit(LogEvent::FallingBack, now, 1000));
+    now += 1s;
+    EXPECT_FALSE(limiter.admit(LogEvent::FallingBack, now, 1000));
+    EXPECT_EQ(6, limiter.suppressed(LogEvent::FallingBack));
+}
+
+/** @brief Make sure a change in what the message reports gets through */
+TEST_F(LogLimiterTest, changesAlwaysLogged)
+{
+    EXPECT_TRUE(limiter.admit(LogEvent::Enabled, now, 1000));
+    EXPECT_FALSE(limiter.admit(LogEvent::Enabled, now, 1000));
+    EXPECT_TRUE(limiter.admit(LogEvent::Enabled, now, 2000));
+    EXPECT_FALSE(limiter.admit(LogEvent::Enabled, now, 2000));
+    EXPECT_TRUE(limiter.admit(LogEvent::Enabled, now, 1000));
+    EXPECT_EQ(2, limiter.suppressed(LogEvent::Enabled));
+}
+
+/** @brief Make sure messages are limited independently */
+TEST_F(LogLimiterTest, eventsIndependent)
+{
+    EXPECT_TRUE(limiter.admit(LogEvent::Enabled, now));
+    EXPECT_TRUE(limiter.admit(LogEvent::Disabled, now));
+    EXPECT_FALSE(limiter.admit(LogEvent::Enabled, now));
+    EXPECT_FALSE(limiter.admit(LogEvent::Disabled, now));
+    EXPECT_TRUE(limiter.admit(LogEvent::TimedOut, now));
+    EXPECT_EQ(1, limiter.suppressed(LogEvent::Enabled));
+    EXPECT_EQ(1, limiter.suppressed(LogEvent::Disabled));
+    EXPECT_EQ(0, limiter.suppressed(LogEvent::TimedOut));
+}
+
+/** @brief Make sure a burst lets through more, and 0 disables limiting */
+TEST_F(LogLimiterTest, burstAndDisable)
+{
+    limiter.setLimit(10s, 3);
+    for (int i = 0; i < 3; ++i)
+    {
+        EXPECT_TRUE(limiter.admit(LogEvent::Disabled, now));
+    }
+    EXPECT_FALSE(limiter.admit(LogEvent::Disabled, now));
+
+    limiter.setLimit(0s);
+    for (int i = 0; i < 3; ++i)
+    {
+        EXPECT_TRUE(limiter.admit(LogEvent::Disabled, now));
+    }
+    EXPECT_EQ(1, limiter.suppressed(LogEvent::Disabled));
+}
+
+/** @brief Make sure suppressed repeats are summarized once their window
+ *         runs out, without waiting for another occurrence.
+ */
+TEST_F(LogLimiterTest, flushSummarizesExpiredWindows)
+{
+    EXPECT_FALSE(limiter.nextFlush());
+    EXPECT_TRUE(limiter.admit(LogEvent::TimedOut, now));
+    EXPECT_FALSE(limiter.nextFlush());
+
+    now += 2s;
+    EXPECT_TRUE(limiter.admit(LogEvent::Disabled, now));
+    EXPECT_FALSE(limiter.admit(LogEvent::Disabled, now));
+    EXPECT_FALSE(limiter.admit(LogEvent::TimedOut, now));
+    EXPECT_EQ(now + 8s, limiter.nextFlush());
+
+    // Only the window that ran out is summarized
+    now += 8s;
+    limiter.flush(now);
+    EXPECT_EQ(0, limiter.pending(LogEvent::TimedOut));
+    EXPECT_EQ(1, limiter.pending(LogEvent::Disabled));
+    EXPECT_EQ(now + 2s, limiter.nextFlush());
+
+    now += 2s;
+    limiter.flush(now);
+    EXPECT_EQ(0, limiter.pending(LogEvent::Disabled));
+    EXPECT_FALSE(limiter.nextFlush());
+    EXPECT_EQ(1, limiter.suppressed(LogEvent::Disabled));
+}
+
+} // namespace watchdog
+} // namespace phosphor
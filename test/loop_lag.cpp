@@ -0,0 +1,84 @@
+#include "loop_lag.hpp"
+#include "timer.hpp"
+
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/source/event.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+// Number of probes recorded so far
+uint64_t probes(const LoopLagProbe& probe)
+{
+    auto buckets = probe.metrics().lag.buckets();
+    return std::accumulate(buckets.begin(), buckets.end(), uint64_t{0});
+}
+
+/** @brief Make sure a busy handler shows up as lag on the next probe */
+TEST(LoopLagTest, recordsBusyLoop)
+{
+    auto event = sdeventplus::Event::get_new();
+    LoopLagProbe probe(event, 10ms);
+
+    // Stand in for a slow bus handler that is running when the probe is due
+    sdeventplus::source::Defer busy(event, [](auto&) {
+        std::this_thread::sleep_for(30ms);
+    });
+    busy.set_enabled(sdeventplus::source::Enabled::OneShot);
+
+    auto start = steady_clock::now();
+    while (probes(probe) < 2 && steady_clock::now() - start < 1s)
+    {
+        event.run(10ms);
+    }
+    ASSERT_LE(2, probes(probe));
+
+    // The sleep held up the first probe by about 20ms
+    const auto& lag = probe.metrics().lag;
+    auto buckets = lag.buckets();
+    uint64_t late = 0;
+    for (size_t i = 0; i < buckets.size(); ++i)
+    {
+        if (i == lag.upperBounds().size() || lag.upperBounds()[i] > 10000)
+        {
+            late += buckets[i];
+        }
+    }
+    EXPECT_LE(1, late);
+    EXPECT_LE(10000, lag.sum());
+}
+
+/** @brief Make sure an expired timer is dispatched ahead of normal work */
+TEST(LoopLagTest, timerRunsFirst)
+{
+    auto event = sdeventplus::Event::get_new();
+    std::string order;
+
+    EventTimer timer(event);
+    timer.setCallback([&] { order += "t"; });
+    sdeventplus::source::Defer normal(event, [&](auto&) { order += "n"; });
+    normal.set_enabled(sdeventplus::source::Enabled::OneShot);
+    timer.setRemaining(0ms);
+    timer.setEnabled(true);
+    std::this_thread::sleep_for(1ms);
+
+    event.run(0ms);
+    event.run(0ms);
+    EXPECT_EQ("tn", order);
+}
+
+} // namespace watchdog
+} // namespace phosphor
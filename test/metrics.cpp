@@ -0,0 +1,139 @@
+#include "metrics.hpp"
+#include "metrics_socket.hpp"
+#include "tmp_dir.hpp"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <sdeventplus/event.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+using namespace std::chrono_literals;
+
+/** @brief Make sure values land in the first bucket that holds them */
+TEST(HistogramTest, bucketsByUpperBound)
+{
+    Histogram<3> hist({10, 20, 30});
+    for (uint64_t value : {0, 10, 11, 20, 30, 31, 1000})
+    {
+        hist.record(value);
+    }
+    Histogram<3>::Buckets expected = {2, 2, 1, 2};
+    EXPECT_EQ(expected, hist.buckets());
+    EXPECT_EQ(1102, hist.sum());
+}
+
+/** @brief Make sure the text exposition has every family and sample */
+TEST(MetricsTest, formatsEveryWatchdog)
+{
+    WatchdogMetrics host0;
+    WatchdogMetrics host1;
+    host0.kicks.add(3);
+    host1.expirations.add();
+    host1.kickMargin.record(7);
+    host1.kickMargin.record(100);
+
+    auto text = formatMetrics({{"/w/host0", &host0}, {"/w/host1", &host1}});
+
+    auto has = [&](const std::string& line) {
+        return text.find(line + "\n") != std::string::npos;
+    };
+    EXPECT_TRUE(has("# TYPE phosphor_watchdog_kicks_total counter"));
+    EXPECT_TRUE(has("phosphor_watchdog_kicks_total{path=\"/w/host0\"} 3"));
+    EXPECT_TRUE(has("phosphor_watchdog_kicks_total{path=\"/w/host1\"} 0"));
+    EXPECT_TRUE(
+        has("phosphor_watchdog_expirations_total{path=\"/w/host1\"} 1"));
+    EXPECT_TRUE(has("# TYPE phosphor_watchdog_kick_margin_percent "
+                    "histogram"));
+    EXPECT_TRUE(has("phosphor_watchdog_kick_margin_percent_bucket"
+                    "{path=\"/w/host1\",le=\"5\"} 0"));
+    EXPECT_TRUE(has("phosphor_watchdog_kick_margin_percent_bucket"
+                    "{path=\"/w/host1\",le=\"10\"} 1"));
+    EXPECT_TRUE(has("phosphor_watchdog_kick_margin_percent_bucket"
+                    "{path=\"/w/host1\",le=\"+Inf\"} 2"));
+    EXPECT_TRUE(has("phosphor_watchdog_kick_margin_percent_sum"
+                    "{path=\"/w/host1\"} 107"));
+    EXPECT_TRUE(has("phosphor_watchdog_kick_margin_percent_count"
+                    "{path=\"/w/host1\"} 2"));
+    EXPECT_TRUE(has("phosphor_watchdog_start_unit_latency_ms_count"
+                    "{path=\"/w/host0\"} 0"));
+
+    // Each family is only described once
+    auto first = text.find("# TYPE phosphor_watchdog_kicks_total");
+    EXPECT_EQ(std::string::npos,
+              text.find("# TYPE phosphor_watchdog_kicks_total", first + 1));
+}
+
+/** @brief Make sure the loop lag is only rendered when given, unlabeled */
+TEST(MetricsTest, formatsLoopLag)
+{
+    WatchdogMetrics host0;
+    EXPECT_EQ(std::string::npos,
+              formatMetrics({{"/w/host0", &host0}}).find("loop_lag"));
+
+    LoopMetrics loop;
+    loop.lag.record(80);
+    loop.lag.record(30000);
+    auto text = formatMetrics({{"/w/host0", &host0}}, &loop);
+
+    auto has = [&](const std::string& line) {
+        return text.find(line + "\n") != std::string::npos;
+    };
+    EXPECT_TRUE(has("# TYPE phosphor_watchdog_loop_lag_us histogram"));
+    EXPECT_TRUE(has("phosphor_watchdog_loop_lag_us_bucket{le=\"50\"} 0"));
+    EXPECT_TRUE(has("phosphor_watchdog_loop_lag_us_bucket{le=\"100\"} 1"));
+    EXPECT_TRUE(has("phosphor_watchdog_loop_lag_us_bucket{le=\"+Inf\"} 2"));
+    EXPECT_TRUE(has("phosphor_watchdog_loop_lag_us_sum 30080"));
+    EXPECT_TRUE(has("phosphor_watchdog_loop_lag_us_count 2"));
+}
+
+/** @brief Make sure every client is sent the rendering */
+TEST(MetricsSocketTest, servesRendering)
+{
+    TmpDir dir("metrics");
+    auto path = dir.file("metrics");
+    auto event = sdeventplus::Event::get_new();
+
+    {
+        MetricsSocket server(event, path, [] { return "metrics\n"; });
+
+        for (int i = 0; i < 2; ++i)
+        {
+            sockaddr_un addr{};
+            addr.sun_family = AF_UNIX;
+            std::strncpy(addr.sun_path, path.c_str(),
+                         sizeof(addr.sun_path) - 1);
+            int client = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            ASSERT_EQ(0, connect(client, reinterpret_cast<sockaddr*>(&addr),
+                                 sizeof(addr)));
+            event.run(1ms);
+
+            std::string received;
+            char buf[64];
+            ssize_t n;
+            while ((n = read(client, buf, sizeof(buf))) > 0)
+            {
+                received.append(buf, n);
+            }
+            close(client);
+            EXPECT_EQ("metrics\n", received);
+        }
+        EXPECT_EQ(2, server.served());
+    }
+    EXPECT_NE(0, access(path.c_str(), F_OK));
+}
+
+} // namespace watchdog
+} // namespace phosphor
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <systemd/sd-bus.h>
+#include <unistd.h>
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/message.hpp>
+#include <sdbusplus/message/native_types.hpp>
+#include <sdeventplus/event.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+/** @class PrivateBus
+ *  @brief Runs a dbus-daemon only visible to the test.
+ */
+class PrivateBus
+{
+  public:
+    PrivateBus()
+    {
+        char path[] = "/tmp/watchdog-bus-XXXXXX";
+        int fd = mkstemp(path);
+        if (fd < 0)
+        {
+            return;
+        }
+        configPath = path;
+        constexpr std::string_view config =
+            "<!DOCTYPE busconfig PUBLIC "
+            "\"-//freedesktop//DTD D-BUS Bus Configuration 1.0//EN\" "
+            "\"http://www.freedesktop.org/standards/dbus/1.0/"
+            "busconfig.dtd\">\n"
+            "<busconfig><type>session</type>"
+            "<listen>unix:tmpdir=/tmp</listen>"
+            "<auth>EXTERNAL</auth>"
+            "<policy context=\"default\">"
+            "<allow send_destination=\"*\" eavesdrop=\"true\"/>"
+            "<allow eavesdrop=\"true\"/><allow own=\"*\"/>"
+            "</policy></busconfig>\n";
+        bool written = write(fd, config.data(), config.size()) ==
+                       static_cast<ssize_t>(config.size());
+        close(fd);
+        if (!written)
+        {
+            return;
+        }
+
+        int pipefd[2];
+        if (pipe2(pipefd, O_CLOEXEC) < 0)
+        {
+            return;
+        }
+        std::string configArg = "--config-file=" + configPath;
+        pid = fork();
+        if (pid == 0)
+        {
+            dup2(pipefd[1], STDOUT_FILENO);
+            execlp("dbus-daemon", "dbus-daemon", "--nofork", "--print-address",
+                   configArg.c_str(), nullptr);
+            _exit(127);
+        }
+        close(pipefd[1]);
+
+        // The daemon prints its address once it is ready for clients
+        char c;
+        while (read(pipefd[0], &c, 1) == 1 && c != '\n')
+        {
+            address.push_back(c);
+        }
+        close(pipefd[0]);
+    }
+
+    ~PrivateBus()
+    {
+        if (pid > 0)
+        {
+            kill(pid, SIGTERM);
+            waitpid(pid, nullptr, 0);
+        }
+        if (!configPath.empty())
+        {
+            unlink(configPath.c_str());
+        }
+    }
+
+    PrivateBus(const PrivateBus&) = delete;
+    PrivateBus& operator=(const PrivateBus&) = delete;
+
+    /** @brief Did the daemon start up */
+    bool running() const
+    {
+        return !address.empty();
+    }
+
+    /** @brief Process id of the daemon */
+    pid_t daemonPid() const
+    {
+        return pid;
+    }
+
+    /** @brief Opens a new connection to the daemon */
+    sdbusplus::bus_t connect() const
+    {
+        sd_bus* b = nullptr;
+        sd_bus_new(&b);
+        sd_bus_set_address(b, address.c_str());
+        sd_bus_set_bus_client(b, 1);
+        sd_bus_start(b);
+        return sdbusplus::bus_t(b, std::false_type());
+    }
+
+  private:
+    /** @brief Daemon process */
+    pid_t pid = -1;
+
+    /** @brief Temporary daemon configuration */
+    std::string configPath;
+
+    /** @brief Address clients connect to */
+    std::string address;
+};
+
+/** @brief Gets a daemon shared by the whole process, started on first
+ *         use and stopped at exit.
+ */
+inline PrivateBus& privateBus()
+{
+    static PrivateBus bus;
+    return bus;
+}
+
+/** @class MockSystemd
+ *  @brief Stands in for the systemd manager and records StartUnit calls.
+ *  @details Replies can be held back to emulate a slow systemd, or the
+ *  first few calls can be failed to exercise retries.
+ */
+class MockSystemd
+{
+  public:
+    explicit MockSystemd(sdbusplus::bus_t& bus)
+    {
+        sd_bus_add_object(bus.get(), &slot, "/org/freedesktop/systemd1",
+                          &MockSystemd::handle, this);
+        bus.request_name("org.freedesktop.systemd1");
+    }
+
+    ~MockSystemd()
+    {
+        sd_bus_slot_unref(slot);
+    }
+
+    MockSystemd(const MockSystemd&) = delete;
+    MockSystemd& operator=(const MockSystemd&) = delete;
+
+    /** @brief Replies to every call being held back */
+    void replyAll()
+    {
+        for (auto& m : pending)
+        {
+            auto reply = m.new_method_return();
+            reply.append(sdbusplus::message::object_path(
+                "/org/freedesktop/systemd1/job/1"));
+            reply.method_return();
+        }
+        pending.clear();
+    }
+
+    /** @brief Units asked to be started, in order */
+    std::vector<std::string> units;
+
+    /** @brief Calls that have not been replied to yet */
+    std::vector<sdbusplus::message_t> pending;
+
+    /** @brief Hold back replies until replyAll() */
+    bool hold = false;
+
+    /** @brief Number of calls left to fail */
+    unsigned failures = 0;
+
+    /** @brief Called with the unit of every StartUnit call received */
+    std::function<void(const char* unit)> onStartUnit;
+
+  private:
+    sd_bus_slot* slot = nullptr;
+
+    static int handle(sd_bus_message* m, void* userdata, sd_bus_error*)
+    {
+        auto self = static_cast<MockSystemd*>(userdata);
+        if (!sd_bus_message_is_method_call(
+                m, "org.freedesktop.systemd1.Manager", "StartUnit"))
+        {
+            return 0;
+        }
+
+        const char* unit = nullptr;
+        const char* mode = nullptr;
+        sd_bus_message_read(m, "ss", &unit, &mode);
+        self->units.emplace_back(unit);
+        if (self->onStartUnit)
+        {
+            self->onStartUnit(unit);
+        }
+
+        if (self->failures > 0)
+        {
+            self->failures--;
+            sd_bus_reply_method_errorf(m, SD_BUS_ERROR_FAILED, "failed");
+            return 1;
+        }
+
+        self->pending.emplace_back(m);
+        if (!self->hold)
+        {
+            self->replyAll();
+        }
+        return 1;
+    }
+};
+
+/** @brief Runs the event loop until the condition holds or we give up */
+template <typename Condition>
+bool runUntil(sdeventplus::Event& event, Condition&& condition)
+{
+    using namespace std::chrono_literals;
+    for (int i = 0; i < 1000 && !condition(); ++i)
+    {
+        event.run(10ms);
+    }
+    return condition();
+}
+
+} // namespace watchdog
+} // namespace phosphor
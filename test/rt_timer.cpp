@@ -0,0 +1,173 @@
+#include "rt_timer.hpp"
+#include "watchdog.hpp"
+
+#include <sdbusplus/bus.hpp>
+#include <sdeventplus/event.hpp>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+// Slack allowed on top of the deadline for the thread to be scheduled,
+// without real-time priority a loaded machine can take a while
+constexpr auto SLACK = 50ms;
+
+// How long the event loop is held up, well past the deadline and slack
+constexpr auto STALL = 200ms;
+
+class RtTimerTest : public ::testing::Test
+{
+  public:
+    RtTimerTest() : timer(event, 0)
+    {
+        timer.setCallback([this] { callbacks++; });
+    }
+
+    // Services whatever the expiry thread handed over
+    void drain()
+    {
+        for (int i = 0; i < 5; ++i)
+        {
+            event.run(1ms);
+        }
+    }
+
+    sdeventplus::Event event = sdeventplus::Event::get_new();
+    RtTimer timer;
+    size_t callbacks = 0;
+};
+
+/** @brief Make sure the expiry is detected on time while the event loop
+ *         is stalled and the callback runs once the loop comes back.
+ */
+TEST_F(RtTimerTest, expiresWhileLoopStalled)
+{
+    auto start = timer.now();
+    timer.restart(20ms);
+    EXPECT_TRUE(timer.isEnabled());
+
+    // Stand in for a blocking D-Bus handler
+    std::this_thread::sleep_for(STALL);
+
+    EXPECT_TRUE(timer.hasExpired());
+    EXPECT_EQ(0, callbacks);
+    auto late = timer.expiredAt() - start;
+    EXPECT_LE(20ms, late);
+    EXPECT_GE(20ms + SLACK, late);
+
+    drain();
+    EXPECT_EQ(1, callbacks);
+}
+
+/** @brief Make sure kicks from the owning thread keep it from expiring */
+TEST_F(RtTimerTest, kicksPostponeExpiry)
+{
+    timer.restart(100ms);
+    for (int i = 0; i < 30; ++i)
+    {
+        std::this_thread::sleep_for(5ms);
+        timer.setRemaining(100ms);
+    }
+    EXPECT_FALSE(timer.hasExpired());
+
+    std::this_thread::sleep_for(100ms + SLACK);
+    EXPECT_TRUE(timer.hasExpired());
+}
+
+/** @brief Make sure pulling the deadline in wakes the expiry thread */
+TEST_F(RtTimerTest, shorterDeadlineWakesThread)
+{
+    auto start = timer.now();
+    timer.restart(10s);
+    timer.setRemaining(10ms);
+    std::this_thread::sleep_for(10ms + SLACK);
+
+    EXPECT_TRUE(timer.hasExpired());
+    EXPECT_GE(10ms + SLACK, timer.expiredAt() - start);
+}
+
+/** @brief Make sure a disabled timer never expires and keeps its time */
+TEST_F(RtTimerTest, disabledNeverExpires)
+{
+    timer.restart(10ms);
+    timer.setEnabled(false);
+    std::this_thread::sleep_for(10ms + SLACK);
+    drain();
+    EXPECT_FALSE(timer.hasExpired());
+    EXPECT_EQ(0, callbacks);
+
+    // The deadline passed while disabled so it fires straight away
+    timer.setEnabled(true);
+    std::this_thread::sleep_for(SLACK);
+    drain();
+    EXPECT_TRUE(timer.hasExpired());
+    EXPECT_EQ(1, callbacks);
+}
+
+/** @brief Make sure enabling a timer never given a deadline expires it
+ *         straight away, like an EventTimer does.
+ */
+TEST_F(RtTimerTest, enabledWithoutDeadlineExpires)
+{
+    timer.setEnabled(true);
+    std::this_thread::sleep_for(SLACK);
+    drain();
+    EXPECT_TRUE(timer.hasExpired());
+    EXPECT_FALSE(timer.isEnabled());
+    EXPECT_EQ(1, callbacks);
+}
+
+/** @brief Make sure a watchdog runs its action off the expiry thread */
+TEST(RtTimerWatchdogTest, timesOutWhileLoopStalled)
+{
+    auto event = sdeventplus::Event::get_new();
+    auto bus = sdbusplus::bus::new_default();
+    auto timer = std::make_unique<RtTimer>(event, 0);
+    auto& rt = *timer;
+    Watchdog wdog(bus, "/test/path", event, std::move(timer));
+    wdog.interval(milliseconds(20ms).count());
+    wdog.enabled(true);
+
+    auto start = rt.now();
+    std::this_thread::sleep_for(STALL);
+    EXPECT_TRUE(wdog.timerExpired());
+    EXPECT_GE(20ms + SLACK, rt.expiredAt() - start);
+
+    event.run(1ms);
+    EXPECT_FALSE(wdog.enabled());
+}
+
+/** @brief Make sure countdowns of other timer uses sharing the timer do
+ *         not hold back the detection.
+ */
+TEST(RtTimerWatchdogTest, timesOutWhileLoopStalledBesideTimerUses)
+{
+    auto event = sdeventplus::Event::get_new();
+    auto bus = sdbusplus::bus::new_default();
+    Watchdog wdog(bus, "/test/path", event,
+                  std::make_unique<RtTimer>(event, 0));
+    wdog.startTimerUse(Watchdog::TimerUse::OSLoad, 10000,
+                       Watchdog::Action::None);
+    wdog.interval(milliseconds(20ms).count());
+    wdog.enabled(true);
+
+    std::this_thread::sleep_for(STALL);
+    EXPECT_TRUE(wdog.timerExpired());
+    EXPECT_NE(0, wdog.timerUseDeadline(Watchdog::TimerUse::OSLoad));
+
+    event.run(1ms);
+    EXPECT_FALSE(wdog.enabled());
+}
+
+} // namespace watchdog
+} // namespace phosphor
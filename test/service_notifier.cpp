@@ -0,0 +1,163 @@
+#include "rt_timer.hpp"
+#include "service_notifier.hpp"
+#include "tmp_dir.hpp"
+#include "watchdog.hpp"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <sdbusplus/bus.hpp>
+#include <sdeventplus/event.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+class ServiceNotifierTest : public ::testing::Test
+{
+  public:
+    ServiceNotifierTest()
+    {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        setenv("NOTIFY_SOCKET", path.c_str(), 1);
+    }
+
+    ~ServiceNotifierTest() override
+    {
+        unsetenv("NOTIFY_SOCKET");
+        close(fd);
+    }
+
+    // Collects every notification sent so far
+    std::vector<std::string> received()
+    {
+        std::vector<std::string> messages;
+        char buf[256];
+        ssize_t len;
+        while ((len = recv(fd, buf, sizeof(buf), 0)) > 0)
+        {
+            messages.emplace_back(buf, len);
+        }
+        return messages;
+    }
+
+    sdeventplus::Event event = sdeventplus::Event::get_new();
+    TmpDir dir{"notify"};
+    std::string path = dir.file("notify");
+    int fd;
+};
+
+/** @brief Make sure readiness is only sent when asked for */
+TEST_F(ServiceNotifierTest, readyOnRequest)
+{
+    ServiceNotifier notifier(event, std::nullopt, [] { return true; });
+    runFor(event, 20ms);
+    EXPECT_TRUE(received().empty());
+
+    notifier.ready();
+    EXPECT_EQ(std::vector<std::string>{"READY=1"}, received());
+}
+
+/** @brief Make sure the pings follow the period and the liveness check */
+TEST_F(ServiceNotifierTest, pingsGatedOnLiveness)
+{
+    bool alive = true;
+    ServiceNotifier notifier(event, 10ms, [&] { return alive; });
+    runFor(event, 55ms);
+    auto pings = received();
+    EXPECT_LE(3, pings.size());
+    for (const auto& ping : pings)
+    {
+        EXPECT_EQ("WATCHDOG=1", ping);
+    }
+    EXPECT_EQ(pings.size(), notifier.pings());
+
+    alive = false;
+    runFor(event, 30ms);
+    EXPECT_TRUE(received().empty());
+    EXPECT_LE(2, notifier.withheld());
+}
+
+/** @brief Make sure the period comes from WatchdogSec */
+TEST_F(ServiceNotifierTest, periodFromEnvironment)
+{
+    EXPECT_FALSE(ServiceNotifier::pingPeriod());
+
+    setenv("WATCHDOG_USEC", "4000000", 1);
+    setenv("WATCHDOG_PID", std::to_string(getpid()).c_str(), 1);
+    auto period = ServiceNotifier::pingPeriod();
+    ASSERT_TRUE(period);
+    EXPECT_EQ(2s, *period);
+
+    // Meant for someone else
+    setenv("WATCHDOG_PID", std::to_string(getpid() + 1).c_str(), 1);
+    EXPECT_FALSE(ServiceNotifier::pingPeriod());
+    unsetenv("WATCHDOG_USEC");
+    unsetenv("WATCHDOG_PID");
+}
+
+/** @brief Make sure an expiry left undispatched fails the liveness check */
+TEST(WatchdogHealthTest, stalledExpiryIsUnhealthy)
+{
+    auto event = sdeventplus::Event::get_new();
+    auto bus = sdbusplus::bus::new_default();
+    Watchdog wdog(bus, "/test/path", event,
+                  std::make_unique<RtTimer>(event, 0));
+    EXPECT_TRUE(wdog.healthy(0ms));
+
+    wdog.interval(milliseconds(20ms).count());
+    wdog.enabled(true);
+    EXPECT_TRUE(wdog.healthy(50ms));
+
+    // The expiry is detected but the loop never gets to it
+    std::this_thread::sleep_for(100ms);
+    EXPECT_FALSE(wdog.healthy(50ms));
+
+    event.run(1ms);
+    EXPECT_TRUE(wdog.healthy(50ms));
+    EXPECT_FALSE(wdog.enabled());
+}
+
+/** @brief Make sure a timer use besides the current one left undispatched
+ *         fails the liveness check too.
+ */
+TEST(WatchdogHealthTest, stalledTimerUseIsUnhealthy)
+{
+    auto event = sdeventplus::Event::get_new();
+    auto bus = sdbusplus::bus::new_default();
+    Watchdog wdog(bus, "/test/path", event,
+                  std::make_unique<RtTimer>(event, 0));
+    wdog.startTimerUse(Watchdog::TimerUse::OSLoad, milliseconds(20ms).count(),
+                       Watchdog::Action::None);
+    EXPECT_FALSE(wdog.enabled());
+    EXPECT_TRUE(wdog.healthy(50ms));
+
+    std::this_thread::sleep_for(100ms);
+    EXPECT_FALSE(wdog.healthy(50ms));
+
+    event.run(1ms);
+    EXPECT_TRUE(wdog.healthy(50ms));
+    EXPECT_EQ(Watchdog::TimerUse::OSLoad, wdog.expiredTimerUse());
+}
+
+} // namespace watchdog
+} // namespace phosphor
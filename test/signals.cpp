@@ -0,0 +1,286 @@
+#include "private_bus.hpp"
+#include "watchdog.hpp"
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/bus/match.hpp>
+#include <sdeventplus/event.hpp>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+// Test the signals seen by D-Bus clients of the watchdog
+class SignalTest : public ::testing::Test
+{
+  public:
+    using PropertyMap =
+        std::map<std::string, std::variant<bool, uint64_t, std::string>>;
+
+    void SetUp() override
+    {
+        if (!privateBus.running())
+        {
+            GTEST_SKIP() << "dbus-daemon is not available";
+        }
+
+        wdogBus.emplace(privateBus.connect());
+        clientBus.emplace(privateBus.connect());
+        for (auto* bus : {&*wdogBus, &*clientBus})
+        {
+            bus->attach_event(event.get(), SD_EVENT_PRIORITY_NORMAL);
+        }
+
+        wdog = std::make_unique<Watchdog>(*wdogBus, TEST_PATH, event);
+
+        namespace rules = sdbusplus::bus::match::rules;
+        match = std::make_unique<sdbusplus::bus::match_t>(
+            *clientBus,
+            rules::propertiesChanged(TEST_PATH, Watchdog::interface),
+            [this](sdbusplus::message_t& m) {
+                std::string interface;
+                PropertyMap properties;
+                m.read(interface, properties);
+                changes.push_back(std::move(properties));
+            });
+
+        // Make sure the match is in place before anything is signaled
+        auto ping = clientBus->new_method_call(
+            "org.freedesktop.DBus", "/org/freedesktop/DBus",
+            "org.freedesktop.DBus", "GetId");
+        clientBus->call(ping);
+    }
+
+    void TearDown() override
+    {
+        match.reset();
+        wdog.reset();
+    }
+
+    // Calls Configure on the watchdog as a client and waits for the reply
+    void callConfigure(uint64_t interval, Watchdog::Action action,
+                       Watchdog::TimerUse timerUse, bool enable,
+                       uint64_t remaining)
+    {
+        auto method = clientBus->new_method_call(
+            wdogBus->get_unique_name().c_str(), TEST_PATH, CONTROL_INTERFACE,
+            "Configure");
+        method.append(interval, convertForMessage(action),
+                      convertForMessage(timerUse), enable, remaining);
+        bool done = false;
+        auto slot = method.call_async([&](auto&&) { done = true; });
+        ASSERT_TRUE(runUntil(event, [&] { return done; }));
+    }
+
+    // Runs the loop long enough for any signal in flight to arrive
+    void drain()
+    {
+        for (int i = 0; i < 10; ++i)
+        {
+            event.run(10ms);
+        }
+    }
+
+    // Daemon shared by every connection
+    PrivateBus privateBus;
+
+    // sdevent Event handle
+    sdeventplus::Event event = sdeventplus::Event::get_new();
+
+    // Connections of the watchdog and a client
+    std::optional<sdbusplus::bus_t> wdogBus;
+    std::optional<sdbusplus::bus_t> clientBus;
+
+    std::unique_ptr<Watchdog> wdog;
+
+    // PropertiesChanged seen by the client, in order
+    std::unique_ptr<sdbusplus::bus::match_t> match;
+    std::vector<PropertyMap> changes;
+
+  protected:
+    static constexpr auto TEST_PATH = "/test/path";
+    static constexpr auto TEST_INTERVAL = 10s;
+};
+
+/** @brief Make sure a full IPMI style configuration is signaled once */
+TEST_F(SignalTest, configureEmitsOneSignal)
+{
+    auto intervalMs = milliseconds(TEST_INTERVAL).count();
+    callConfigure(intervalMs, Watchdog::Action::PowerOff,
+                  Watchdog::TimerUse::OSLoad, true, intervalMs / 2);
+    drain();
+
+    ASSERT_EQ(1, changes.size());
+    auto& props = changes[0];
+    EXPECT_EQ(5, props.size());
+    EXPECT_EQ(true, std::get<bool>(props.at("Enabled")));
+    EXPECT_EQ(intervalMs, std::get<uint64_t>(props.at("Interval")));
+    EXPECT_EQ(intervalMs / 2, std::get<uint64_t>(props.at("TimeRemaining")));
+    EXPECT_EQ(convertForMessage(Watchdog::Action::PowerOff),
+              std::get<std::string>(props.at("ExpireAction")));
+    EXPECT_EQ(convertForMessage(Watchdog::TimerUse::OSLoad),
+              std::get<std::string>(props.at("CurrentTimerUse")));
+
+    EXPECT_TRUE(wdog->enabled());
+    EXPECT_TRUE(wdog->timerEnabled());
+}
+
+/** @brief Make sure only what changed is signaled and nothing is signaled
+ *         when nothing changed.
+ */
+TEST_F(SignalTest, configureSignalsOnlyChanges)
+{
+    auto intervalMs = milliseconds(TEST_INTERVAL).count();
+    callConfigure(intervalMs, Watchdog::Action::PowerOff,
+                  Watchdog::TimerUse::OSLoad, false, 0);
+    drain();
+    ASSERT_EQ(1, changes.size());
+    EXPECT_EQ(0, changes[0].count("Enabled"));
+    EXPECT_EQ(0, changes[0].count("TimeRemaining"));
+
+    changes.clear();
+    callConfigure(intervalMs, Watchdog::Action::PowerOff,
+                  Watchdog::TimerUse::OSLoad, false, 0);
+    drain();
+    EXPECT_TRUE(changes.empty());
+}
+
+/** @brief Make sure bad arguments are rejected without side effects */
+TEST_F(SignalTest, configureRejectsBadAction)
+{
+    auto method = clientBus->new_method_call(
+        wdogBus->get_unique_name().c_str(), TEST_PATH, CONTROL_INTERFACE,
+        "Configure");
+    method.append(uint64_t(1000), "NotAnAction",
+                  convertForMessage(Watchdog::TimerUse::OSLoad), true,
+                  uint64_t(0));
+    std::optional<bool> failed;
+    auto slot = method.call_async(
+        [&](auto&& reply) { failed = reply.is_method_error(); });
+    ASSERT_TRUE(runUntil(event, [&] { return failed.has_value(); }));
+    EXPECT_TRUE(*failed);
+
+    drain();
+    EXPECT_TRUE(changes.empty());
+    EXPECT_FALSE(wdog->enabled());
+}
+
+/** @brief Make sure deferred changes made in one loop iteration reach
+ *         clients as a single signal.
+ */
+TEST_F(SignalTest, deferredChangesSignaledOnce)
+{
+    auto reads = wdog->pollStats().timeRemainingReads;
+    wdog->setDeferSignals(true);
+    auto intervalMs = milliseconds(TEST_INTERVAL).count();
+    wdog->interval(intervalMs);
+    wdog->expireAction(Watchdog::Action::PowerCycle);
+    EXPECT_TRUE(wdog->enabled(true));
+    wdog->resetTimeRemaining(false);
+    drain();
+
+    ASSERT_EQ(1, changes.size());
+    auto& props = changes[0];
+    EXPECT_EQ(4, props.size());
+    EXPECT_EQ(true, std::get<bool>(props.at("Enabled")));
+    EXPECT_EQ(intervalMs, std::get<uint64_t>(props.at("Interval")));
+    EXPECT_EQ(intervalMs, std::get<uint64_t>(props.at("TimeRemaining")));
+
+    auto stats = wdog->signalStats();
+    EXPECT_EQ(1, stats.signals);
+    EXPECT_EQ(4, stats.mutations);
+
+    // Filling in the signal is not a client polling TimeRemaining
+    EXPECT_EQ(reads, wdog->pollStats().timeRemainingReads);
+}
+
+/** @brief Make sure clients are told whenever the deadline moves */
+TEST_F(SignalTest, deadlineSignaledOnChange)
+{
+    std::vector<uint64_t> deadlines;
+    namespace rules = sdbusplus::bus::match::rules;
+    sdbusplus::bus::match_t deadlineMatch(
+        *clientBus, rules::propertiesChanged(TEST_PATH, CONTROL_INTERFACE),
+        [&](sdbusplus::message_t& m) {
+            std::string interface;
+            std::map<std::string, std::variant<uint64_t>> properties;
+            m.read(interface, properties);
+            deadlines.push_back(std::get<uint64_t>(properties.at("Deadline")));
+        });
+    auto ping = clientBus->new_method_call("org.freedesktop.DBus",
+                                           "/org/freedesktop/DBus",
+                                           "org.freedesktop.DBus", "GetId");
+    clientBus->call(ping);
+
+    EXPECT_TRUE(wdog->enabled(true));
+    drain();
+    ASSERT_EQ(1, deadlines.size());
+    EXPECT_EQ(wdog->deadline(), deadlines[0]);
+
+    // Reading the property as a client is counted
+    auto method = clientBus->new_method_call(
+        wdogBus->get_unique_name().c_str(), TEST_PATH,
+        "org.freedesktop.DBus.Properties", "Get");
+    method.append(CONTROL_INTERFACE, "Deadline");
+    std::optional<uint64_t> deadline;
+    auto slot = method.call_async([&](auto&& reply) {
+        std::variant<uint64_t> value;
+        reply.read(value);
+        deadline = std::get<uint64_t>(value);
+    });
+    ASSERT_TRUE(runUntil(event, [&] { return deadline.has_value(); }));
+    EXPECT_EQ(deadlines[0], *deadline);
+    EXPECT_EQ(1, wdog->pollStats().deadlineReads);
+
+    // Kicks move the deadline, which clients following it are told about
+    wdog->resetTimeRemaining(false);
+    ASSERT_TRUE(runUntil(event, [&] { return deadlines.size() == 2; }));
+    EXPECT_EQ(wdog->deadline(), deadlines[1]);
+    EXPECT_LT(deadlines[0], deadlines[1]);
+    EXPECT_EQ(2, wdog->pollStats().deadlineSignals);
+
+    // Stopping the timer is signaled as a zero deadline
+    EXPECT_FALSE(wdog->enabled(false));
+    ASSERT_TRUE(runUntil(event, [&] { return deadlines.size() == 3; }));
+    EXPECT_EQ(0, deadlines[2]);
+    EXPECT_EQ(3, wdog->pollStats().deadlineSignals);
+    EXPECT_EQ(1, wdog->pollStats().deadlineReads);
+}
+
+/** @brief Make sure kicking or toggling the timer faster than the signal
+ *         gap is signaled once with the final deadline.
+ */
+TEST_F(SignalTest, deadlineSignalsRateLimited)
+{
+    EXPECT_TRUE(wdog->enabled(true));
+    EXPECT_EQ(1, wdog->pollStats().deadlineSignals);
+    for (int i = 0; i < 10; ++i)
+    {
+        wdog->resetTimeRemaining(false);
+        EXPECT_FALSE(wdog->enabled(false));
+        EXPECT_TRUE(wdog->enabled(true));
+    }
+    EXPECT_FALSE(wdog->enabled(false));
+    EXPECT_EQ(1, wdog->pollStats().deadlineSignals);
+
+    ASSERT_TRUE(
+        runUntil(event, [&] { return wdog->pollStats().deadlineSignals > 1; }));
+    drain();
+    EXPECT_EQ(2, wdog->pollStats().deadlineSignals);
+}
+
+} // namespace watchdog
+} // namespace phosphor
@@ -0,0 +1,206 @@
+#include "state_file.hpp"
+#include "tmp_dir.hpp"
+#include "virtual_timer.hpp"
+#include "watchdog.hpp"
+
+#include <unistd.h>
+
+#include <sdbusplus/bus.hpp>
+#include <sdeventplus/event.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+class StateFileTest : public ::testing::Test
+{
+  public:
+    // Creates a watchdog checkpointing to the file, as a restart would
+    std::unique_ptr<Watchdog> start(
+        std::optional<Watchdog::Fallback>&& fallback = std::nullopt)
+    {
+        auto wdog = std::make_unique<Watchdog>(
+            bus, TEST_PATH, event, clock.makeTimer(),
+            Watchdog::ActionTargetMap(), std::move(fallback));
+        wdog->setStateFile(path, SLACK);
+        return wdog;
+    }
+
+    // Runs the loop until the slack has passed
+    void waitSlack()
+    {
+        runFor(event, duration_cast<milliseconds>(SLACK * 3));
+    }
+
+    sdeventplus::Event event = sdeventplus::Event::get_new();
+    sdbusplus::bus_t bus = sdbusplus::bus::new_default();
+    VirtualClock clock;
+    TmpDir dir{"state"};
+    std::string path = dir.file("state");
+
+  protected:
+    static constexpr auto TEST_PATH = "/test/path";
+    static constexpr auto SLACK = duration_cast<Timer::Duration>(10ms);
+};
+
+/** @brief Make sure a checkpoint reads back as saved */
+TEST_F(StateFileTest, roundTrip)
+{
+    StateFile file(path);
+    EXPECT_FALSE(file.load());
+
+    SavedState state;
+    state.status.enabled = true;
+    state.status.expireAction = StatusAction::PowerCycle;
+    state.status.currentTimerUse = StatusTimerUse::OSLoad;
+    state.status.expiredTimerUse = StatusTimerUse::BIOSPOST;
+    state.status.interval = 30000;
+    state.status.deadline = 123456789;
+    state.slack = 1000;
+    ASSERT_TRUE(file.save(state));
+    EXPECT_NE(0, access((path + ".tmp").c_str(), F_OK));
+
+    auto loaded = file.load();
+    ASSERT_TRUE(loaded);
+    EXPECT_TRUE(loaded->status.enabled);
+    EXPECT_EQ(StatusAction::PowerCycle, loaded->status.expireAction);
+    EXPECT_EQ(StatusTimerUse::OSLoad, loaded->status.currentTimerUse);
+    EXPECT_EQ(StatusTimerUse::BIOSPOST, loaded->status.expiredTimerUse);
+    EXPECT_EQ(30000, loaded->status.interval);
+    EXPECT_EQ(123456789, loaded->status.deadline);
+    EXPECT_EQ(1000, loaded->slack);
+}
+
+/** @brief Make sure anything but a whole valid record is ignored */
+TEST_F(StateFileTest, rejectsInvalid)
+{
+    StateFile file(path);
+    ASSERT_TRUE(file.save(SavedState{}));
+
+    std::string record;
+    {
+        std::ifstream in(path, std::ios::binary);
+        record.assign(std::istreambuf_iterator<char>(in), {});
+    }
+
+    auto write = [&](const std::string& data) {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << data;
+    };
+    write(record.substr(0, record.size() - 1));
+    EXPECT_FALSE(file.load());
+
+    auto bad = record;
+    bad[0] ^= 0xff;
+    write(bad);
+    EXPECT_FALSE(file.load());
+
+    // ExpireAction past the last known code
+    bad = record;
+    bad[12] = 9;
+    write(bad);
+    EXPECT_FALSE(file.load());
+}
+
+/** @brief Make sure a restarted watchdog carries on with the countdown */
+TEST_F(StateFileTest, resumesCountdown)
+{
+    auto wdog = start();
+    wdog->interval(milliseconds(10s).count());
+    wdog->expireAction(Watchdog::Action::PowerOff);
+    wdog->currentTimerUse(Watchdog::TimerUse::SMSOS);
+    wdog->enabled(true);
+    clock.advance(3s);
+    wdog.reset();
+
+    // Time passes while the daemon is down
+    clock.advance(2s);
+    wdog = start();
+    EXPECT_TRUE(wdog->enabled());
+    EXPECT_EQ(10000, wdog->interval());
+    EXPECT_EQ(Watchdog::Action::PowerOff, wdog->expireAction());
+    EXPECT_EQ(Watchdog::TimerUse::SMSOS, wdog->currentTimerUse());
+    EXPECT_EQ(5000 + milliseconds(SLACK).count(), wdog->timeRemaining());
+
+    clock.advance(5s + SLACK);
+    EXPECT_TRUE(wdog->timerExpired());
+    EXPECT_FALSE(wdog->enabled());
+}
+
+/** @brief Make sure kicks are only saved once the slack has passed */
+TEST_F(StateFileTest, kicksSavedLater)
+{
+    StateFile file(path);
+    auto wdog = start();
+    wdog->interval(milliseconds(10s).count());
+    wdog->enabled(true);
+    auto armed = file.load();
+    ASSERT_TRUE(armed);
+    EXPECT_EQ(wdog->deadline(), armed->status.deadline);
+
+    clock.advance(4s);
+    wdog->resetTimeRemaining(false);
+    EXPECT_EQ(armed->status.deadline, file.load()->status.deadline);
+
+    waitSlack();
+    EXPECT_EQ(wdog->deadline(), file.load()->status.deadline);
+    EXPECT_EQ(armed->status.deadline + 4000000,
+              file.load()->status.deadline);
+
+    // Configuration is saved straight away
+    wdog->interval(milliseconds(20s).count());
+    EXPECT_EQ(20000, file.load()->status.interval);
+}
+
+/** @brief Make sure a countdown that ran out while down expires */
+TEST_F(StateFileTest, overdueExpiresOnResume)
+{
+    auto wdog = start();
+    wdog->interval(milliseconds(1s).count());
+    wdog->enabled(true);
+    wdog.reset();
+
+    clock.advance(5s);
+    wdog = start();
+    EXPECT_TRUE(wdog->enabled());
+    EXPECT_GE(1, wdog->timeRemaining());
+    clock.advance(1ms);
+    EXPECT_TRUE(wdog->timerExpired());
+}
+
+/** @brief Make sure a disabled watchdog resumes into its fallback */
+TEST_F(StateFileTest, resumesFallback)
+{
+    Watchdog::Fallback fallback;
+    fallback.action = Watchdog::Action::PowerOff;
+    fallback.interval = milliseconds(60s).count();
+
+    auto wdog = start(Watchdog::Fallback(fallback));
+    wdog->interval(milliseconds(10s).count());
+    wdog->enabled(true);
+    clock.advance(10s);
+    EXPECT_FALSE(wdog->enabled());
+    EXPECT_TRUE(wdog->timerEnabled());
+    clock.advance(20s);
+    wdog.reset();
+
+    wdog = start(Watchdog::Fallback(fallback));
+    EXPECT_FALSE(wdog->enabled());
+    EXPECT_TRUE(wdog->timerEnabled());
+    EXPECT_EQ(40000 + milliseconds(SLACK).count(), wdog->timeRemaining());
+}
+
+} // namespace watchdog
+} // namespace phosphor
@@ -0,0 +1,167 @@
+#include "status_page.hpp"
+#include "status_writer.hpp"
+#include "tmp_dir.hpp"
+#include "virtual_timer.hpp"
+#include "watchdog.hpp"
+
+#include <unistd.h>
+
+#include <sdbusplus/bus.hpp>
+#include <sdeventplus/event.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+class StatusPageTest : public ::testing::Test
+{
+  public:
+    TmpDir dir{"status"};
+    std::string path = dir.file("status");
+};
+
+/** @brief Make sure the page follows the watchdog through its states */
+TEST_F(StatusPageTest, followsWatchdog)
+{
+    auto event = sdeventplus::Event::get_default();
+    auto bus = sdbusplus::bus::new_default();
+    VirtualClock clock;
+    Watchdog wdog(bus, "/test/path", event, clock.makeTimer());
+    wdog.interval(milliseconds(3s).count());
+
+    StatusWriter writer(path);
+    writer.update(statusOf(wdog));
+    wdog.setStateCallback([&] { writer.update(statusOf(wdog)); });
+    StatusReader reader(path.c_str());
+
+    auto status = reader.read();
+    ASSERT_TRUE(status);
+    EXPECT_FALSE(status->enabled);
+    EXPECT_EQ(3000, status->interval);
+    EXPECT_EQ(0, status->deadline);
+
+    wdog.expireAction(Watchdog::Action::PowerCycle);
+    wdog.currentTimerUse(Watchdog::TimerUse::OSLoad);
+    EXPECT_TRUE(wdog.enabled(true));
+    status = reader.read();
+    ASSERT_TRUE(status);
+    EXPECT_TRUE(status->enabled);
+    EXPECT_EQ(StatusAction::PowerCycle, status->expireAction);
+    EXPECT_EQ(StatusTimerUse::OSLoad, status->currentTimerUse);
+    EXPECT_EQ(wdog.deadline(), status->deadline);
+    EXPECT_NE(0, status->deadline);
+
+    // Expiring records the timer use and stops the countdown
+    clock.advance(3s);
+    status = reader.read();
+    ASSERT_TRUE(status);
+    EXPECT_FALSE(status->enabled);
+    EXPECT_EQ(StatusTimerUse::OSLoad, status->expiredTimerUse);
+    EXPECT_EQ(0, status->deadline);
+    EXPECT_EQ(0, status->timeRemaining());
+}
+
+/** @brief Make sure a missing page is refused and the page goes away
+ *         with its writer.
+ */
+TEST_F(StatusPageTest, pageLifetime)
+{
+    EXPECT_THROW(StatusReader(path.c_str()), std::system_error);
+    {
+        StatusWriter writer(path);
+    }
+    EXPECT_NE(0, access(path.c_str(), F_OK));
+}
+
+/** @brief Hammer the page with updates while several readers check that
+ *         every snapshot they get is self consistent.
+ */
+TEST_F(StatusPageTest, concurrentReadsAreConsistent)
+{
+    constexpr uint64_t updates = 200000;
+    constexpr uint64_t deadlineMask = 0x5a5a5a5a5a5a5a5a;
+
+    auto make = [&](uint64_t i) {
+        StatusSnapshot status;
+        status.enabled = i & 1;
+        status.expireAction = static_cast<StatusAction>(i % 4);
+        status.currentTimerUse = static_cast<StatusTimerUse>(i % 6);
+        status.expiredTimerUse = static_cast<StatusTimerUse>((i + 1) % 6);
+        // Both halves carry the counter so torn values stand out
+        status.interval = (i << 32) | i;
+        status.deadline = status.interval ^ deadlineMask;
+        return status;
+    };
+
+    StatusWriter writer(path);
+    writer.update(make(0));
+
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> reads{0};
+    std::atomic<uint64_t> torn{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r)
+    {
+        readers.emplace_back([&] {
+            StatusReader reader(path.c_str());
+            uint64_t last = 0;
+            while (!done.load(std::memory_order_relaxed))
+            {
+                auto status = reader.read(1);
+                if (!status)
+                {
+                    continue;
+                }
+                uint64_t i = status->interval & 0xffffffff;
+                auto expected = make(i);
+                if (status->interval != expected.interval ||
+                    status->deadline != expected.deadline ||
+                    status->enabled != expected.enabled ||
+                    status->expireAction != expected.expireAction ||
+                    status->currentTimerUse != expected.currentTimerUse ||
+                    status->expiredTimerUse != expected.expiredTimerUse ||
+                    i < last)
+                {
+                    torn++;
+                }
+                last = i;
+                reads++;
+            }
+        });
+    }
+
+    for (uint64_t i = 1; i <= updates; ++i)
+    {
+        writer.update(make(i));
+    }
+    // Give the readers a chance at the final state
+    while (reads.load() < 1000)
+    {
+        std::this_thread::yield();
+    }
+    done = true;
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+
+    EXPECT_EQ(0, torn.load());
+    EXPECT_LE(1000, reads.load());
+}
+
+} // namespace watchdog
+} // namespace phosphor
@@ -0,0 +1,229 @@
+#include "timer_mux.hpp"
+#include "virtual_timer.hpp"
+
+#include <chrono>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+class TimerMuxTest : public ::testing::Test
+{
+  public:
+    TimerMuxTest() : mux(clock.makeTimer()) {}
+
+    // Stands for the underlying timer not being programmed
+    static constexpr auto NOT_ARMED = Timer::Duration::max();
+
+    // Time the underlying timer is programmed to go off in
+    Timer::Duration armedIn() const
+    {
+        auto armed = mux.armedAt();
+        if (!armed)
+        {
+            return NOT_ARMED;
+        }
+        return duration_cast<Timer::Duration>(*armed - clock.now());
+    }
+
+    // Simulated time driving the mux
+    VirtualClock clock;
+
+    // Mux under test
+    TimerMux mux;
+};
+
+/** @brief Make sure a single countdown expires after its interval and
+ *         keeps running with the same period.
+ */
+TEST_F(TimerMuxTest, expiresAfterInterval)
+{
+    auto timer = mux.makeTimer();
+    size_t expirations = 0;
+    timer->setCallback([&] { expirations++; });
+    EXPECT_FALSE(timer->isEnabled());
+    EXPECT_EQ(NOT_ARMED, armedIn());
+
+    timer->restart(3s);
+    EXPECT_TRUE(timer->isEnabled());
+    EXPECT_EQ(Timer::Duration(3s), armedIn());
+
+    EXPECT_EQ(0, clock.advance(2s));
+    EXPECT_EQ(1, clock.advance(1s));
+    EXPECT_EQ(1, expirations);
+    EXPECT_TRUE(timer->hasExpired());
+    EXPECT_TRUE(timer->isEnabled());
+    EXPECT_EQ(Timer::Duration(3s), timer->getRemaining());
+    EXPECT_EQ(Timer::Duration(3s), armedIn());
+}
+
+/** @brief Make sure only the earliest deadline is programmed and every
+ *         countdown expires in order.
+ */
+TEST_F(TimerMuxTest, programsEarliest)
+{
+    std::vector<int> order;
+    std::vector<std::unique_ptr<Timer>> timers;
+    timers.reserve(3);
+    for (int i = 0; i < 3; ++i)
+    {
+        auto& timer = timers.emplace_back(mux.makeTimer());
+        timer->setCallback([&order, &timer, i] {
+            order.push_back(i);
+            timer->setEnabled(false);
+        });
+    }
+
+    timers[0]->restart(5s);
+    timers[1]->restart(2s);
+    timers[2]->restart(8s);
+    EXPECT_EQ(Timer::Duration(2s), armedIn());
+
+    // Pushing a later deadline out leaves the programmed one alone
+    timers[2]->setRemaining(10s);
+    EXPECT_EQ(Timer::Duration(2s), armedIn());
+
+    // Disabling the earliest moves on to the next one
+    timers[1]->setEnabled(false);
+    EXPECT_EQ(Timer::Duration(5s), armedIn());
+    timers[1]->setEnabled(true);
+    EXPECT_EQ(Timer::Duration(2s), armedIn());
+
+    EXPECT_EQ(3, clock.advance(10s));
+    EXPECT_EQ((std::vector<int>{1, 0, 2}), order);
+    EXPECT_EQ(NOT_ARMED, armedIn());
+}
+
+/** @brief Make sure countdowns due at once all expire on one wake up */
+TEST_F(TimerMuxTest, expiresTogether)
+{
+    auto a = mux.makeTimer();
+    auto b = mux.makeTimer();
+    size_t expirations = 0;
+    a->setCallback([&] { expirations++; });
+    b->setCallback([&] { expirations++; });
+    a->restart(1s);
+    b->restart(1s);
+
+    EXPECT_EQ(1, clock.advance(1s));
+    EXPECT_EQ(2, expirations);
+}
+
+/** @brief Make sure a countdown going away no longer holds the timer */
+TEST_F(TimerMuxTest, destroyedTimerReleased)
+{
+    auto a = mux.makeTimer();
+    auto b = mux.makeTimer();
+    a->restart(1s);
+    b->restart(4s);
+    EXPECT_EQ(Timer::Duration(1s), armedIn());
+
+    a.reset();
+    EXPECT_EQ(Timer::Duration(4s), armedIn());
+    b.reset();
+    EXPECT_EQ(NOT_ARMED, armedIn());
+    EXPECT_EQ(0, clock.advance(5s));
+}
+
+/** @class StalledTimer
+ *  @brief Timer that goes off without getting its callback dispatched,
+ *         like a timer detecting expiries off of a stalled event loop.
+ */
+class StalledTimer : public Timer
+{
+  public:
+    explicit StalledTimer(VirtualClock& clock) : clock(clock) {}
+
+    TimePoint now() const override
+    {
+        return clock.now();
+    }
+    void setCallback(Callback&& callback) override
+    {
+        this->callback = std::move(callback);
+    }
+    bool hasExpired() const override
+    {
+        return expired || (enabled && deadline <= clock.now());
+    }
+    bool isEnabled() const override
+    {
+        return enabled;
+    }
+    void setEnabled(bool enabled) override
+    {
+        this->enabled = enabled;
+    }
+    Duration getRemaining() const override
+    {
+        return duration_cast<Duration>(deadline - clock.now());
+    }
+    void setRemaining(Duration remaining) override
+    {
+        deadline = clock.now() + remaining;
+    }
+    void restart(Duration interval) override
+    {
+        expired = false;
+        setRemaining(interval);
+        enabled = true;
+    }
+
+    // Runs the callback once the event loop comes back
+    void dispatch()
+    {
+        expired = hasExpired();
+        callback();
+    }
+
+  private:
+    VirtualClock& clock;
+    Callback callback;
+    TimePoint deadline;
+    bool enabled = false;
+    bool expired = false;
+};
+
+/** @brief Make sure the countdown the timer goes off for reports it before
+ *         the expiry is dispatched, and only that countdown does.
+ */
+TEST(TimerMuxStalledTest, expiredBeforeDispatch)
+{
+    VirtualClock clock;
+    auto stalled = std::make_unique<StalledTimer>(clock);
+    auto& base = *stalled;
+    TimerMux mux(std::move(stalled));
+    auto first = mux.makeTimer();
+    auto later = mux.makeTimer();
+    size_t expirations = 0;
+    first->setCallback([&] { expirations++; });
+    first->restart(1s);
+    later->restart(5s);
+
+    clock.advance(2s);
+    EXPECT_TRUE(first->hasExpired());
+    EXPECT_TRUE(first->isEnabled());
+    EXPECT_FALSE(later->hasExpired());
+    EXPECT_EQ(0, expirations);
+
+    base.dispatch();
+    EXPECT_EQ(1, expirations);
+    EXPECT_TRUE(first->hasExpired());
+    EXPECT_FALSE(later->hasExpired());
+
+    // Kicking the countdown clears it like restarting any other timer
+    first->restart(10s);
+    EXPECT_FALSE(first->hasExpired());
+}
+
+} // namespace watchdog
+} // namespace phosphor
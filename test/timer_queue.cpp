@@ -0,0 +1,209 @@
+#include "timer_queue.hpp"
+
+#include <sdeventplus/event.hpp>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+class TimerQueueTest : public ::testing::Test
+{
+  public:
+    // The unit time used to measure the timer
+    // This should be large enough to accommodate drift
+    using Quantum = duration<uint64_t, std::deci>;
+
+    TimerQueueTest() : event(sdeventplus::Event::get_new()), queue(event) {}
+
+    // sdevent Event handle
+    sdeventplus::Event event;
+
+    // Queue under test
+    TimerQueue queue;
+
+  protected:
+    // Runs the event loop until the timer expires or the time limit is
+    // reached. Returns the number of whole quantums waited.
+    Quantum waitForTimer(Timer& timer, Quantum timeLimit)
+    {
+        auto ret = Quantum(0);
+        while (ret < timeLimit && !timer.hasExpired())
+        {
+            constexpr auto sleepTime = Quantum(1);
+            if (event.run(sleepTime) == 0)
+            {
+                ret += sleepTime;
+            }
+        }
+        return ret;
+    }
+};
+
+/** @brief Make sure a single timer expires after its interval and keeps
+ *         running with the same period.
+ */
+TEST_F(TimerQueueTest, expiresAfterInterval)
+{
+    QueuedTimer timer(queue);
+    size_t expirations = 0;
+    timer.setCallback([&] { expirations++; });
+    EXPECT_FALSE(timer.isEnabled());
+    EXPECT_FALSE(timer.hasExpired());
+
+    timer.restart(Quantum(3));
+    EXPECT_TRUE(timer.isEnabled());
+    EXPECT_LE(Quantum(2), timer.getRemaining());
+    EXPECT_GE(Quantum(3), timer.getRemaining());
+
+    EXPECT_EQ(Quantum(2), waitForTimer(timer, Quantum(5)));
+    EXPECT_EQ(1, expirations);
+    EXPECT_TRUE(timer.hasExpired());
+    EXPECT_TRUE(timer.isEnabled());
+    EXPECT_LE(Quantum(2), timer.getRemaining());
+}
+
+/** @brief Make sure kicking a timer delays its expiration without
+ *         growing the queue.
+ */
+TEST_F(TimerQueueTest, kickDelaysExpiration)
+{
+    QueuedTimer timer(queue);
+    timer.restart(Quantum(2));
+    EXPECT_EQ(1, queue.size());
+
+    EXPECT_EQ(0, event.run(Quantum(1)));
+    for (int i = 0; i < 100; ++i)
+    {
+        timer.setRemaining(Quantum(2));
+    }
+    EXPECT_EQ(1, queue.size());
+
+    // The original deadline passes and is re-queued at the kicked one
+    EXPECT_LT(0, event.run(Quantum(2)));
+    EXPECT_FALSE(timer.hasExpired());
+    EXPECT_EQ(1, queue.size());
+    EXPECT_GE(Quantum(1), timer.getRemaining());
+
+    EXPECT_LT(0, event.run(Quantum(2)));
+    EXPECT_TRUE(timer.hasExpired());
+}
+
+/** @brief Make sure shortening a deadline takes effect immediately */
+TEST_F(TimerQueueTest, shortenDeadline)
+{
+    QueuedTimer timer(queue);
+    timer.restart(Quantum(10));
+    timer.setRemaining(Quantum(2));
+    EXPECT_EQ(Quantum(1), waitForTimer(timer, Quantum(10)));
+    EXPECT_TRUE(timer.hasExpired());
+}
+
+/** @brief Make sure a deadline moved up by a callback is programmed
+ *         once the dispatch is done.
+ */
+TEST_F(TimerQueueTest, callbackShortensDeadline)
+{
+    QueuedTimer first(queue);
+    QueuedTimer second(queue);
+    first.setCallback([&] {
+        first.setEnabled(false);
+        second.setRemaining(Quantum(1));
+    });
+    first.restart(Quantum(2));
+    second.restart(Quantum(10));
+
+    EXPECT_EQ(Quantum(1), waitForTimer(first, Quantum(5)));
+    EXPECT_GE(Quantum(1), waitForTimer(second, Quantum(5)));
+    EXPECT_TRUE(second.hasExpired());
+}
+
+/** @brief Make sure timers expire in deadline order */
+TEST_F(TimerQueueTest, expireInOrder)
+{
+    std::vector<int> order;
+    std::vector<std::unique_ptr<QueuedTimer>> timers;
+    for (int i = 0; i < 3; ++i)
+    {
+        auto& timer = timers.emplace_back(
+            std::make_unique<QueuedTimer>(queue));
+        timer->setCallback([&, i] {
+            order.push_back(i);
+            timers[i]->setEnabled(false);
+        });
+    }
+    timers[0]->restart(Quantum(3));
+    timers[1]->restart(Quantum(1));
+    timers[2]->restart(Quantum(2));
+
+    while (order.size() < timers.size())
+    {
+        event.run(Quantum(1));
+    }
+    EXPECT_EQ((std::vector<int>{1, 2, 0}), order);
+}
+
+/** @brief Make sure disabled and destroyed timers never fire */
+TEST_F(TimerQueueTest, disableAndDestroy)
+{
+    size_t expirations = 0;
+    QueuedTimer disabled(queue);
+    disabled.setCallback([&] { expirations++; });
+    disabled.restart(Quantum(1));
+    disabled.setEnabled(false);
+
+    auto destroyed = std::make_unique<QueuedTimer>(queue);
+    destroyed->setCallback([&] { expirations++; });
+    destroyed->restart(Quantum(1));
+    destroyed.reset();
+
+    QueuedTimer witness(queue);
+    witness.restart(Quantum(2));
+    while (!witness.hasExpired())
+    {
+        event.run(Quantum(1));
+    }
+    EXPECT_EQ(0, expirations);
+    EXPECT_FALSE(disabled.hasExpired());
+}
+
+/** @brief Make sure toggling timers and pulling their deadlines in does
+ *         not pile stale entries up in the queue.
+ */
+TEST_F(TimerQueueTest, staleEntriesCompacted)
+{
+    QueuedTimer toggled(queue);
+    QueuedTimer shortened(queue);
+    toggled.restart(60s);
+    shortened.restart(60s);
+    for (int i = 0; i < 100; ++i)
+    {
+        toggled.setEnabled(false);
+        toggled.setEnabled(true);
+        shortened.setRemaining(seconds(59 - i % 10));
+    }
+    EXPECT_GE(4, queue.size());
+
+    // Whatever is still live keeps working
+    shortened.setRemaining(Quantum(1));
+    EXPECT_GE(Quantum(2), waitForTimer(shortened, Quantum(5)));
+    EXPECT_TRUE(shortened.hasExpired());
+    EXPECT_FALSE(toggled.hasExpired());
+
+    // Disabling everything leaves nothing behind once compacted
+    toggled.setEnabled(false);
+    shortened.setEnabled(false);
+    EXPECT_EQ(0, queue.size());
+}
+
+} // namespace watchdog
+} // namespace phosphor
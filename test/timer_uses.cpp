@@ -0,0 +1,137 @@
+#include "timer_uses.hpp"
+#include "virtual_timer.hpp"
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+class TimerUsesTest : public ::testing::Test
+{
+  public:
+    using TimerUse = TimerUses::TimerUse;
+    using Action = TimerUses::Action;
+
+    TimerUsesTest() :
+        uses(clock.makeTimer(),
+             [this](TimerUse timerUse, uint64_t interval, Action action) {
+                 expired.push_back({timerUse, interval, action});
+             })
+    {}
+
+    // Monotonic microseconds of a time on the simulated clock
+    uint64_t toUs(Timer::TimePoint when) const
+    {
+        return duration_cast<microseconds>(when.time_since_epoch()).count();
+    }
+
+    // What the expiry callback was called with
+    struct Expiry
+    {
+        TimerUse timerUse;
+        uint64_t interval;
+        Action action;
+    };
+
+    // Simulated time driving the countdowns
+    VirtualClock clock;
+
+    // Expiries in the order they were reported
+    std::vector<Expiry> expired;
+
+    // Countdowns under test
+    TimerUses uses;
+};
+
+/** @brief Make sure a countdown runs out once and reports what it was
+ *         started with.
+ */
+TEST_F(TimerUsesTest, expiresOnce)
+{
+    uses.start(TimerUse::OSLoad, 3000, Action::PowerOff, 3s);
+    EXPECT_TRUE(uses.running(TimerUse::OSLoad));
+    EXPECT_FALSE(uses.running(TimerUse::OEM));
+    EXPECT_EQ(toUs(clock.now() + 3s), uses.deadline(TimerUse::OSLoad));
+    EXPECT_EQ(0, uses.deadline(TimerUse::OEM));
+
+    EXPECT_EQ(1, clock.advance(3s));
+    ASSERT_EQ(1, expired.size());
+    EXPECT_EQ(TimerUse::OSLoad, expired[0].timerUse);
+    EXPECT_EQ(3000, expired[0].interval);
+    EXPECT_EQ(Action::PowerOff, expired[0].action);
+    EXPECT_FALSE(uses.running(TimerUse::OSLoad));
+    EXPECT_FALSE(uses.mux().armedAt());
+    EXPECT_EQ(0, clock.advance(10s));
+}
+
+/** @brief Make sure a kick restarts from the interval rather than what
+ *         was left when started.
+ */
+TEST_F(TimerUsesTest, resetRestartsFromInterval)
+{
+    EXPECT_FALSE(uses.reset(TimerUse::SMSOS));
+
+    uses.start(TimerUse::SMSOS, 5000, Action::None, 1s);
+    EXPECT_EQ(0, clock.advance(500ms));
+    EXPECT_TRUE(uses.reset(TimerUse::SMSOS));
+    EXPECT_EQ(toUs(clock.now() + 5s), uses.deadline(TimerUse::SMSOS));
+    EXPECT_EQ(0, clock.advance(4s));
+    EXPECT_EQ(1, clock.advance(1s));
+}
+
+/** @brief Make sure the earliest deadline follows the countdowns as they
+ *         start, stop and are taken.
+ */
+TEST_F(TimerUsesTest, earliestFollowsCountdowns)
+{
+    EXPECT_EQ(0, uses.earliest());
+
+    uses.start(TimerUse::BIOSFRB2, 4000, Action::HardReset, 4s);
+    uses.start(TimerUse::BIOSPOST, 2000, Action::PowerCycle, 2s);
+    EXPECT_EQ(uses.deadline(TimerUse::BIOSPOST), uses.earliest());
+
+    clock.advance(500ms);
+    auto taken = uses.take(TimerUse::BIOSPOST);
+    EXPECT_EQ(2000, taken.interval);
+    EXPECT_EQ(Action::PowerCycle, taken.action);
+    EXPECT_EQ(Timer::Duration(1500ms), taken.remaining);
+    EXPECT_FALSE(uses.running(TimerUse::BIOSPOST));
+    EXPECT_EQ(uses.deadline(TimerUse::BIOSFRB2), uses.earliest());
+
+    uses.stop(TimerUse::BIOSFRB2);
+    EXPECT_EQ(0, uses.earliest());
+    EXPECT_EQ(0, clock.advance(10s));
+    EXPECT_TRUE(expired.empty());
+}
+
+/** @brief Make sure a countdown made outside of the timer uses shares
+ *         the mux with them.
+ */
+TEST_F(TimerUsesTest, sharesMux)
+{
+    auto other = uses.makeTimer();
+    size_t otherExpired = 0;
+    other->setCallback([&] { otherExpired++; });
+    other->restart(1s);
+    uses.start(TimerUse::OEM, 2000, Action::None, 2s);
+    ASSERT_TRUE(uses.mux().armedAt());
+    EXPECT_EQ(clock.now() + 1s, *uses.mux().armedAt());
+
+    other->setEnabled(false);
+    EXPECT_EQ(clock.now() + 2s, *uses.mux().armedAt());
+    EXPECT_EQ(1, clock.advance(2s));
+    EXPECT_EQ(0, otherExpired);
+    EXPECT_EQ(1, expired.size());
+}
+
+} // namespace watchdog
+} // namespace phosphor
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <stdlib.h>
+
+#include <sdeventplus/event.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <system_error>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+/** @class TmpDir
+ *  @brief Temporary directory removed along with whatever is left in it.
+ */
+class TmpDir
+{
+  public:
+    /** @brief Creates /tmp/watchdog-<name>-XXXXXX
+     *
+     *  @param[in] name - tells the directories of the tests apart
+     */
+    explicit TmpDir(const std::string& name)
+    {
+        std::string dir = "/tmp/watchdog-" + name + "-XXXXXX";
+        if (mkdtemp(dir.data()) != nullptr)
+        {
+            path = dir;
+        }
+    }
+
+    ~TmpDir()
+    {
+        if (!path.empty())
+        {
+            std::error_code ec;
+            std::filesystem::remove_all(path, ec);
+        }
+    }
+
+    TmpDir(const TmpDir&) = delete;
+    TmpDir& operator=(const TmpDir&) = delete;
+
+    /** @brief Was the directory created */
+    bool created() const
+    {
+        return !path.empty();
+    }
+
+    /** @brief Path of a file in the directory, created empty if asked to */
+    std::string file(const std::string& name, bool create = false) const
+    {
+        auto file = path + "/" + name;
+        if (create)
+        {
+            std::ofstream(file).flush();
+        }
+        return file;
+    }
+
+    /** @brief Contents of a file */
+    static std::string read(const std::string& file)
+    {
+        std::ifstream in(file);
+        return std::string(std::istreambuf_iterator<char>(in), {});
+    }
+
+    /** @brief Path of the directory, empty if it could not be created */
+    std::string path;
+};
+
+/** @brief Runs the event loop for a while, dispatching whatever is due */
+inline void runFor(sdeventplus::Event& event,
+                   std::chrono::milliseconds duration)
+{
+    using namespace std::chrono_literals;
+    auto end = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < end)
+    {
+        event.run(1ms);
+    }
+}
+
+} // namespace watchdog
+} // namespace phosphor
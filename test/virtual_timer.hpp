@@ -0,0 +1,185 @@
+#pragma once
+
+#include "timer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace phosphor
+{
+namespace watchdog
+{
+
+class VirtualTimer;
+
+/** @class VirtualClock
+ *  @brief Simulated monotonic clock that only moves when told to.
+ *  @details Timers created from the clock expire synchronously, in
+ *  deadline order, from inside of advance().
+ */
+class VirtualClock
+{
+  public:
+    using Duration = Timer::Duration;
+    using TimePoint = Timer::TimePoint;
+
+    /** @brief Gets the current simulated time */
+    TimePoint now() const
+    {
+        return current;
+    }
+
+    /** @brief Creates a timer driven by this clock */
+    std::unique_ptr<Timer> makeTimer();
+
+    /** @brief Moves time forward, expiring every timer due on the way
+     *
+     *  @return the number of timer expirations
+     */
+    size_t advance(Duration duration);
+
+  private:
+    friend class VirtualTimer;
+
+    /** @brief Start away from 0 to catch anyone assuming an epoch */
+    TimePoint current = TimePoint(std::chrono::hours(1));
+
+    /** @brief Every live timer created from this clock */
+    std::vector<VirtualTimer*> timers;
+};
+
+/** @class VirtualTimer
+ *  @brief Timer following the sdeventplus semantics on a VirtualClock.
+ */
+class VirtualTimer : public Timer
+{
+  public:
+    explicit VirtualTimer(VirtualClock& clock) : clock(clock)
+    {
+        clock.timers.push_back(this);
+    }
+
+    ~VirtualTimer() override
+    {
+        std::erase(clock.timers, this);
+    }
+
+    VirtualTimer(const VirtualTimer&) = delete;
+    VirtualTimer& operator=(const VirtualTimer&) = delete;
+
+    TimePoint now() const override
+    {
+        return clock.now();
+    }
+
+    void setCallback(Callback&& callback) override
+    {
+        this->callback = std::move(callback);
+    }
+
+    bool hasExpired() const override
+    {
+        return expired;
+    }
+
+    bool isEnabled() const override
+    {
+        return enabled;
+    }
+
+    void setEnabled(bool enabled) override
+    {
+        this->enabled = enabled;
+    }
+
+    Duration getRemaining() const override
+    {
+        auto now = clock.now();
+        if (deadline <= now)
+        {
+            return Duration(0);
+        }
+        return std::chrono::duration_cast<Duration>(deadline - now);
+    }
+
+    void setRemaining(Duration remaining) override
+    {
+        deadline = clock.now() + remaining;
+    }
+
+    void restart(Duration interval) override
+    {
+        expired = false;
+        this->interval = interval;
+        setRemaining(interval);
+        enabled = true;
+    }
+
+  private:
+    friend class VirtualClock;
+
+    VirtualClock& clock;
+    Callback callback;
+    std::optional<Duration> interval;
+    TimePoint deadline;
+    bool enabled = false;
+    bool expired = false;
+
+    /** @brief Expires the timer at the current time */
+    void expire()
+    {
+        expired = true;
+        if (interval)
+        {
+            setRemaining(*interval);
+        }
+        else
+        {
+            enabled = false;
+        }
+        if (callback)
+        {
+            callback();
+        }
+    }
+};
+
+inline std::unique_ptr<Timer> VirtualClock::makeTimer()
+{
+    return std::make_unique<VirtualTimer>(*this);
+}
+
+inline size_t VirtualClock::advance(Duration duration)
+{
+    auto end = current + duration;
+    size_t expirations = 0;
+    while (true)
+    {
+        VirtualTimer* next = nullptr;
+        for (auto* timer : timers)
+        {
+            if (timer->enabled && timer->deadline <= end &&
+                (next == nullptr || timer->deadline < next->deadline))
+            {
+                next = timer;
+            }
+        }
+        if (next == nullptr)
+        {
+            break;
+        }
+
+        current = std::max(current, next->deadline);
+        next->expire();
+        expirations++;
+    }
+    current = end;
+    return expirations;
+}
+
+} // namespace watchdog
+} // namespace phosphor
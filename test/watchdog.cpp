@@ -1,11 +1,14 @@
+#include "virtual_timer.hpp"
 #include "watchdog.hpp"
 
 #include <sdbusplus/bus.hpp>
 #include <sdeventplus/event.hpp>
 
+#include <algorithm>
 #include <chrono>
 #include <memory>
-#include <thread>
+#include <optional>
+#include <random>
 #include <utility>
 
 #include <gtest/gtest.h>
@@ -33,7 +36,8 @@ class WdogTest : public ::testing::Test
         event(sdeventplus::Event::get_default()),
         bus(sdbusplus::bus::new_default()),
         wdog(std::make_unique<Watchdog>(
-            bus, TEST_PATH, event, Watchdog::ActionTargetMap(), std::nullopt,
+            bus, TEST_PATH, event, clock.makeTimer(),
+            Watchdog::ActionTargetMap(), std::nullopt,
             milliseconds(TEST_MIN_INTERVAL).count())),
 
         defaultInterval(Quantum(3))
@@ -50,6 +54,9 @@ class WdogTest : public ::testing::Test
     // sdbusplus handle
     sdbusplus::bus_t bus;
 
+    // Simulated time driving the watchdog timer
+    VirtualClock clock;
+
     // Watchdog object
     std::unique_ptr<Watchdog> wdog;
 
@@ -75,7 +82,7 @@ class WdogTest : public ::testing::Test
             previousTimeRemaining = wdog->timeRemaining();
 
             constexpr auto sleepTime = Quantum(1);
-            if (event.run(sleepTime) == 0)
+            if (clock.advance(sleepTime) == 0)
             {
                 ret += sleepTime;
             }
@@ -162,7 +169,7 @@ TEST_F(WdogTest, enableWdogAndWait5Quantums)
     // Sleep for 5 quantums
     auto sleepTime = Quantum(2);
     ASSERT_LT(sleepTime, defaultInterval);
-    std::this_thread::sleep_for(sleepTime);
+    clock.advance(sleepTime);
 
     // Get the remaining time again and expectation is that we get fewer
     auto remaining = milliseconds(wdog->timeRemaining());
@@ -186,7 +193,7 @@ TEST_F(WdogTest, enableWdogAndResetTo5Quantums)
     EXPECT_TRUE(wdog->enabled(true));
 
     // Sleep for 1 second
-    std::this_thread::sleep_for(Quantum(1));
+    clock.advance(Quantum(1));
 
     // Timer should still be running unexpired
     EXPECT_FALSE(wdog->timerExpired());
@@ -242,6 +249,55 @@ TEST_F(WdogTest, verifyIntervalUpdateRunning)
     EXPECT_LE(newInterval - Quantum(1), remaining);
 }
 
+/** @brief Make sure kicks inside of the coalescing window are absorbed
+ *         and only extend the timer once it fires.
+ */
+TEST_F(WdogTest, coalescedKicksExtendDeadline)
+{
+    wdog->setKickCoalesceWindow(milliseconds(Quantum(10)));
+    EXPECT_TRUE(wdog->enabled(true));
+
+    // The first kick is applied immediately
+    wdog->kick();
+
+    // Kicking again inside of the window leaves the timer alone
+    const auto& metrics = wdog->metrics();
+    auto kicks = metrics.kicks.get();
+    auto marginSum = metrics.kickMargin.sum();
+    EXPECT_EQ(0, clock.advance(Quantum(1)));
+    wdog->kick();
+    EXPECT_EQ(defaultInterval - Quantum(1),
+              milliseconds(wdog->timeRemaining()));
+
+    // Readers of the deadline see where the kick is going to put it
+    auto deadline = clock.now() + defaultInterval;
+    EXPECT_EQ(duration_cast<microseconds>(deadline.time_since_epoch()).count(),
+              wdog->deadline());
+
+    // The absorbed kick is counted, but its margin is not known yet
+    EXPECT_EQ(kicks + 1, metrics.kicks.get());
+    EXPECT_EQ(marginSum, metrics.kickMargin.sum());
+
+    // Once the original deadline passes the absorbed kick is applied
+    EXPECT_EQ(1, clock.advance(defaultInterval - Quantum(1)));
+    EXPECT_TRUE(wdog->enabled());
+    EXPECT_FALSE(wdog->timerExpired());
+    EXPECT_TRUE(wdog->timerEnabled());
+    EXPECT_EQ(Quantum(1), milliseconds(wdog->timeRemaining()));
+
+    // Its margin is the percentage of the countdown left when it came in
+    auto margin = milliseconds(defaultInterval - Quantum(1)).count() * 100 /
+                  milliseconds(defaultInterval).count();
+    EXPECT_EQ(kicks + 1, metrics.kicks.get());
+    EXPECT_EQ(marginSum + margin, metrics.kickMargin.sum());
+
+    // Without any more kicks the watchdog expires
+    EXPECT_EQ(1, clock.advance(Quantum(1)));
+    EXPECT_FALSE(wdog->enabled());
+    EXPECT_TRUE(wdog->timerExpired());
+    EXPECT_FALSE(wdog->timerEnabled());
+}
+
 /** @brief Make sure that watchdog is started and enabled.
  *         Wait default interval quantums and make sure that wdog has died
  */
@@ -279,7 +335,7 @@ TEST_F(WdogTest, enableWdogWithFallbackTillEnd)
     fallback.interval = static_cast<uint64_t>(fallbackIntervalMs);
     fallback.always = false;
     wdog.reset();
-    wdog = std::make_unique<Watchdog>(bus, TEST_PATH, event,
+    wdog = std::make_unique<Watchdog>(bus, TEST_PATH, event, clock.makeTimer(),
                                       Watchdog::ActionTargetMap(), fallback);
     EXPECT_EQ(primaryInterval, milliseconds(wdog->interval(primaryIntervalMs)));
     EXPECT_FALSE(wdog->enabled());
@@ -361,7 +417,7 @@ TEST_F(WdogTest, enableWdogWithFallbackReEnable)
     fallback.interval = static_cast<uint64_t>(fallbackIntervalMs);
     fallback.always = false;
     wdog.reset();
-    wdog = std::make_unique<Watchdog>(bus, TEST_PATH, event,
+    wdog = std::make_unique<Watchdog>(bus, TEST_PATH, event, clock.makeTimer(),
                                       Watchdog::ActionTargetMap(), fallback);
     EXPECT_EQ(primaryInterval, milliseconds(wdog->interval(primaryIntervalMs)));
     EXPECT_FALSE(wdog->enabled());
@@ -414,7 +470,7 @@ TEST_F(WdogTest, enableWdogWithFallbackResetTimerEnable)
     fallback.interval = static_cast<uint64_t>(fallbackIntervalMs);
     fallback.always = false;
     wdog.reset();
-    wdog = std::make_unique<Watchdog>(bus, TEST_PATH, event,
+    wdog = std::make_unique<Watchdog>(bus, TEST_PATH, event, clock.makeTimer(),
                                       Watchdog::ActionTargetMap(), fallback);
     EXPECT_EQ(primaryInterval, milliseconds(wdog->interval(primaryIntervalMs)));
     EXPECT_FALSE(wdog->enabled());
@@ -471,7 +527,7 @@ TEST_F(WdogTest, enableWdogWithFallbackAlways)
     fallback.interval = static_cast<uint64_t>(fallbackIntervalMs);
     fallback.always = true;
     wdog.reset();
-    wdog = std::make_unique<Watchdog>(bus, TEST_PATH, event,
+    wdog = std::make_unique<Watchdog>(bus, TEST_PATH, event, clock.makeTimer(),
                                       Watchdog::ActionTargetMap(), fallback,
                                       milliseconds(TEST_MIN_INTERVAL).count());
 
@@ -543,7 +599,8 @@ TEST_F(WdogTest, verifyConstructorMinIntervalSetting)
 {
     // Initiate default Watchdog and get the default interval value.
     wdog.reset();
-    wdog = std::make_unique<Watchdog>(bus, TEST_PATH, event);
+    wdog = std::make_unique<Watchdog>(bus, TEST_PATH, event,
+                                      clock.makeTimer());
     auto defaultIntervalMs = wdog->interval();
     auto defaultInterval = milliseconds(defaultIntervalMs);
     auto minInterval = defaultInterval + Quantum(30);
@@ -552,7 +609,7 @@ TEST_F(WdogTest, verifyConstructorMinIntervalSetting)
     // We initiate a new Watchdog with min interval greater than the default
     // intrval
     wdog.reset();
-    wdog = std::make_unique<Watchdog>(bus, TEST_PATH, event,
+    wdog = std::make_unique<Watchdog>(bus, TEST_PATH, event, clock.makeTimer(),
                                       Watchdog::ActionTargetMap(), std::nullopt,
                                       minIntervalMs);
     // Check that the interval was set to the minInterval
@@ -576,5 +633,581 @@ TEST_F(WdogTest, verifyConstructorMinIntervalSetting)
     EXPECT_TRUE(wdog->timerEnabled());
 }
 
+/** @brief Make sure configure applies every property and starts the
+ *         countdown at the requested remaining time.
+ */
+TEST_F(WdogTest, configureAndEnable)
+{
+    auto newInterval = Quantum(5);
+    auto newIntervalMs = milliseconds(newInterval).count();
+    auto remainingMs = milliseconds(Quantum(3)).count();
+    wdog->configure(newIntervalMs, Watchdog::Action::PowerCycle,
+                    Watchdog::TimerUse::OSLoad, true, remainingMs);
+
+    EXPECT_TRUE(wdog->enabled());
+    EXPECT_TRUE(wdog->timerEnabled());
+    EXPECT_EQ(newIntervalMs, wdog->interval());
+    EXPECT_EQ(Watchdog::Action::PowerCycle, wdog->expireAction());
+    EXPECT_EQ(Watchdog::TimerUse::OSLoad, wdog->currentTimerUse());
+    EXPECT_EQ(remainingMs, wdog->timeRemaining());
+
+    // The countdown runs from the remaining time, not the interval
+    EXPECT_EQ(Quantum(3 - 1), waitForWatchdog(newInterval));
+    EXPECT_FALSE(wdog->enabled());
+}
+
+/** @brief Make sure configure starts from the interval when no remaining
+ *         time is given and respects the minimum interval.
+ */
+TEST_F(WdogTest, configureDefaultsAndMinInterval)
+{
+    auto minIntervalMs = milliseconds(TEST_MIN_INTERVAL).count();
+    wdog->configure(1, Watchdog::Action::None, Watchdog::TimerUse::BIOSPOST,
+                    true, 0);
+    EXPECT_TRUE(wdog->enabled());
+    EXPECT_EQ(minIntervalMs, wdog->interval());
+    EXPECT_EQ(minIntervalMs, wdog->timeRemaining());
+
+    // Reconfiguring a running watchdog without a remaining time keeps
+    // the current countdown
+    clock.advance(Quantum(1));
+    auto intervalMs = milliseconds(defaultInterval).count();
+    wdog->configure(intervalMs, Watchdog::Action::None,
+                    Watchdog::TimerUse::BIOSPOST, true, 0);
+    EXPECT_EQ(intervalMs, wdog->interval());
+    EXPECT_EQ(milliseconds(TEST_MIN_INTERVAL - Quantum(1)).count(),
+              wdog->timeRemaining());
+
+    // Disabling stops the timer
+    wdog->configure(intervalMs, Watchdog::Action::None,
+                    Watchdog::TimerUse::BIOSPOST, false, 0);
+    EXPECT_FALSE(wdog->enabled());
+    EXPECT_FALSE(wdog->timerEnabled());
+}
+
+/** @brief Make sure another timer use counts down alongside the current
+ *         one off of a single programmed deadline.
+ */
+TEST_F(WdogTest, timerUsesCountDownTogether)
+{
+    auto toUs = [](Timer::TimePoint when) {
+        return duration_cast<microseconds>(when.time_since_epoch()).count();
+    };
+    wdog->currentTimerUse(Watchdog::TimerUse::BIOSFRB2);
+    EXPECT_TRUE(wdog->enabled(true));
+    wdog->startTimerUse(Watchdog::TimerUse::OSLoad,
+                        milliseconds(Quantum(2)).count(),
+                        Watchdog::Action::PowerOff);
+
+    auto osLoad = wdog->timerUseDeadline(Watchdog::TimerUse::OSLoad);
+    EXPECT_EQ(toUs(clock.now() + Quantum(2)), osLoad);
+    EXPECT_EQ(wdog->deadline(),
+              wdog->timerUseDeadline(Watchdog::TimerUse::BIOSFRB2));
+    EXPECT_EQ(0, wdog->timerUseDeadline(Watchdog::TimerUse::SMSOS));
+    ASSERT_TRUE(wdog->timers().armedAt());
+    EXPECT_EQ(osLoad, toUs(*wdog->timers().armedAt()));
+
+    // The other timer use runs out first and leaves the current alone
+    EXPECT_EQ(1, clock.advance(Quantum(2)));
+    EXPECT_EQ(Watchdog::TimerUse::OSLoad, wdog->expiredTimerUse());
+    EXPECT_EQ(0, wdog->timerUseDeadline(Watchdog::TimerUse::OSLoad));
+    EXPECT_TRUE(wdog->enabled());
+    EXPECT_EQ(Watchdog::TimerUse::BIOSFRB2, wdog->currentTimerUse());
+    EXPECT_EQ(milliseconds(Quantum(1)).count(), wdog->timeRemaining());
+    EXPECT_EQ(wdog->deadline(), toUs(*wdog->timers().armedAt()));
+
+    EXPECT_EQ(1, clock.advance(Quantum(1)));
+    EXPECT_EQ(Watchdog::TimerUse::BIOSFRB2, wdog->expiredTimerUse());
+    EXPECT_FALSE(wdog->enabled());
+    EXPECT_FALSE(wdog->timers().armedAt());
+}
+
+/** @brief Make sure switching to a timer use that is counting down picks
+ *         up its countdown and keeps the replaced one running.
+ */
+TEST_F(WdogTest, switchTimerUseKeepsCountdowns)
+{
+    wdog->currentTimerUse(Watchdog::TimerUse::BIOSFRB2);
+    EXPECT_TRUE(wdog->enabled(true));
+    auto osLoadInterval = milliseconds(Quantum(10)).count();
+    wdog->startTimerUse(Watchdog::TimerUse::OSLoad, osLoadInterval,
+                        Watchdog::Action::PowerOff);
+    clock.advance(Quantum(1));
+
+    wdog->currentTimerUse(Watchdog::TimerUse::OSLoad);
+    EXPECT_EQ(Watchdog::TimerUse::OSLoad, wdog->currentTimerUse());
+    EXPECT_TRUE(wdog->enabled());
+    EXPECT_EQ(osLoadInterval, wdog->interval());
+    EXPECT_EQ(Watchdog::Action::PowerOff, wdog->expireAction());
+    EXPECT_EQ(milliseconds(Quantum(9)).count(), wdog->timeRemaining());
+    EXPECT_NE(0, wdog->timerUseDeadline(Watchdog::TimerUse::BIOSFRB2));
+
+    // Kicking the current timer use leaves the replaced one counting
+    wdog->resetTimeRemaining(false);
+    EXPECT_EQ(1, clock.advance(Quantum(2)));
+    EXPECT_EQ(Watchdog::TimerUse::BIOSFRB2, wdog->expiredTimerUse());
+    EXPECT_TRUE(wdog->enabled());
+    EXPECT_EQ(milliseconds(Quantum(8)).count(), wdog->timeRemaining());
+
+    // Switching to a timer use that is not counting only relabels
+    wdog->currentTimerUse(Watchdog::TimerUse::SMSOS);
+    EXPECT_EQ(Watchdog::TimerUse::SMSOS, wdog->currentTimerUse());
+    EXPECT_EQ(osLoadInterval, wdog->interval());
+    EXPECT_EQ(milliseconds(Quantum(8)).count(), wdog->timeRemaining());
+}
+
+/** @brief Make sure the countdown of a timer use can be kicked, stopped
+ *         and superseded by configure.
+ */
+TEST_F(WdogTest, timerUseKickStopAndConfigure)
+{
+    wdog->currentTimerUse(Watchdog::TimerUse::BIOSPOST);
+    auto intervalMs = milliseconds(Quantum(4)).count();
+    wdog->startTimerUse(Watchdog::TimerUse::OEM, intervalMs,
+                        Watchdog::Action::HardReset);
+    clock.advance(Quantum(3));
+    wdog->resetTimerUse(Watchdog::TimerUse::OEM);
+    EXPECT_EQ(0, clock.advance(Quantum(3)));
+
+    wdog->stopTimerUse(Watchdog::TimerUse::OEM);
+    EXPECT_EQ(0, wdog->timerUseDeadline(Watchdog::TimerUse::OEM));
+    EXPECT_FALSE(wdog->timers().armedAt());
+    EXPECT_EQ(0, clock.advance(Quantum(5)));
+
+    // Configuring the timer use takes its countdown over
+    wdog->startTimerUse(Watchdog::TimerUse::OEM, intervalMs,
+                        Watchdog::Action::HardReset);
+    wdog->configure(milliseconds(defaultInterval).count(),
+                    Watchdog::Action::None, Watchdog::TimerUse::OEM, true, 0);
+    EXPECT_EQ(wdog->deadline(),
+              wdog->timerUseDeadline(Watchdog::TimerUse::OEM));
+    EXPECT_EQ(defaultInterval - Quantum(1), waitForWatchdog(Quantum(10)));
+    EXPECT_FALSE(wdog->enabled());
+}
+
+/** @brief Make sure the earliest deadline covers every timer use and its
+ *         followers hear of each countdown change.
+ */
+TEST_F(WdogTest, earliestDeadlineCoversTimerUses)
+{
+    auto toUs = [](Timer::TimePoint when) {
+        return duration_cast<microseconds>(when.time_since_epoch()).count();
+    };
+    size_t changes = 0;
+    wdog->setStateCallback([&] { changes++; });
+    EXPECT_EQ(0, wdog->earliestDeadline());
+
+    // Only another timer use is counting down
+    wdog->currentTimerUse(Watchdog::TimerUse::BIOSFRB2);
+    wdog->startTimerUse(Watchdog::TimerUse::OSLoad,
+                        milliseconds(Quantum(2)).count(),
+                        Watchdog::Action::PowerOff);
+    EXPECT_EQ(1, changes);
+    EXPECT_EQ(0, wdog->deadline());
+    EXPECT_EQ(toUs(clock.now() + Quantum(2)), wdog->earliestDeadline());
+
+    // The current timer use runs out later
+    EXPECT_TRUE(wdog->enabled(true));
+    EXPECT_LT(wdog->earliestDeadline(), wdog->deadline());
+    EXPECT_EQ(wdog->timerUseDeadline(Watchdog::TimerUse::OSLoad),
+              wdog->earliestDeadline());
+
+    changes = 0;
+    clock.advance(Quantum(1));
+    wdog->resetTimerUse(Watchdog::TimerUse::OSLoad);
+    EXPECT_EQ(1, changes);
+    EXPECT_EQ(toUs(clock.now() + Quantum(2)), wdog->earliestDeadline());
+
+    wdog->stopTimerUse(Watchdog::TimerUse::OSLoad);
+    EXPECT_EQ(2, changes);
+    EXPECT_EQ(wdog->deadline(), wdog->earliestDeadline());
+
+    // Stopping what is not counting changes nothing
+    wdog->stopTimerUse(Watchdog::TimerUse::OSLoad);
+    EXPECT_EQ(2, changes);
+}
+
+/** @brief Make sure every property change is signaled right away by
+ *         default and only real changes are counted.
+ */
+TEST_F(WdogTest, signalStatsCountChanges)
+{
+    auto before = wdog->signalStats();
+    EXPECT_TRUE(wdog->enabled(true));
+    EXPECT_TRUE(wdog->enabled(true));
+    wdog->interval(milliseconds(defaultInterval).count());
+    wdog->expireAction(Watchdog::Action::PowerOff);
+
+    auto after = wdog->signalStats();
+    EXPECT_EQ(before.mutations + 2, after.mutations);
+    EXPECT_EQ(before.signals + 2, after.signals);
+}
+
+/** @brief Make sure deferred property changes are signaled together on
+ *         the next loop iteration.
+ */
+TEST_F(WdogTest, deferredSignalsFlushOnce)
+{
+    wdog->setDeferSignals(true);
+    auto before = wdog->signalStats();
+
+    EXPECT_TRUE(wdog->enabled(true));
+    wdog->expireAction(Watchdog::Action::PowerOff);
+    wdog->timeRemaining(milliseconds(Quantum(2)).count());
+    wdog->resetTimeRemaining(false);
+    EXPECT_EQ(before.mutations + 4, wdog->signalStats().mutations);
+    EXPECT_EQ(before.signals, wdog->signalStats().signals);
+
+    for (int i = 0; i < 10 && wdog->signalStats().signals == before.signals;
+         ++i)
+    {
+        event.run(0ms);
+    }
+    EXPECT_EQ(before.signals + 1, wdog->signalStats().signals);
+
+    // A change undone before the flush is not signaled at all
+    wdog->expireAction(Watchdog::Action::None);
+    wdog->expireAction(Watchdog::Action::PowerOff);
+    for (int i = 0; i < 10; ++i)
+    {
+        event.run(0ms);
+    }
+    EXPECT_EQ(before.mutations + 6, wdog->signalStats().mutations);
+    EXPECT_EQ(before.signals + 1, wdog->signalStats().signals);
+}
+
+/** @brief Make sure the published deadline follows the timer and every
+ *         move of it is signaled.
+ */
+TEST_F(WdogTest, deadlineFollowsTimer)
+{
+    auto toUs = [](Timer::TimePoint when) {
+        return duration_cast<microseconds>(when.time_since_epoch()).count();
+    };
+    EXPECT_EQ(0, wdog->deadline());
+
+    EXPECT_TRUE(wdog->enabled(true));
+    auto deadline = toUs(clock.now() + defaultInterval);
+    EXPECT_EQ(deadline, wdog->deadline());
+    auto signals = wdog->pollStats().deadlineSignals;
+
+    // Counting down leaves the deadline alone
+    clock.advance(Quantum(1));
+    EXPECT_EQ(deadline, wdog->deadline());
+    auto reads = wdog->pollStats().timeRemainingReads;
+    EXPECT_EQ(milliseconds(defaultInterval - Quantum(1)).count(),
+              wdog->timeRemaining());
+    EXPECT_EQ(reads + 1, wdog->pollStats().timeRemainingReads);
+
+    // Runs the loop until the deadline signal held back by the signal
+    // gap has gone out
+    auto waitForSignal = [&] {
+        for (int i = 0;
+             i < 50 && wdog->pollStats().deadlineSignals == signals; ++i)
+        {
+            event.run(10ms);
+        }
+        EXPECT_EQ(signals + 1, wdog->pollStats().deadlineSignals);
+        signals = wdog->pollStats().deadlineSignals;
+    };
+
+    // Kicks push it out, signaled once the gap since arming has passed
+    wdog->resetTimeRemaining(false);
+    EXPECT_EQ(toUs(clock.now() + defaultInterval), wdog->deadline());
+    EXPECT_EQ(signals, wdog->pollStats().deadlineSignals);
+    waitForSignal();
+
+    // And it is cleared once the timer stops
+    EXPECT_EQ(defaultInterval - Quantum(1), waitForWatchdog(defaultInterval));
+    EXPECT_FALSE(wdog->timerEnabled());
+    EXPECT_EQ(0, wdog->deadline());
+    waitForSignal();
+}
+
+/** @brief Make sure a flapping fallback only logs once per window */
+TEST_F(WdogTest, flappingFallbackLogsLimited)
+{
+    Watchdog::Fallback fallback;
+    fallback.action = Watchdog::Action::PowerOff;
+    fallback.interval = milliseconds(defaultInterval).count();
+    fallback.always = true;
+    wdog.reset();
+    wdog = std::make_unique<Watchdog>(bus, TEST_PATH, event, clock.makeTimer(),
+                                      Watchdog::ActionTargetMap(), fallback,
+                                      milliseconds(TEST_MIN_INTERVAL).count());
+    wdog->setLogWindow(duration_cast<Timer::Duration>(defaultInterval * 10));
+    const auto& logs = wdog->logLimiter();
+
+    // Every trip re-arms the fallback, which was already logged when it
+    // was first armed on construction. Only the first trip is logged.
+    for (int i = 0; i < 5; ++i)
+    {
+        clock.advance(defaultInterval);
+    }
+    EXPECT_TRUE(wdog->timerEnabled());
+    EXPECT_EQ(4, logs.suppressed(LogEvent::TimedOut));
+    EXPECT_EQ(5, logs.suppressed(LogEvent::FallingBack));
+
+    // Once their window is over both are logged again
+    for (int i = 0; i < 6; ++i)
+    {
+        clock.advance(defaultInterval);
+    }
+    EXPECT_EQ(9, logs.suppressed(LogEvent::TimedOut));
+    EXPECT_EQ(10, logs.suppressed(LogEvent::FallingBack));
+
+    // A different timer use is logged straight away
+    wdog->currentTimerUse(Watchdog::TimerUse::OSLoad);
+    clock.advance(defaultInterval);
+    EXPECT_EQ(9, logs.suppressed(LogEvent::TimedOut));
+    EXPECT_EQ(11, logs.suppressed(LogEvent::FallingBack));
+}
+
+/** @brief Make sure suppressed messages are summarized once their window
+ *         runs out, even if they do not happen again.
+ */
+TEST_F(WdogTest, suppressedLogsFlushedAfterWindow)
+{
+    wdog->setLogWindow(duration_cast<Timer::Duration>(Quantum(10)));
+    const auto& logs = wdog->logLimiter();
+    for (int i = 0; i < 3; ++i)
+    {
+        wdog->enabled(true);
+        wdog->enabled(false);
+    }
+    EXPECT_EQ(2, logs.pending(LogEvent::Enabled));
+    EXPECT_EQ(2, logs.pending(LogEvent::Disabled));
+
+    // A single wake up covers both windows
+    EXPECT_EQ(0, clock.advance(Quantum(9)));
+    EXPECT_EQ(1, clock.advance(Quantum(1)));
+    EXPECT_EQ(0, logs.pending(LogEvent::Enabled));
+    EXPECT_EQ(0, logs.pending(LogEvent::Disabled));
+    EXPECT_EQ(2, logs.suppressed(LogEvent::Enabled));
+
+    // Nothing is left to flush
+    EXPECT_EQ(0, clock.advance(Quantum(20)));
+}
+
+/** @brief Make sure kicks, expirations and fallbacks are counted */
+TEST_F(WdogTest, metricsCountActivity)
+{
+    Watchdog::Fallback fallback;
+    fallback.action = Watchdog::Action::PowerOff;
+    fallback.interval = milliseconds(defaultInterval * 2).count();
+    fallback.always = false;
+    wdog.reset();
+    wdog = std::make_unique<Watchdog>(bus, TEST_PATH, event, clock.makeTimer(),
+                                      Watchdog::ActionTargetMap(), fallback,
+                                      milliseconds(TEST_MIN_INTERVAL).count());
+    wdog->interval(milliseconds(defaultInterval * 10).count());
+    const auto& metrics = wdog->metrics();
+
+    // Kicking with 90% and then 20% of the countdown left
+    EXPECT_TRUE(wdog->enabled(true));
+    clock.advance(defaultInterval);
+    wdog->resetTimeRemaining(false);
+    clock.advance(defaultInterval * 8);
+    wdog->resetTimeRemaining(false);
+    EXPECT_EQ(2, metrics.kicks.get());
+    auto margins = metrics.kickMargin.buckets();
+    EXPECT_EQ(1, margins[2]);
+    EXPECT_EQ(1, margins[9]);
+    EXPECT_EQ(110, metrics.kickMargin.sum());
+
+    // Running out enters the fallback
+    clock.advance(defaultInterval * 10);
+    EXPECT_EQ(1, metrics.expirations.get());
+    EXPECT_EQ(1, metrics.fallbackEntries.get());
+    EXPECT_TRUE(wdog->timerEnabled());
+
+    // Which runs out without re-arming
+    clock.advance(defaultInterval * 2);
+    EXPECT_EQ(2, metrics.expirations.get());
+    EXPECT_EQ(1, metrics.fallbackEntries.get());
+    EXPECT_FALSE(wdog->timerEnabled());
+    EXPECT_EQ(0, metrics.startUnitSuccesses.get());
+    EXPECT_EQ(0, metrics.startUnitFailures.get());
+}
+
+/** @brief Make sure the history follows what happened to the timer */
+TEST_F(WdogTest, historyRecordsEvents)
+{
+    wdog->setHistorySize(8);
+    auto start = clock.now();
+    auto newInterval = milliseconds(defaultInterval * 2).count();
+    EXPECT_EQ(newInterval, wdog->interval(newInterval));
+    EXPECT_TRUE(wdog->enabled(true));
+    clock.advance(defaultInterval);
+    wdog->resetTimeRemaining(false);
+    clock.advance(defaultInterval * 2);
+    EXPECT_FALSE(wdog->enabled());
+
+    auto entries = wdog->history().entries();
+    ASSERT_EQ(5, entries.size());
+    EXPECT_EQ(HistoryEvent::Interval, entries[0].event);
+    EXPECT_EQ(newInterval, entries[0].value);
+    EXPECT_EQ(HistoryEvent::Enabled, entries[1].event);
+    EXPECT_EQ(newInterval, entries[1].value);
+    EXPECT_EQ(HistoryEvent::Kick, entries[2].event);
+    EXPECT_EQ(milliseconds(defaultInterval).count(), entries[2].value);
+    EXPECT_EQ(HistoryEvent::Timeout, entries[3].event);
+    EXPECT_EQ(static_cast<uint64_t>(wdog->expireAction()), entries[3].value);
+    EXPECT_EQ(HistoryEvent::Disabled, entries[4].event);
+
+    auto toUs = [](Timer::TimePoint when) {
+        return duration_cast<microseconds>(when.time_since_epoch()).count();
+    };
+    EXPECT_EQ(toUs(start), entries[1].time);
+    EXPECT_EQ(toUs(start + defaultInterval), entries[2].time);
+    EXPECT_EQ(toUs(start + defaultInterval * 3), entries[3].time);
+}
+
+/** @brief Reference model of the watchdog state used to check random
+ *         sequences of operations.
+ */
+struct WdogModel
+{
+    uint64_t minInterval;
+    std::optional<uint64_t> fallbackInterval;
+    uint64_t interval;
+    bool enabled = false;
+    bool timerEnabled = false;
+    uint64_t remaining = 0;
+
+    void enable(bool value)
+    {
+        if (!value)
+        {
+            enabled = false;
+            fallbackOrDisable();
+        }
+        else if (!enabled)
+        {
+            enabled = timerEnabled = true;
+            remaining = interval;
+        }
+    }
+
+    void setRemaining(uint64_t value)
+    {
+        if (timerEnabled)
+        {
+            remaining = enabled ? std::max(value, minInterval)
+                                : *fallbackInterval;
+        }
+    }
+
+    void setInterval(uint64_t value)
+    {
+        interval = std::max(value, minInterval);
+    }
+
+    void advance(uint64_t ms)
+    {
+        while (timerEnabled && ms >= remaining)
+        {
+            ms -= remaining;
+            fallbackOrDisable();
+        }
+        if (timerEnabled)
+        {
+            remaining -= ms;
+        }
+    }
+
+    void fallbackOrDisable()
+    {
+        timerEnabled = fallbackInterval.has_value();
+        remaining = fallbackInterval.value_or(0);
+        enabled = false;
+    }
+};
+
+/** @brief Runs a long random sequence of operations against the watchdog
+ *         and checks it always agrees with the reference model.
+ */
+void checkRandomTransitions(WdogTest& test, WdogModel model)
+{
+    auto& wdog = test.wdog;
+    std::mt19937 gen(1234);
+    std::uniform_int_distribution<int> op(0, 5);
+    std::uniform_int_distribution<uint64_t> ms(0, 1000);
+
+    wdog->interval(model.interval);
+    for (int i = 0; i < 5000; ++i)
+    {
+        switch (op(gen))
+        {
+            case 0:
+                wdog->enabled(true);
+                model.enable(true);
+                break;
+            case 1:
+                wdog->enabled(false);
+                model.enable(false);
+                break;
+            case 2:
+                wdog->resetTimeRemaining(false);
+                model.setRemaining(model.interval);
+                break;
+            case 3:
+            {
+                auto value = ms(gen);
+                wdog->timeRemaining(value);
+                model.setRemaining(value);
+                break;
+            }
+            case 4:
+            {
+                auto value = ms(gen);
+                wdog->interval(value);
+                model.setInterval(value);
+                break;
+            }
+            case 5:
+            {
+                auto value = ms(gen) / 2;
+                test.clock.advance(milliseconds(value));
+                model.advance(value);
+                break;
+            }
+        }
+
+        ASSERT_EQ(model.enabled, wdog->enabled()) << "step " << i;
+        ASSERT_EQ(model.timerEnabled, wdog->timerEnabled()) << "step " << i;
+        ASSERT_EQ(model.timerEnabled ? model.remaining : 0,
+                  wdog->timeRemaining())
+            << "step " << i;
+        ASSERT_EQ(model.interval, wdog->interval()) << "step " << i;
+    }
+}
+
+TEST_F(WdogTest, randomTransitions)
+{
+    WdogModel model{.minInterval = milliseconds(TEST_MIN_INTERVAL).count(),
+                    .fallbackInterval = std::nullopt,
+                    .interval = milliseconds(defaultInterval).count()};
+    checkRandomTransitions(*this, model);
+}
+
+TEST_F(WdogTest, randomTransitionsWithFallback)
+{
+    Watchdog::Fallback fallback;
+    fallback.action = Watchdog::Action::PowerOff;
+    fallback.interval = 500;
+    fallback.always = true;
+    wdog.reset();
+    wdog = std::make_unique<Watchdog>(bus, TEST_PATH, event, clock.makeTimer(),
+                                      Watchdog::ActionTargetMap(), fallback,
+                                      milliseconds(TEST_MIN_INTERVAL).count());
+
+    WdogModel model{.minInterval = milliseconds(TEST_MIN_INTERVAL).count(),
+                    .fallbackInterval = fallback.interval,
+                    .interval = milliseconds(defaultInterval).count()};
+    model.fallbackOrDisable();
+    checkRandomTransitions(*this, model);
+}
+
 } // namespace watchdog
 } // namespace phosphor